@@ -2,119 +2,6 @@
 #include "common/animation.hpp"
 #include "schema/anim_player.hpp"
 
-class AnimationTrackPlayerBase {
-public:
-    virtual ~AnimationTrackPlayerBase() = default;
-    virtual void Update(TimeType) = 0;
-    virtual void Rewind() = 0;
-    [[nodiscard]] virtual AnimationTrackType GetType() const = 0;
-    [[nodiscard]] virtual TimeType GetFinishTime() const = 0;
-};
-
-template <typename T>
-class IAnimationTrackPlayer : public AnimationTrackPlayerBase {
-public:
-    using keyframe_type = KeyFrame<T>;
-
-    explicit IAnimationTrackPlayer(const IAnimationTrack<T>& track)
-        : m_track(track) {}
-
-    void Rewind() override {
-        m_cur_frame = -1;
-        m_cur_time = 0;
-    }
-
-    void Update(TimeType delta_time) override {
-        auto& keyframes = m_track.GetKeyframes();
-        if (keyframes.empty()) {
-            return;
-        }
-        if (m_cur_frame + 1 >= static_cast<int>(keyframes.size())) {
-            return;
-        }
-
-        // One delta per call; then advance across any keyframe boundaries crossed. (The old
-        // loop added delta_time every iteration, so a single large seek step multiplied by the
-        // number of crossed keyframes and jumped to the end of the track.)
-        m_cur_time += delta_time;
-        while (m_cur_frame + 1 < static_cast<int>(keyframes.size())) {
-            const auto& next_frame = keyframes[m_cur_frame + 1];
-            if (next_frame.m_time <= m_cur_time) {
-                m_cur_frame++;
-            } else {
-                break;
-            }
-        }
-
-        m_cur_time = std::min(keyframes.back().m_time, m_cur_time);
-    }
-
-    virtual T GetValue() const = 0;
-
-    [[nodiscard]] bool NeedSync() const { return m_cur_frame >= 0; }
-
-    auto& GetTrack() const { return m_track; }
-
-    [[nodiscard]] AnimationTrackType GetType() const override { return m_track.GetType(); }
-
-    [[nodiscard]] TimeType GetFinishTime() const override { return m_track.GetFinishTime(); }
-
-protected:
-    const IAnimationTrack<T>& m_track;
-    TimeType m_cur_time{};
-    int m_cur_frame = -1;
-};
-
-template <typename T, AnimationTrackType Type>
-class AnimationTrackPlayer;
-
-template <typename T>
-class AnimationTrackPlayer<T, AnimationTrackType::Linear>
-    : public IAnimationTrackPlayer<T> {
-public:
-    using track_type = AnimationTrack<T, AnimationTrackType::Linear>;
-
-    explicit AnimationTrackPlayer(const track_type& track)
-        : IAnimationTrackPlayer<T>(track) {}
-
-    T GetValue() const override {
-        auto& track = static_cast<const track_type&>(this->GetTrack());
-        auto& keyframes = track.GetKeyframes();
-
-        if (keyframes.empty()) {
-            return {};
-        }
-
-        if (this->m_cur_frame + 1 >= keyframes.size()) {
-            return keyframes[this->m_cur_frame].m_value;
-        }
-        auto& cur_frame = keyframes[this->m_cur_frame];
-        auto& next_frame = keyframes[this->m_cur_frame + 1];
-        float t = (this->m_cur_time - cur_frame.m_time) /
-                  (next_frame.m_time - cur_frame.m_time);
-        return Lerp(cur_frame.m_value, next_frame.m_value, t);
-    }
-};
-
-template <typename T>
-class AnimationTrackPlayer<T, AnimationTrackType::Discrete>
-    : public IAnimationTrackPlayer<T> {
-public:
-    using track_type = AnimationTrack<T, AnimationTrackType::Discrete>;
-
-    using IAnimationTrackPlayer<T>::IAnimationTrackPlayer;
-
-    T GetValue() const override {
-        auto& track = static_cast<const track_type&>(this->GetTrack());
-        auto& keyframes = track.GetKeyframes();
-
-        if (keyframes.empty()) {
-            return {};
-        }
-        return keyframes[this->m_cur_frame].m_value;
-    }
-};
-
 class AnimationPlayer {
 public:
     static constexpr int InfLoop = -1;
@@ -145,6 +32,22 @@ public:
     void Update(TimeType delta_time);
     void Sync(Entity entity);
 
+    /**
+     * false before played after rewind, `Sync` does nothing then
+     */
+    [[nodiscard]] bool NeedSync() const;
+
+    /**
+     * sample animation at current time, can run on worker thread after
+     * `Update`
+     */
+    void SamplePose(AnimationPose& pose);
+
+    /**
+     * write sampled values to entity's components
+     */
+    void ApplyPose(Entity entity, const AnimationPose& pose) const;
+
     void SetRate(float rate);
     [[nodiscard]] float GetRate() const;
 
@@ -156,17 +59,24 @@ public:
 private:
     AnimationHandle m_animation;
 
-    std::unordered_map<AnimationBindingPoint,
-                       std::unique_ptr<AnimationTrackPlayerBase>>
-        m_track_players;
-    std::unordered_map<std::string, std::unique_ptr<AnimationTrackPlayerBase>>
-        m_bind_point_track_players;
+    // keyframe found last sync of each clip track, speeds up seeking
+    std::vector<uint32_t> m_frame_hints;
 
     bool m_auto_play = false;
     bool m_is_playing = false;
+    bool m_need_sync = false;  // not synced until played after rewind
     int m_loop{0};
     TimeType m_cur_time{};
     float m_rate = 1.0;
+
+    template <typename T>
+    void applyBindingPoint(const AnimationClip& clip,
+                           const AnimationPose& pose,
+                           AnimationBindingPoint binding, T& target) const {
+        if (auto value = pose.Get<T>(clip, clip.GetTrackIndex(binding))) {
+            target = *value;
+        }
+    }
 };
 
 class MultiAnimationPlayer {
@@ -200,5 +110,42 @@ private:
 
 class MultiAnimationPlayerManager : public ComponentManager<MultiAnimationPlayer> {
 public:
+    /**
+     * advance all players, then sample poses in parallel and apply them in
+     * one pass. Players of the same clip at the same time share one pose
+     */
     void Update(TimeType delta_time);
+
+private:
+    static constexpr size_t SampleChunkSize = 64;
+
+    struct SampleKey {
+        const AnimationClip* m_clip{};
+        TimeType m_time{};
+
+        bool operator==(const SampleKey& o) const {
+            return m_clip == o.m_clip && m_time == o.m_time;
+        }
+    };
+
+    struct SampleKeyHash {
+        size_t operator()(const SampleKey& key) const;
+    };
+
+    struct Sample {
+        AnimationPlayer* m_player{};  // samples for all sharing players
+        AnimationPose m_pose;
+    };
+
+    struct Instance {
+        Entity m_entity{};
+        const AnimationPlayer* m_player{};
+        size_t m_sample{};
+    };
+
+    // kept between frames to reuse memory
+    std::unordered_map<SampleKey, size_t, SampleKeyHash> m_sample_indices;
+    std::vector<Sample> m_samples;
+    size_t m_sample_count{};
+    std::vector<Instance> m_instances;
 };
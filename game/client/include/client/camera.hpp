@@ -1,5 +1,6 @@
 #pragma once
 #include "common/math.hpp"
+#include "schema/common.hpp"
 
 class Camera {
 public:
@@ -15,6 +16,11 @@ public:
 
     void transform(Vec2* center, Vec2* size) const;
 
+    /**
+     * world space rect shown in window
+     */
+    Rect GetVisibleRect() const;
+
 private:
     Vec2 m_scale = {1, 1};
     Vec2 m_position = {0, 0};
@@ -19,18 +19,24 @@ public:
     void Clear() override;
 
 private:
-    template <typename T>
-    struct Element {
+    enum class PrimitiveType : uint8_t {
+        Rect,
+        FillRect,
+        Circle,
+        Line,
+    };
+
+    struct Primitive {
+        PrimitiveType m_type = PrimitiveType::Line;
+        bool m_use_camera = false;
         Color m_color;
-        T m_value;
+        Vec2 m_p1, m_p2;  // rect center & half size, line ends, circle center
+        float m_radius{};
         TimeType m_time{};
-        bool use_camera = false;
     };
 
-    std::vector<Element<Rect>> m_fill_rects;
-    std::vector<Element<Circle>> m_circles;
-    std::vector<Element<Rect>> m_rects;
-    std::vector<Element<std::pair<Vec2, Vec2>>> m_segments;
-    
+    // all primitives share one pool, expired ones are swap-removed
+    std::vector<Primitive> m_primitives;
+
     TimeType decTime(TimeType cur_time, TimeType elapse);
 };
@@ -1,10 +1,16 @@
 #pragma once
 
+#include "client/texture_atlas.hpp"
 #include "common/font.hpp"
 
+#include <memory>
+#include <unordered_map>
+
+class Renderer;
+
 class Font: public FontBase {
 public:
-    explicit Font(const Path& filename, int pt);
+    Font(Renderer& renderer, const Path& filename, int pt);
 
     Font(const Font&) = delete;
     Font& operator=(const Font&) = delete;
@@ -18,15 +24,43 @@ public:
     [[nodiscard]] SDL_Surface* GenerateText(const std::string& text,
                                             const Color& color) const override;
 
+    TextLayout LayoutText(const UTF8String& text, int pt) override;
+
+    const ImageBase* GetGlyphImage(char32_t cp, int pt) override;
+
     int GetHeight() const override;
 
     void SetFontSize(int pt) override;
 
 private:
+    struct Glyph {
+        // atlas image, or standalone image if too large to pack. null for
+        // whitespace
+        std::unique_ptr<ImageBase> m_image;
+        float m_advance{};
+    };
+
+    /**
+     * glyphs rasterized once per point size
+     */
+    using GlyphCache = std::unordered_map<char32_t, Glyph>;
+
+    static constexpr int GlyphAtlasPageSize = 512;
+
+    Renderer* m_renderer{};
     TTF_Font* m_font{};
+    std::unique_ptr<TextureAtlas> m_glyph_atlas;
+    std::unordered_map<int, GlyphCache> m_glyph_caches;
+
+    const Glyph& getGlyph(GlyphCache& cache, char32_t cp);
 };
 
 class ClientFontManager : public FontManagerBase {
 public:
+    explicit ClientFontManager(Renderer& renderer);
+
     FontHandle Load(const Path& filename, bool force = false) override;
+
+private:
+    Renderer& m_renderer;
 };
@@ -1,13 +1,45 @@
 #pragma once
+#include "client/texture_atlas.hpp"
 #include "common/image.hpp"
 
+#include <memory>
+
 class Renderer;
+class TextureDestroyQueue;
+
+/**
+ * decoded RGBA pixels, can be decoded in worker thread
+ */
+class ImagePixels {
+public:
+    static std::unique_ptr<ImagePixels> Decode(const Path& filename);
+
+    ImagePixels(const ImagePixels&) = delete;
+    ImagePixels& operator=(const ImagePixels&) = delete;
+    ~ImagePixels();
+
+    [[nodiscard]] int GetWidth() const;
+    [[nodiscard]] int GetHeight() const;
+    [[nodiscard]] void* GetData() const;
+
+private:
+    int m_w{};
+    int m_h{};
+    void* m_data{};
+
+    ImagePixels() = default;
+};
 
 class Image: public ImageBase {
 public:
     Image() = default;
     Image(Renderer& renderer, SDL_Surface* surface);
     Image(Renderer& renderer, const Path& filename);
+
+    /**
+     * upload decoded pixels to GPU, must be called on main thread
+     */
+    Image(Renderer& renderer, const ImagePixels& pixels, const Path& filename);
     Image(const Image&) = delete;
     Image& operator=(const Image&) = delete;
     Image(Image&&) noexcept;
@@ -21,6 +53,7 @@ public:
 
 private:
     SDL_Texture* m_texture{};
+    std::weak_ptr<TextureDestroyQueue> m_destroy_queue;
 };
 
 class ClientImageManager: public ImageManagerBase {
@@ -29,6 +62,21 @@ public:
 
     ImageHandle Load(const Path& filename, bool force = false) override;
 
+    /**
+     * give atlas space back before dropping the image
+     */
+    void Unload(ImageHandle handle) override;
+
+protected:
+    void loadAsync(const Path& filename, const UUIDv4& pending_uuid) override;
+
 private:
     Renderer& m_renderer;
+    TextureAtlas m_atlas;
+
+    /**
+     * pack into atlas if small enough, otherwise create standalone texture
+     */
+    std::unique_ptr<ImageBase> createImage(const ImagePixels& pixels,
+                                           const Path& filename);
 };
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include "client/image.hpp"
+#include "client/renderer.hpp"
+#include "common/binary_serialize.hpp"
+#include "common/path.hpp"
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * records closed draw passes of frames into a compact binary file, which is
+ * replayed by `render_bench` without game & GPU.
+ *
+ * Passes are recorded before sorting so replay runs the whole pipeline.
+ * Textures are recorded by size only, replay draws with blank textures
+ */
+class RenderCaptureWriter {
+public:
+    static constexpr std::array<char, 4> Magic = {'T', 'L', 'R', 'C'};
+    static constexpr uint32_t Version = 2;
+    static constexpr uint32_t DefaultFrameCount = 300;
+
+    /**
+     * @param viewport_size size commands are culled by
+     */
+    RenderCaptureWriter(const Path& filename, uint32_t frame_count,
+                        const Vec2UI& viewport_size);
+
+    void RecordPass(const DrawPass&);
+
+    /**
+     * @return true if all frames captured and saved
+     */
+    bool EndFrame();
+
+private:
+    Path m_filename;
+    uint32_t m_frame_count{};
+    uint32_t m_captured_frame_count{};
+    Vec2UI m_viewport_size;
+
+    BinaryWriter m_frames;
+
+    std::unordered_map<SDL_Texture*, uint32_t> m_texture_ids;
+    std::vector<Vec2> m_texture_sizes;
+
+    uint32_t getTextureID(SDL_Texture*);
+    void save() const;
+};
+
+/**
+ * capture loaded for replaying
+ */
+class RenderCapture {
+public:
+    using Frame = std::vector<DrawPass>;
+
+    /**
+     * @return nullptr if file is broken or has other version
+     */
+    static std::unique_ptr<RenderCapture> Load(const Path& filename);
+
+    /**
+     * create blank textures and bind them to commands, must be called before
+     * replay
+     */
+    void CreateTextures(Renderer& renderer);
+
+    [[nodiscard]] const std::vector<Frame>& GetFrames() const;
+    [[nodiscard]] const Vec2UI& GetViewportSize() const;
+
+private:
+    /**
+     * command drawing recorded texture
+     */
+    struct TextureBinding {
+        uint32_t m_frame{}, m_pass{}, m_command{};
+        uint32_t m_texture{};
+    };
+
+    Vec2UI m_viewport_size;
+    std::vector<Vec2> m_texture_sizes;
+    std::vector<TextureBinding> m_texture_bindings;
+    std::vector<std::unique_ptr<Image>> m_textures;
+    std::vector<Frame> m_frames;
+};
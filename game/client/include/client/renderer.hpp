@@ -9,13 +9,16 @@
 #include "schema/flip.hpp"
 #include "client/font.hpp"
 #include "client/window.hpp"
+
+#include <memory>
 #include <optional>
 
 class Camera;
 class Image;
+class RenderCaptureWriter;
 
 struct DrawImageCommand {
-    const ImageBase* m_image;
+    SDL_Texture* m_texture;  // resolved when recorded
     Region m_src;
     Rect m_dst;
     Degrees m_rotation;
@@ -35,8 +38,17 @@ struct DrawLineCommand {
     Vec2 m_p1, m_p2;
 };
 
+/**
+ * connected lines drawn by one SDL call, points are in `DrawPass::m_points`
+ */
+struct DrawLineStripCommand {
+    uint32_t m_first{};
+    uint32_t m_count{};
+    Rect m_bounds;  // for culling
+};
+
 struct DrawImage9GridCommand {
-    const ImageBase* m_image;
+    SDL_Texture* m_texture;  // resolved when recorded
     Image9Grid m_grid;
     Region m_src;
     Rect m_dst;
@@ -44,7 +56,7 @@ struct DrawImage9GridCommand {
 };
 
 struct DrawImageExCommand {
-    const ImageBase* m_image;
+    SDL_Texture* m_texture;  // resolved when recorded
     Region m_src;
     Vec2 m_origin;
     Vec2 m_right;
@@ -56,17 +68,81 @@ struct DrawCommand {
                  DrawImageExCommand,
                  FillRectCommand,
                  DrawImage9GridCommand,
-                 DrawLineCommand
+                 DrawLineCommand,
+                 DrawLineStripCommand
     > m_cmd;
     float m_z_order{};
     float m_y_sorting{};
     Color m_color = Color::White;
 };
 
+/**
+ * counters of executed passes since last `Renderer::Clear`
+ */
+struct RenderStats {
+    uint32_t m_command_count = 0;
+    uint32_t m_culled_count = 0;
+    uint32_t m_draw_call_count = 0;  // SDL render calls issued
+};
+
+/**
+ * draw commands recorded between two `Renderer::ApplyDrawcall`
+ */
+struct DrawPass {
+    std::vector<DrawCommand> m_commands;
+    std::vector<std::pair<size_t, size_t>> m_y_sorting_range;
+    std::vector<SDL_FPoint> m_points;  // of line strips
+
+    // (z order, sequence) key of each command, commands are drawn by
+    // `m_sorted_indices` so the big variants are never moved when sorting
+    std::vector<uint64_t> m_sort_keys;
+    std::vector<uint64_t> m_y_sorting_keys;
+    std::vector<uint32_t> m_sorted_indices;
+    std::vector<uint32_t> m_sort_buffer;
+
+    void Push(DrawCommand&&);
+    void Sort();
+    void Clear();
+};
+
+/**
+ * textures released while recorded passes may still draw them, they are
+ * destroyed after passes executed. Images hold it weakly so they can be
+ * released after renderer
+ */
+class TextureDestroyQueue {
+public:
+    TextureDestroyQueue() = default;
+    TextureDestroyQueue(const TextureDestroyQueue&) = delete;
+    TextureDestroyQueue& operator=(const TextureDestroyQueue&) = delete;
+    ~TextureDestroyQueue();
+
+    void Push(SDL_Texture*);
+
+    /**
+     * destroy queued textures, called when no pass refers them
+     */
+    void Flush();
+
+    /**
+     * destroy texture through renderer's queue if it is still alive
+     */
+    static void Destroy(const std::weak_ptr<TextureDestroyQueue>&,
+                        SDL_Texture*);
+
+private:
+    std::vector<SDL_Texture*> m_textures;
+};
+
 class Renderer {
 public:
     Renderer(Window& window);
 
+    /**
+     * headless software renderer drawing into `target`, used by benchmarks
+     */
+    explicit Renderer(SDL_Surface* target);
+
     Renderer(const Renderer&) = delete;
 
     Renderer& operator=(const Renderer&) = delete;
@@ -88,11 +164,18 @@ public:
                   bool use_camera = true,
                   float y_sorting = 0);
 
+    /**
+     * drawn as one line strip
+     */
     void DrawCircle(const Circle&, const Color&, uint32_t fragment = 20,
                     double z_order = 0,
                     bool use_camera = true,
                     float y_sorting = 0);
 
+    void DrawLineStrip(const Vec2* points, size_t count, const Color&,
+                       double z_order = 0, bool use_camera = true,
+                       float y_sorting = 0);
+
     void FillRect(const Rect&, const Color&, double z_order = 0,
                   bool use_camera = true,
                   float y_sorting = 0);
@@ -109,6 +192,14 @@ public:
                         double z_order = 0, bool use_camera = true,
                         float y_sorting = 0);
 
+    /**
+     * draw laid out text as glyph quads, quads on same atlas page are batched
+     * by SDL
+     */
+    void DrawTextLayout(FontBase&, const TextLayout&, const Vec2& topleft,
+                        const Color& color, double z_order = 0,
+                        bool use_camera = true, float y_sorting = 0);
+
     void DrawImageEx(const ImageBase& image, const Region& src, const Vec2& topleft,
                      const Vec2& topright, const Vec2& bottomleft,
                      const Color& color,
@@ -117,25 +208,65 @@ public:
 
     void Clear();
 
+    /**
+     * close recording pass and sort it, it is drawn by `Execute`
+     */
     void ApplyDrawcall();
+
+    /**
+     * draw all closed passes in order, must be called on main thread
+     */
+    void Execute();
+
+    /**
+     * execute remaining passes then present
+     */
     void Present();
 
+    /**
+     * draw a sorted pass immediately. Used by replaying captures
+     */
+    void ExecutePass(const DrawPass&);
+
+    /**
+     * record closed passes of next `frame_count` frames into file, see
+     * `RenderCaptureWriter`
+     */
+    void StartCapture(const Path& filename, uint32_t frame_count);
+
+    [[nodiscard]] const RenderStats& GetStats() const;
+
     SDL_Renderer* GetRenderer() const;
 
+    [[nodiscard]] std::weak_ptr<TextureDestroyQueue> GetTextureDestroyQueue()
+        const;
+
     void BeginYSorting();
     void EndYSorting();
     bool IsRecordingYSorting() const;
 
 private:
+    Window* m_window{};
     SDL_Renderer* m_renderer{};
     SDL_Color m_clear_color;
     SDL_Texture* m_text_texture{};
-    std::vector<DrawCommand> m_draw_commands;
-    std::vector<std::pair<size_t, size_t>> m_y_sorting_range;
     bool m_is_y_sorting_range_close = true;
 
+    std::unique_ptr<DrawPass> m_recording_pass;
+    std::vector<std::unique_ptr<DrawPass>> m_submitted_passes;
+    std::vector<std::unique_ptr<DrawPass>> m_free_passes;  // reuse memory
+    std::shared_ptr<TextureDestroyQueue> m_texture_destroy_queue;
+
+    std::unique_ptr<RenderCaptureWriter> m_capture;
+    RenderStats m_stats;
+
     void transformByCamera(const Camera&, Vec2* center, Vec2* size) const;
     void resizeTexture(const Vec2UI& new_size);
-    void applyDrawCommands();
-    void sortDrawCommands();
+    void pushDrawCommand(DrawCommand&&);
+
+    /**
+     * push strip of points appended to recording pass since `first`
+     */
+    void pushLineStrip(uint32_t first, const Color&, double z_order,
+                       float y_sorting);
 };
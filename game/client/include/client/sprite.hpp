@@ -5,9 +5,37 @@
 #include "client/renderer.hpp"
 #include "schema/sprite.hpp"
 
+#include <array>
+#include <unordered_map>
+
 using Sprite = SpriteDefinition;
 
 class SpriteManager : public ComponentManager<Sprite> {
 public:
     void SubmitDrawCommand(Entity);
+    void RemoveEntity(Entity) override;
+
+private:
+    /**
+     * retained world space quad of sprite, rebuilt only when transform or
+     * sprite(e.g. by animation) changed
+     */
+    struct RenderProxy {
+        uint32_t m_transform_version{};
+        const ImageBase* m_image{};  // only compared, never dereferenced
+        Vec2 m_image_size;           // image may be reloaded at same address
+        Region m_region;
+        Vec2 m_anchor;
+        Flags<Flip> m_flip;
+
+        Region m_src;
+        std::array<Vec2, 3> m_pts;  // top left, top right, bottom left
+        Rect m_bounds;              // for culling by camera
+    };
+
+    std::unordered_map<Entity, RenderProxy> m_proxies;
+
+    static bool isProxyOutdated(const RenderProxy&, const Sprite&,
+                                const Transform&);
+    static void updateProxy(RenderProxy&, const Sprite&, const Transform&);
 };
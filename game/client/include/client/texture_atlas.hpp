@@ -0,0 +1,116 @@
+#pragma once
+#include "common/image.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+class Renderer;
+class TextureDestroyQueue;
+class ImagePixels;
+
+/**
+ * image packed into an atlas page, the page is owned by `TextureAtlas`
+ */
+class AtlasImage: public ImageBase {
+public:
+    /**
+     * @param slot space occupied in page, including extrusion and padding
+     */
+    AtlasImage(SDL_Texture* page, const Region& region, const SDL_Rect& slot);
+
+    [[nodiscard]] Vec2 GetSize() const override;
+    [[nodiscard]] SDL_Texture* GetTexture() const override;
+    [[nodiscard]] Region GetTextureRegion() const override;
+
+    /**
+     * page is shared by many images, tinting it would tint all of them.
+     * Draw with color instead, this only logs an error
+     */
+    void ChangeColorMask(const Color& color) override;
+
+private:
+    friend class TextureAtlas;
+
+    SDL_Texture* m_page{};
+    Region m_region;
+    SDL_Rect m_slot{};
+};
+
+/**
+ * packs small images into large pages by skyline bottom-left algorithm so
+ * sprites/tiles/ui images share few textures.
+ *
+ * Every image is extruded by 1 pixel and separated by padding to avoid
+ * bleeding when sampling with scale. Space is reclaimed only by `Release`,
+ * released slots are reused whole by later images fitting in them
+ */
+class TextureAtlas {
+public:
+    static constexpr int PageSize = 2048;
+    static constexpr int MaxImageSize = 256;  // larger image won't be packed
+    static constexpr int Extrude = 1;
+    static constexpr int Padding = 1;
+
+    explicit TextureAtlas(Renderer& renderer, int page_size = PageSize);
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+    ~TextureAtlas();
+
+    /**
+     * pack pixels into atlas, must be called on main thread
+     * @return nullptr if image is too large or upload failed
+     */
+    std::unique_ptr<AtlasImage> Pack(const ImagePixels& pixels,
+                                     const Path& filename);
+
+    /**
+     * pack RGBA32 pixels into atlas, must be called on main thread
+     * @param name for error report
+     */
+    std::unique_ptr<AtlasImage> Pack(const void* pixels, int w, int h,
+                                     int pitch, const Path& name);
+
+    /**
+     * give image's space back to atlas, image is empty after released
+     */
+    void Release(AtlasImage& image);
+
+    [[nodiscard]] size_t GetPageCount() const;
+
+private:
+    struct SkylineNode {
+        int m_x{}, m_y{}, m_w{};
+    };
+
+    struct Placement {
+        size_t m_node{};  // index of the skyline node the rect starts at
+        int m_x{}, m_y{};
+    };
+
+    struct Page {
+        SDL_Texture* m_texture{};
+        std::vector<SkylineNode> m_skyline;
+        std::vector<SDL_Rect> m_free_slots;  // released by `Release`
+    };
+
+    Renderer& m_renderer;
+    std::weak_ptr<TextureDestroyQueue> m_destroy_queue;
+    int m_page_size{};
+    std::vector<Page> m_pages;
+
+    bool createPage();
+
+    /**
+     * take the smallest released slot which fits w x h
+     */
+    std::optional<SDL_Rect> takeFreeSlot(Page& page, int w, int h);
+
+    /**
+     * find bottom-left position of w x h rect in page
+     */
+    std::optional<Placement> findPosition(const Page& page, int w,
+                                          int h) const;
+    static void addSkylineLevel(Page& page, const Placement& placement, int w,
+                                int h);
+};
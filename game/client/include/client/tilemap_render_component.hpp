@@ -8,18 +8,59 @@
 #include "schema/tilemap_schema.hpp"
 
 class TilemapLayerRenderComponent {
+    friend class TilemapLayerRenderComponentManager;
+
 public:
+    /**
+     * retained draw data of one tile, layer is immutable so it is built once.
+     * Tile is kept by gid, so reloading tilemap won't leave it dangling
+     */
+    struct TileProxy {
+        uint32_t m_gid{};
+        Region m_dst;
+        Flags<Flip> m_flip;
+        float m_y_sorting{};
+    };
+
+    /**
+     * proxies of ChunkSize x ChunkSize tiles, culled as a whole
+     */
+    struct TileChunk {
+        Rect m_bounds;
+        uint32_t m_begin{}, m_end{};  // range in tile proxies
+    };
+
+    static constexpr size_t ChunkSize = 16;
+
     TilemapLayerRenderComponent(Entity entity,
                                const TilemapLayerDefinition& create_info);
 
     [[nodiscard]] const TilemapLayer* GetLayer() const;
+
+    /**
+     * find tilemap by uuid from asset manager
+     * @return null if tilemap was unloaded
+     */
     [[nodiscard]] const Tilemap* GetTilemap() const;
 
+    [[nodiscard]] const std::vector<TileProxy>& GetTileProxies() const;
+    [[nodiscard]] const std::vector<TileChunk>& GetTileChunks() const;
+
 private:
-    std::unique_ptr<TilemapLayer> m_tilemap_layer;
-    TilemapHandle m_tilemap_handle;  // FIXME: component rely on asset may cause
-                                     // asset dangling reference
+    std::shared_ptr<const TilemapLayer> m_tilemap_layer;
+    TilemapHandle m_tilemap_handle;
+    const Tilemap* m_built_tilemap{};  // tilemap proxies built from
     std::string m_name;
+    std::vector<TileProxy> m_tile_proxies;
+    std::vector<TileChunk> m_tile_chunks;
+
+    /**
+     * `GetTilemap`, and rebuild proxies if tilemap was reloaded
+     */
+    const Tilemap* refreshTilemap();
+
+    bool findLayer(const Tilemap&);
+    void buildTileProxies(const Tilemap&);
 };
 
 class TilemapLayerRenderComponentManager
@@ -28,6 +69,6 @@ public:
     void SubmitDrawCommand(Entity);
 
 private:
-    void drawTilemapLayer(const DrawOrder*,
+    void drawTilemapLayer(const DrawOrder*, const Tilemap&,
                           const TilemapLayerRenderComponent& tilemap);
 };
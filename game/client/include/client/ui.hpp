@@ -41,11 +41,11 @@ public:
     void DeleteBeforeCursor();
     void DeleteAfterCursor();
 
-    Image& GetTextImage();
-    Vec2 GetTextImageSize() const;
+    const TextLayout& GetTextLayout() const;
+    Vec2 GetTextSize() const;
     void RefreshText();
 
-    float GetCursorX();
+    float GetCursorX() const;
 
     void HandleTextInput(const SDL_TextInputEvent& event);
 
@@ -53,12 +53,9 @@ private:
     FontHandle m_font;
     uint32_t m_pt = 16;
     UTF8String m_text;
-    Image m_text_image;
+    TextLayout m_text_layout;
     size_t m_cursor_pos = 0;
 
-    mutable float m_cursor_x_cache = 0;
-    mutable bool m_cursor_x_dirty = true;
-
     void regenerateText();
 };
 
@@ -69,17 +66,18 @@ public:
     Color m_color{0, 0, 0, 1};
 
     void SetFont(FontHandle);
+    FontHandle GetFont() const;
     void SetFontSize(uint32_t pt);
     void ChangeText(const std::string& text);
-    Vec2 GetTextImageSize() const;
+    Vec2 GetTextSize() const;
     [[nodiscard]] const std::string& GetText() const;
-    Image& GetTextImage();
+    const TextLayout& GetTextLayout() const;
 
 private:
     FontHandle m_font;
     uint32_t m_pt_size = 16;
     std::string m_text;
-    Image m_text_image;
+    TextLayout m_text_layout;
 
     void regenerateText();
 };
@@ -187,26 +185,104 @@ struct UIDragEvent {
     Entity m_entity;
 };
 
+/**
+ * uniform grid over widget screen rects for pointer hit test.
+ * Cell size grows when rects spread too far, so cell count is bounded
+ */
+class UIHitGrid {
+public:
+    static constexpr float CellSize = 64;
+    static constexpr int MaxCellCount = 64;  // per axis
+
+    /**
+     * @param first rects before it are not added
+     */
+    void Build(const std::vector<Rect>& rects, size_t first = 0);
+
+    /**
+     * @param hits indices of rects containing position in ascending order
+     */
+    void Query(const Vec2& position, const std::vector<Rect>& rects,
+               std::vector<uint32_t>& hits) const;
+
+private:
+    Vec2 m_min;
+    Vec2 m_cell_size;
+    int m_cols{}, m_rows{};
+
+    // rect indices of cell i are m_items[m_cell_begin[i], m_cell_begin[i + 1])
+    std::vector<uint32_t> m_cell_begin;
+    std::vector<uint32_t> m_items;
+};
+
 class UIComponentManager : public ComponentManager<UIWidget> {
 public:
     UIComponentManager();
     ~UIComponentManager() override;
+
+    template <typename... Args>
+    void RegisterEntity(Entity entity, Args&&... args) {
+        ComponentManager::RegisterEntity(entity, std::forward<Args>(args)...);
+        InvalidateLayout();
+    }
+
+    void RemoveEntity(Entity entity) override;
+
     void Update(TimeType elapse_time);
     void SubmitDrawCommand(Entity);
     void HandleEvent();
 
+    /**
+     * force rebuilding cached widget hierarchy. Children changes are detected
+     * by `Relationship::GetVersion`, so only needed for other changes
+     */
+    void InvalidateLayout();
+
     void SetFocusedWidget(Entity entity);
     Entity GetFocusedWidget() const;
     bool IsFocusedWidget(Entity entity) const;
     bool IsCursorVisible() const;
 
 private:
-    void updateSize(Entity);
-    void updateTransform(Entity);
+    static constexpr uint32_t NoParent = UINT32_MAX;
+
+    /**
+     * widget cached in depth-first order, the first one is ui root
+     */
+    struct LayoutNode {
+        Entity m_entity{};
+        UIWidget* m_ui{};
+        Transform* m_transform{};
+        const Relationship* m_relationship{};
+        uint32_t m_relationship_version{};
+        uint32_t m_parent = NoParent;
+    };
+
+    /**
+     * rebuild nodes if hierarchy changed
+     */
+    void refreshLayoutNodes(Entity root);
+    void collectLayoutNodes(Entity, uint32_t parent);
+
+    /**
+     * update cached screen rects, rebuild hit grid if any of them changed
+     */
+    void refreshScreenRects();
+    void updateSize();
+    void updateTransform();
+
+    /**
+     * widget receives pointer event if it's child of ui root or child of
+     * disabled widget which receives event
+     */
+    bool isEventTarget(uint32_t node) const;
+
     /**
      * @param finger_index -1 means mouse
      */
-    void handleEvent(Entity, size_t finger_index, const Button&,
+    void handlePointer(size_t finger_index, const Button&,
+                       const Vec2& position, const Vec2& offset);
+    void handleEvent(uint32_t node, size_t finger_index, const Button&,
                      const Vec2& position, const Vec2& offset);
     void render(Renderer&, Entity);
     bool isFocusing(const UIWidget&, size_t finger_index) const;
@@ -219,6 +295,20 @@ private:
     bool m_is_first_update = true;
     Entity m_focused_entity{};
 
+    Entity m_layout_root{};
+    uint32_t m_relationship_manager_version = 0;
+    bool m_layout_dirty = true;
+    bool m_hit_grid_dirty = true;
+    std::vector<LayoutNode> m_layout_nodes;
+    std::vector<Rect> m_screen_rects;  // parallel to m_layout_nodes
+    UIHitGrid m_hit_grid;
+
+    // nodes hovered, pressed or focused by pointer, they must be handled
+    // even pointer leaves them
+    std::vector<uint32_t> m_pointer_nodes;
+    std::vector<uint32_t> m_hit_nodes;
+    std::vector<uint32_t> m_handling_nodes;  // reused by handlePointer
+
     // for UITextInput
     float m_cursor_timer = 0;
     bool m_cursor_visible = true;
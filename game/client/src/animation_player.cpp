@@ -39,13 +39,9 @@ void AnimationPlayer::Rewind() {
     if (!m_animation) {
         return;
     }
-    for (auto& [_, track] : m_track_players) {
-        track->Rewind();
-    }
-    for (auto& [_, track] : m_bind_point_track_players) {
-        track->Rewind();
-    }
+    std::fill(m_frame_hints.begin(), m_frame_hints.end(), 0);
     m_cur_time = 0.0f;
+    m_need_sync = false;
 }
 
 void AnimationPlayer::SetLoop(int loop) {
@@ -68,38 +64,12 @@ TimeType AnimationPlayer::GetMaxTime() const {
     if (!m_animation) {
         return 0;
     }
-    TimeType max_time = 0;
-    for (auto& [_, track] : m_animation->GetTracks()) {
-        max_time = std::max(max_time, track->GetFinishTime());
-    }
-    for (auto& [_, track] : m_animation->GetBindPointTracks()) {
-        max_time = std::max(max_time, track->GetFinishTime());
-    }
-    return max_time;
+    return m_animation->GetClip().GetDuration();
 }
 
-#define HANDLE_TRACK_BINDING_POINT(binding) if (binding_point == binding)
-#define HANDLE_LINEAR_TRACK_CREATION()                                         \
-    if (track->GetType() == AnimationTrackType::Linear) {                      \
-        auto& raw_track = static_cast<                                         \
-            AnimationTrack<TARGET_TYPE, AnimationTrackType::Linear>&>(*track); \
-        m_track_players[binding_point] = std::make_unique<                     \
-            AnimationTrackPlayer<TARGET_TYPE, AnimationTrackType::Linear>>(    \
-            raw_track);                                                        \
-    }
-#define HANDLE_DISCRETE_TRACK_CREATION()                                      \
-    if (track->GetType() == AnimationTrackType::Discrete) {                   \
-        auto& raw_track = static_cast<                                        \
-            AnimationTrack<TARGET_TYPE, AnimationTrackType::Discrete>&>(      \
-            *track);                                                          \
-        m_track_players[binding_point] = std::make_unique<                    \
-            AnimationTrackPlayer<TARGET_TYPE, AnimationTrackType::Discrete>>( \
-            raw_track);                                                       \
-    }
-
 void AnimationPlayer::ChangeAnimation(AnimationHandle animation) {
     m_animation = animation;
-    m_track_players.clear();
+    m_frame_hints.clear();
 
     Stop();
 
@@ -107,108 +77,13 @@ void AnimationPlayer::ChangeAnimation(AnimationHandle animation) {
         return;
     }
 
+    m_frame_hints.resize(m_animation->GetClip().GetTrackCount(), 0);
+
     if (m_auto_play) {
         Play();
     }
-
-    auto& tracks = m_animation->GetTracks();
-    for (auto& [binding_point, track] : tracks) {
-#define TARGET_TYPE Vec2
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::TransformPosition) {
-            HANDLE_LINEAR_TRACK_CREATION();
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Vec2
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::TransformScale) {
-            HANDLE_LINEAR_TRACK_CREATION();
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Degrees
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::TransformRotation) {
-            HANDLE_LINEAR_TRACK_CREATION();
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Flags<Flip>
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::SpriteFlip) {
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE ImageHandle
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::SpriteImage) {
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Vec2
-        HANDLE_TRACK_BINDING_POINT(
-            AnimationBindingPoint::SpriteRegionPosition) {
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Vec2
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::SpriteRegionSize) {
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Vec2
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::SpriteSize) {
-            HANDLE_LINEAR_TRACK_CREATION()
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Vec2
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::SpriteAnchor) {
-            HANDLE_LINEAR_TRACK_CREATION()
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-
-#define TARGET_TYPE Color
-        HANDLE_TRACK_BINDING_POINT(AnimationBindingPoint::SpriteColor) {
-            HANDLE_LINEAR_TRACK_CREATION()
-            HANDLE_DISCRETE_TRACK_CREATION();
-        }
-#undef TARGET_TYPE
-    }
-
-    auto& bind_point_tracks = m_animation->GetBindPointTracks();
-    for (auto& [name, track] : bind_point_tracks) {
-        if (track->GetType() == AnimationTrackType::Linear) {
-            auto& raw_track =
-                static_cast<AnimationTrack<Vec2, AnimationTrackType::Linear>&>(
-                    *track);
-            m_bind_point_track_players.emplace(
-                name,
-                std::make_unique<
-                    AnimationTrackPlayer<Vec2, AnimationTrackType::Linear>>(
-                    raw_track));
-        }
-        if (track->GetType() == AnimationTrackType::Discrete) {
-            auto& raw_track = static_cast<
-                AnimationTrack<Vec2, AnimationTrackType::Discrete>&>(*track);
-            m_bind_point_track_players.emplace(
-                name,
-                std::make_unique<
-                    AnimationTrackPlayer<Vec2, AnimationTrackType::Discrete>>(
-                    raw_track));
-        }
-    }
 }
 
-#undef HANDLE_LINEAR_TRACK_CREATION
-#undef HANDLE_DISCRETE_TRACK_CREATION
-#undef HANDLE_TRACK_BINDING_POINT
-
 void AnimationPlayer::ChangeAnimation(const Path& filename) {
     auto animation =
         CLIENT_CONTEXT.m_assets_manager->GetManager<Animation>().Find(filename);
@@ -230,152 +105,99 @@ bool AnimationPlayer::HasAnimation() const {
 }
 
 void AnimationPlayer::Update(TimeType delta_time) {
-    float elapsed_time = delta_time * m_rate;
-
     if (!m_is_playing || !m_animation ||
-        (m_track_players.empty() && m_bind_point_track_players.empty())) {
+        m_animation->GetClip().GetTrackCount() == 0) {
         return;
     }
 
-    m_cur_time += elapsed_time;
-    for (auto& [_, track] : m_track_players) {
-        track->Update(elapsed_time);
-    }
-    for (auto& [_, track] : m_bind_point_track_players) {
-        track->Update(elapsed_time);
+    m_cur_time += delta_time * m_rate;
+    m_need_sync = true;
+
+    // clip is recompiled when animation edited
+    size_t track_count = m_animation->GetClip().GetTrackCount();
+    if (m_frame_hints.size() != track_count) {
+        m_frame_hints.assign(track_count, 0);
     }
 
-    if (m_cur_time >= GetMaxTime()) {
+    TimeType max_time = GetMaxTime();
+    if (m_cur_time >= max_time) {
         if (m_loop > 0 || m_loop == InfLoop) {
-            TimeType backup_time = m_cur_time;
-            Rewind();
-            m_cur_time = backup_time - GetMaxTime();
-
-            for (auto& [_, track] : m_track_players) {
-                track->Update(m_cur_time);
-            }
-            for (auto& [_, track] : m_bind_point_track_players) {
-                track->Update(elapsed_time);
-            }
+            m_cur_time -= max_time;
 
             if (m_loop != InfLoop) {
                 m_loop--;
             }
         } else {
             Pause();
-            m_cur_time = GetMaxTime();
+            m_cur_time = max_time;
         }
     }
 }
 
-#define BEGIN_BINDING_POINT(binding) \
-    if (auto it = m_track_players.find(binding); it != m_track_players.end())
+void AnimationPlayer::Sync(Entity entity) {
+    TL_RETURN_IF_FALSE(NeedSync());
 
-#define HANDLE_LINEAR_TRACK()                                        \
-    if (it->second->GetType() == AnimationTrackType::Linear) {       \
-        auto& raw_track = static_cast<const AnimationTrackPlayer<    \
-            decltype(BINDING_TARGET), AnimationTrackType::Linear>&>( \
-            *it->second);                                            \
-        if (raw_track.NeedSync()) {                                  \
-            BINDING_TARGET = raw_track.GetValue();                   \
-        }                                                            \
-    }
-#define HANDLE_DISCRETE_TRACK()                                        \
-    if (it->second->GetType() == AnimationTrackType::Discrete) {       \
-        auto& raw_track = static_cast<const AnimationTrackPlayer<      \
-            decltype(BINDING_TARGET), AnimationTrackType::Discrete>&>( \
-            *it->second);                                              \
-        if (raw_track.NeedSync()) {                                    \
-            BINDING_TARGET = raw_track.GetValue();                     \
-        }                                                              \
+    AnimationPose pose;
+    SamplePose(pose);
+    ApplyPose(entity, pose);
+}
+
+bool AnimationPlayer::NeedSync() const {
+    return m_animation && m_need_sync;
+}
+
+void AnimationPlayer::SamplePose(AnimationPose& pose) {
+    auto& clip = m_animation->GetClip();
+    if (m_frame_hints.size() != clip.GetTrackCount()) {
+        m_frame_hints.assign(clip.GetTrackCount(), 0);
     }
+    clip.SamplePose(m_cur_time, m_frame_hints.data(), pose);
+}
 
-void AnimationPlayer::Sync(Entity entity) {
-    TL_RETURN_IF_FALSE(m_animation);
+void AnimationPlayer::ApplyPose(Entity entity,
+                                const AnimationPose& pose) const {
     auto& ctx = CLIENT_CONTEXT;
+    auto& clip = m_animation->GetClip();
 
     if (auto transform = ctx.m_transform_manager->Get(entity)) {
-#define BINDING_TARGET transform->m_position
-        BEGIN_BINDING_POINT(AnimationBindingPoint::TransformPosition) {
-            HANDLE_LINEAR_TRACK();
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET transform->m_scale
-        BEGIN_BINDING_POINT(AnimationBindingPoint::TransformScale) {
-            HANDLE_LINEAR_TRACK();
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET transform->m_rotation
-        BEGIN_BINDING_POINT(AnimationBindingPoint::TransformRotation) {
-            HANDLE_LINEAR_TRACK();
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
+        applyBindingPoint(clip, pose, AnimationBindingPoint::TransformPosition,
+                          transform->m_position);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::TransformScale,
+                          transform->m_scale);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::TransformRotation,
+                          transform->m_rotation);
     }
 
     if (auto sprite = ctx.m_sprite_manager->Get(entity)) {
-#define BINDING_TARGET sprite->m_image
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteImage) {
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET sprite->m_region.m_topleft
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteRegionPosition) {
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET sprite->m_region.m_size
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteRegionSize) {
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET sprite->m_size
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteSize) {
-            HANDLE_LINEAR_TRACK();
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET sprite->m_flip
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteFlip) {
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET sprite->m_anchor
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteAnchor) {
-            HANDLE_DISCRETE_TRACK();
-            HANDLE_LINEAR_TRACK();
-        }
-#undef BINDING_TARGET
-
-#define BINDING_TARGET sprite->m_color
-        BEGIN_BINDING_POINT(AnimationBindingPoint::SpriteColor) {
-            HANDLE_LINEAR_TRACK();
-            HANDLE_DISCRETE_TRACK();
-        }
-#undef BINDING_TARGET
+        applyBindingPoint(clip, pose, AnimationBindingPoint::SpriteImage,
+                          sprite->m_image);
+        applyBindingPoint(clip, pose,
+                          AnimationBindingPoint::SpriteRegionPosition,
+                          sprite->m_region.m_topleft);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::SpriteRegionSize,
+                          sprite->m_region.m_size);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::SpriteSize,
+                          sprite->m_size);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::SpriteFlip,
+                          sprite->m_flip);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::SpriteAnchor,
+                          sprite->m_anchor);
+        applyBindingPoint(clip, pose, AnimationBindingPoint::SpriteColor,
+                          sprite->m_color);
     }
 
     if (auto bind_points = ctx.m_bind_point_component_manager->Get(entity)) {
-        for (auto& [name, bind_point] : bind_points->m_bind_points) {
-            if (auto it = m_bind_point_track_players.find(name);
-                it != m_bind_point_track_players.end()) {
-#define BINDING_TARGET bind_point.m_position
-                HANDLE_DISCRETE_TRACK();
-                HANDLE_LINEAR_TRACK();
-#undef BINDING_TARGET
+        for (auto& track : clip.GetBindPointTracks()) {
+            auto it = bind_points->m_bind_points.find(track.m_name);
+            if (it == bind_points->m_bind_points.end()) {
+                continue;
+            }
+            if (auto value = pose.Get<Vec2>(clip, track.m_track)) {
+                it->second.m_position = *value;
+            }
         }
     }
 }
-}
 
 void AnimationPlayer::SetRate(float rate) {
     m_rate = std::max(0.0f, rate);
@@ -482,14 +304,52 @@ void MultiAnimationPlayer::RewindAll() {
     }
 }
 
+size_t MultiAnimationPlayerManager::SampleKeyHash::operator()(
+    const SampleKey& key) const {
+    return std::hash<const void*>{}(key.m_clip) ^
+           (std::hash<TimeType>{}(key.m_time) << 1);
+}
+
 void MultiAnimationPlayerManager::Update(TimeType delta_time) {
     PROFILE_SECTION();
 
+    m_sample_indices.clear();
+    m_sample_count = 0;
+    m_instances.clear();
+
     for (auto& [entity, anim] : m_components) {
         if (!anim.m_enable) {
             continue;
         }
-        anim.m_component->Update(delta_time);
-        anim.m_component->Sync(entity);
+        for (auto& player : anim.m_component->GetAnimations()) {
+            player.Update(delta_time);
+            if (!player.NeedSync()) {
+                continue;
+            }
+
+            SampleKey key{&player.GetAnimation()->GetClip(),
+                          player.GetCurTime()};
+            auto [it, inserted] =
+                m_sample_indices.emplace(key, m_sample_count);
+            if (inserted) {
+                if (m_sample_count == m_samples.size()) {
+                    m_samples.emplace_back();
+                }
+                m_samples[m_sample_count++].m_player = &player;
+            }
+            m_instances.push_back({entity, &player, it->second});
+        }
+    }
+
+    CLIENT_CONTEXT.m_worker_pool->ParallelFor(
+        m_sample_count, SampleChunkSize, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                m_samples[i].m_player->SamplePose(m_samples[i].m_pose);
+            }
+        });
+
+    for (auto& instance : m_instances) {
+        instance.m_player->ApplyPose(instance.m_entity,
+                                     m_samples[instance.m_sample].m_pose);
     }
 }
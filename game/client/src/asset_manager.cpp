@@ -11,5 +11,6 @@ ImageManagerBase& ClientAssetsManager::getImageManager(TypeIndex type_index) {
 }
 
 FontManagerBase& ClientAssetsManager::getFontManager(TypeIndex type_index) {
-    return ensureManager<ClientFontManager>(type_index);
+    return ensureManager<ClientFontManager>(type_index,
+                                            *CLIENT_CONTEXT.m_renderer);
 }
@@ -12,3 +12,13 @@ void Camera::transform(Vec2* center, Vec2* size) const {
         *size *= GetScale();
     }
 }
+
+Rect Camera::GetVisibleRect() const {
+    Vec2 window_size =
+        static_cast<Vec2>(CLIENT_CONTEXT.m_window->GetWindowSize());
+    Rect rect;
+    rect.m_center = GetPosition();
+    rect.m_half_size = Vec2{window_size.x * 0.5f / GetScale().x,
+                            window_size.y * 0.5f / GetScale().y};
+    return rect;
+}
@@ -15,6 +15,7 @@
 #include "client/input/gamepad.hpp"
 #include "client/input/keyboard.hpp"
 #include "client/input/mouse.hpp"
+#include "client/render_capture.hpp"
 #include "client/renderer.hpp"
 #include "client/scene.hpp"
 #include "client/sprite.hpp"
@@ -31,6 +32,7 @@
 #include "common/relationship.hpp"
 #include "common/scene.hpp"
 #include "common/script/script.hpp"
+#include "common/script/script_coroutine.hpp"
 #include "common/sdl_call.hpp"
 #include "common/serialize.hpp"
 #include "common/static_collision.hpp"
@@ -40,6 +42,7 @@
 #include "common/transform.hpp"
 #include "common/trigger.hpp"
 #include "common/uuid.hpp"
+#include "common/worker_pool.hpp"
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "schema/asset_info.hpp"
@@ -94,6 +97,15 @@ void ClientContext::Initialize(int argc, char** argv) {
     m_window = std::make_unique<Window>("TreasureLooter", 1024, 720);
     m_renderer = std::make_unique<Renderer>(*m_window);
     m_renderer->SetClearColor({0.3, 0.3, 0.3, 1});
+
+    // `--capture-render <file>` records frames for render_bench
+    auto& args = GetOSArgs();
+    for (size_t i = 1; i + 1 < args.size(); i++) {
+        if (args[i] == "--capture-render") {
+            m_renderer->StartCapture(std::string{args[i + 1]},
+                                     RenderCaptureWriter::DefaultFrameCount);
+        }
+    }
     initImGui();
 
     m_ui_manager = std::make_unique<UIComponentManager>();
@@ -130,11 +142,10 @@ void ClientContext::Initialize(int argc, char** argv) {
             client_config.m_input_config),
         *this);
 
-    SceneHandle level = m_assets_manager->GetManager<Scene>().Load(
-        GetCommonConfig().m_entry_scene);
-    m_scene_manager->Switch(level);
-
-    m_player_controller->RegisterVirtualController(level, client_config);
+    m_scene_manager->SwitchAsync(
+        GetCommonConfig().m_entry_scene, [this](SceneHandle level) {
+            m_player_controller->RegisterVirtualController(level, GetConfig());
+        });
 
     m_time->SetFPS(240);
 }
@@ -250,6 +261,9 @@ void ClientContext::logicUpdate(TimeType elapse) {
     }
 
     m_time->Update();
+
+    m_worker_pool->Update();
+
     m_gamepad_manager->Update();
     m_keyboard->Update();
     m_mouse->Update();
@@ -259,6 +273,7 @@ void ClientContext::logicUpdate(TimeType elapse) {
         m_global_script->Update();
     }
     m_script_component_manager->Update();
+    m_script_coroutine_scheduler->Update();
 
     m_animation_player_manager->Update(elapse);
     m_ui_manager->HandleEvent();
@@ -281,6 +296,8 @@ void ClientContext::logicPostUpdate(TimeType elapse) {
 
     m_mouse->PostUpdate();
     m_touches->PostUpdate();
+
+    m_physics_scene->UpdateStats(elapse);
 }
 
 void ClientContext::renderUpdate(TimeType elapse) {
@@ -303,10 +320,16 @@ void ClientContext::renderUpdate(TimeType elapse) {
     m_renderer->ApplyDrawcall();
 
     m_physics_scene->RenderDebug();
+    if (m_physics_scene->IsEnableDebugDraw()) {
+        m_physics_scene->RenderStatsPanel();
+    }
     m_bind_point_component_manager->RenderDebug(elapse);
     m_debug_drawer->Update(m_time->GetElapseTime());
     m_renderer->ApplyDrawcall();
 
+    // scene must be drawn before ImGui
+    m_renderer->Execute();
+
     endImGui();
     m_renderer->Present();
 }
@@ -8,22 +8,26 @@ constexpr uint32_t kZOrder = 1e8;
 
 void DebugDrawer::DrawRect(const Rect& r, const Color& color, TimeType time,
                            bool use_camera) {
-    m_rects.push_back({color, r, time, use_camera});
+    m_primitives.push_back({PrimitiveType::Rect, use_camera, color, r.m_center,
+                            r.m_half_size, 0, time});
 }
 
 void DebugDrawer::DrawCircle(const Circle& c, const Color& color, TimeType time,
                              bool use_camera) {
-    m_circles.push_back({color, c, time, use_camera});
+    m_primitives.push_back({PrimitiveType::Circle, use_camera, color,
+                            c.m_center, Vec2::ZERO, c.m_radius, time});
 }
 
 void DebugDrawer::FillRect(const Rect& r, const Color& color, TimeType time,
                            bool use_camera) {
-    m_fill_rects.push_back({color, r, time, use_camera});
+    m_primitives.push_back({PrimitiveType::FillRect, use_camera, color,
+                            r.m_center, r.m_half_size, 0, time});
 }
 
 void DebugDrawer::AddLine(const Vec2& p1, const Vec2& p2, const Color& color,
                           TimeType time, bool use_camera) {
-    m_segments.push_back({color, std::make_pair(p1, p2), time, use_camera});
+    m_primitives.push_back(
+        {PrimitiveType::Line, use_camera, color, p1, p2, 0, time});
 }
 
 void DebugDrawer::Update(TimeType elapse) {
@@ -32,60 +36,32 @@ void DebugDrawer::Update(TimeType elapse) {
     auto& renderer = CLIENT_CONTEXT.m_renderer;
 
     size_t i = 0;
-
-    while (i < m_rects.size()) {
-        auto& elem = m_rects[i];
-        renderer->DrawRect(elem.m_value, elem.m_color, kZOrder,
-                           elem.use_camera);
-        elem.m_time = decTime(elem.m_time, elapse);
-
-        if (elem.m_time == 0) {
-            m_rects.erase(m_rects.begin() + i);
-            continue;
+    while (i < m_primitives.size()) {
+        auto& elem = m_primitives[i];
+        switch (elem.m_type) {
+            case PrimitiveType::Rect:
+                renderer->DrawRect({elem.m_p1, elem.m_p2}, elem.m_color,
+                                   kZOrder, elem.m_use_camera);
+                break;
+            case PrimitiveType::FillRect:
+                renderer->FillRect({elem.m_p1, elem.m_p2}, elem.m_color,
+                                   kZOrder, elem.m_use_camera);
+                break;
+            case PrimitiveType::Circle:
+                renderer->DrawCircle({elem.m_p1, elem.m_radius}, elem.m_color,
+                                     20, kZOrder, elem.m_use_camera);
+                break;
+            case PrimitiveType::Line:
+                renderer->DrawLine(elem.m_p1, elem.m_p2, elem.m_color, kZOrder,
+                                   elem.m_use_camera);
+                break;
         }
 
-        i++;
-    }
-
-    i = 0;
-    while (i < m_fill_rects.size()) {
-        auto& elem = m_fill_rects[i];
-        renderer->FillRect(elem.m_value, elem.m_color, kZOrder,
-                           elem.use_camera);
         elem.m_time = decTime(elem.m_time, elapse);
-
-        if (elem.m_time == 0) {
-            m_fill_rects.erase(m_fill_rects.begin() + i);
-            continue;
-        }
-
-        i++;
-    }
-
-    i = 0;
-    while (i < m_circles.size()) {
-        auto& elem = m_circles[i];
-        renderer->DrawCircle(elem.m_value, elem.m_color, 20, kZOrder,
-                             elem.use_camera);
-        elem.m_time = decTime(elem.m_time, elapse);
-
-        if (elem.m_time == 0) {
-            m_circles.erase(m_circles.begin() + i);
-            continue;
-        }
-
-        i++;
-    }
-
-    i = 0;
-    while (i < m_segments.size()) {
-        auto& elem = m_segments[i];
-        renderer->DrawLine(elem.m_value.first, elem.m_value.second,
-                           elem.m_color, kZOrder, elem.use_camera);
-        elem.m_time = decTime(elem.m_time, elapse);
-
         if (elem.m_time == 0) {
-            m_segments.erase(m_segments.begin() + i);
+            // draw order of debug primitives doesn't matter
+            elem = m_primitives.back();
+            m_primitives.pop_back();
             continue;
         }
 
@@ -94,10 +70,7 @@ void DebugDrawer::Update(TimeType elapse) {
 }
 
 void DebugDrawer::Clear() {
-    m_circles.clear();
-    m_fill_rects.clear();
-    m_segments.clear();
-    m_rects.clear();
+    m_primitives.clear();
 }
 
 TimeType DebugDrawer::decTime(TimeType cur_time, TimeType elapse) {
@@ -1,25 +1,36 @@
 #include "client/font.hpp"
 
+#include "client/image.hpp"
+
 #include "common/log.hpp"
+#include "common/macros.hpp"
 #include "common/sdl_call.hpp"
 #include "common/storage.hpp"
 #include "SDL3_ttf/SDL_ttf.h"
 
-Font::Font(const Path& filename, int pt) {
+Font::Font(Renderer& renderer, const Path& filename, int pt)
+    : m_renderer{&renderer} {
     m_font = TTF_OpenFont(filename.string().c_str(), pt);
     if (!m_font) {
         LOGE("open font file {} failed: {}", filename.string(), SDL_GetError());
     }
 }
 
-Font::Font(Font&& o) noexcept {
-    m_font = o.m_font;
+Font::Font(Font&& o) noexcept
+    : m_renderer{o.m_renderer},
+      m_font{o.m_font},
+      m_glyph_atlas{std::move(o.m_glyph_atlas)},
+      m_glyph_caches{std::move(o.m_glyph_caches)} {
     o.m_font = nullptr;
 }
 
 Font& Font::operator=(Font&& o) noexcept {
     if (&o != this) {
+        TTF_CloseFont(m_font);
+        m_renderer = o.m_renderer;
         m_font = o.m_font;
+        m_glyph_caches = std::move(o.m_glyph_caches);
+        m_glyph_atlas = std::move(o.m_glyph_atlas);
         o.m_font = nullptr;
     }
     return *this;
@@ -44,6 +55,94 @@ SDL_Surface* Font::GenerateText(const std::string& text, const Color& color) con
     return surface;
 }
 
+TextLayout Font::LayoutText(const UTF8String& text, int pt) {
+    TextLayout layout;
+    TL_RETURN_VALUE_IF_FALSE(m_font, layout);
+
+    SDL_CALL(TTF_SetFontSize(m_font, pt));
+    GlyphCache& cache = m_glyph_caches[pt];
+
+    layout.m_pen_x.reserve(text.size() + 1);
+    float x = 0;
+    char32_t prev = 0;
+    for (char32_t cp : text) {
+        int kerning = 0;
+        if (prev && TTF_GetGlyphKerning(m_font, prev, cp, &kerning)) {
+            x += kerning;
+        }
+        layout.m_pen_x.push_back(x);
+
+        const Glyph& glyph = getGlyph(cache, cp);
+        if (glyph.m_image) {
+            layout.m_glyphs.push_back(TextGlyph{cp, {x, 0}});
+        }
+        x += glyph.m_advance;
+        prev = cp;
+    }
+    layout.m_pen_x.push_back(x);
+    layout.m_size = Vec2{x, static_cast<float>(TTF_GetFontHeight(m_font))};
+    layout.m_pt = pt;
+    return layout;
+}
+
+const ImageBase* Font::GetGlyphImage(char32_t cp, int pt) {
+    TL_RETURN_VALUE_IF_FALSE(m_font, nullptr);
+
+    auto cache_it = m_glyph_caches.find(pt);
+    if (cache_it != m_glyph_caches.end()) {
+        if (auto it = cache_it->second.find(cp); it != cache_it->second.end()) {
+            return it->second.m_image.get();
+        }
+    }
+
+    // font reloaded after laid out, rasterize again
+    SDL_CALL(TTF_SetFontSize(m_font, pt));
+    return getGlyph(m_glyph_caches[pt], cp).m_image.get();
+}
+
+const Font::Glyph& Font::getGlyph(GlyphCache& cache, char32_t cp) {
+    if (auto it = cache.find(cp); it != cache.end()) {
+        return it->second;
+    }
+
+    Glyph& glyph = cache[cp];
+    int advance = 0;
+    if (TTF_GetGlyphMetrics(m_font, cp, nullptr, nullptr, nullptr, nullptr,
+                            &advance)) {
+        glyph.m_advance = advance;
+    }
+
+    // glyph is rendered in a line-height box, so it can be placed at pen
+    // position directly
+    SDL_Surface* surface =
+        TTF_RenderGlyph_Blended(m_font, cp, SDL_Color{255, 255, 255, 255});
+    TL_RETURN_VALUE_IF_NULL(surface, glyph);
+    SDL_Surface* rgba = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(surface);
+    TL_RETURN_VALUE_IF_NULL(rgba, glyph);
+
+    if (!m_glyph_atlas) {
+        m_glyph_atlas =
+            std::make_unique<TextureAtlas>(*m_renderer, GlyphAtlasPageSize);
+    }
+    if (rgba->w <= TextureAtlas::MaxImageSize &&
+        rgba->h <= TextureAtlas::MaxImageSize) {
+        glyph.m_image = m_glyph_atlas->Pack(rgba->pixels, rgba->w, rgba->h,
+                                            rgba->pitch, Path{"glyph"});
+    }
+    if (glyph.m_image) {
+        SDL_DestroySurface(rgba);
+        return glyph;
+    }
+
+    LOGW("glyph U+{:04X} ({}x{}) can't be packed into atlas, use standalone "
+         "texture",
+         static_cast<uint32_t>(cp), rgba->w, rgba->h);
+    // Image takes ownership of surface
+    glyph.m_image = std::make_unique<Image>(*m_renderer, rgba);
+    return glyph;
+}
+
 int Font::GetHeight() const {
     return TTF_GetFontHeight(m_font);
 }
@@ -52,6 +151,9 @@ void Font::SetFontSize(int pt) {
     SDL_CALL(TTF_SetFontSize(m_font, pt));
 }
 
+ClientFontManager::ClientFontManager(Renderer& renderer)
+    : m_renderer{renderer} {}
+
 FontHandle ClientFontManager::Load(const Path& filename, bool force) {
     if (auto it = Find(filename); it && !force) {
         LOGW("font {} already loaded", filename);
@@ -59,5 +161,5 @@ FontHandle ClientFontManager::Load(const Path& filename, bool force) {
     }
 
     return store(&filename, UUIDv4::CreateV4(),
-                 std::make_unique<Font>(filename, 16));
+                 std::make_unique<Font>(m_renderer, filename, 16));
 }
@@ -5,7 +5,8 @@
 #include "stb_image.h"
 #include "common/storage.hpp"
 
-Image::Image(Renderer& renderer, SDL_Surface* surface) {
+Image::Image(Renderer& renderer, SDL_Surface* surface)
+    : m_destroy_queue{renderer.GetTextureDestroyQueue()} {
     m_texture = SDL_CreateTextureFromSurface(
         renderer.GetRenderer(), surface);
     if (!surface) {
@@ -15,57 +16,90 @@ Image::Image(Renderer& renderer, SDL_Surface* surface) {
     SDL_DestroySurface(surface);
 }
 
-Image::Image(Renderer& renderer, const Path& filename) {
-    int w, h;
-
+std::unique_ptr<ImagePixels> ImagePixels::Decode(const Path& filename) {
     auto file = IOStream::CreateFromFile(filename, IOMode::Read, true);
+    if (!file || !*file) {
+        LOGE("open image {} failed", filename);
+        return nullptr;
+    }
     auto content = file->Read();
 
-    stbi_uc* data =
-        stbi_load_from_memory((const stbi_uc*)content.data(), content.size(),
-                              &w, &h, nullptr, STBI_rgb_alpha);
-    if (!data) {
+    std::unique_ptr<ImagePixels> pixels{new ImagePixels};
+    pixels->m_data = stbi_load_from_memory(
+        (const stbi_uc*)content.data(), content.size(), &pixels->m_w,
+        &pixels->m_h, nullptr, STBI_rgb_alpha);
+    if (!pixels->m_data) {
         LOGE("load image {} failed", filename);
-        return;
+        return nullptr;
     }
+    return pixels;
+}
+
+ImagePixels::~ImagePixels() {
+    stbi_image_free(m_data);
+}
+
+int ImagePixels::GetWidth() const {
+    return m_w;
+}
+
+int ImagePixels::GetHeight() const {
+    return m_h;
+}
+
+void* ImagePixels::GetData() const {
+    return m_data;
+}
+
+Image::Image(Renderer& renderer, const Path& filename) {
+    if (auto pixels = ImagePixels::Decode(filename)) {
+        *this = Image{renderer, *pixels, filename};
+    }
+}
+
+Image::Image(Renderer& renderer, const ImagePixels& pixels,
+             const Path& filename)
+    : m_destroy_queue{renderer.GetTextureDestroyQueue()} {
+    int w = pixels.GetWidth(), h = pixels.GetHeight();
 
     SDL_Renderer* sdl_renderer = renderer.GetRenderer();
-    SDL_Surface* surface =
-        SDL_CreateSurfaceFrom(w, h, SDL_PIXELFORMAT_RGBA32, data, w * 4);
+    SDL_Surface* surface = SDL_CreateSurfaceFrom(
+        w, h, SDL_PIXELFORMAT_RGBA32, pixels.GetData(), w * 4);
     if (!surface) {
         LOGE("create SDL surface from {} failed: {}", filename, SDL_GetError());
-        stbi_image_free(data);
         return;
     }
     m_texture = SDL_CreateTextureFromSurface(sdl_renderer, surface);
     if (!m_texture) {
         LOGE("create SDL texture from {} failed: {}", filename, SDL_GetError());
-        stbi_image_free(data);
         SDL_DestroySurface(surface);
         return;
     }
     SDL_DestroySurface(surface);
 
     SDL_CALL(SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND));
-    stbi_image_free(data);
 
     SDL_SetTextureScaleMode(m_texture, SDL_SCALEMODE_NEAREST);
 }
 
-Image::Image(Image&& o) noexcept : m_texture{o.m_texture} {
+Image::Image(Image&& o) noexcept
+    : m_texture{o.m_texture}, m_destroy_queue{std::move(o.m_destroy_queue)} {
     o.m_texture = nullptr;
 }
 
 Image& Image::operator=(Image&& o) noexcept {
     if (&o != this) {
+        TextureDestroyQueue::Destroy(m_destroy_queue, m_texture);
         m_texture = o.m_texture;
+        m_destroy_queue = std::move(o.m_destroy_queue);
         o.m_texture = nullptr;
     }
     return *this;
 }
 
 Image::~Image() {
-    SDL_DestroyTexture(m_texture);
+    // passes recorded this frame may still draw it
+    TextureDestroyQueue::Destroy(m_destroy_queue, m_texture);
 }
 
 Vec2 Image::GetSize() const {
@@ -86,13 +120,60 @@ void Image::ChangeColorMask(const Color& color) {
     SDL_SetTextureAlphaMod(m_texture, color.a * 255);
 }
 
-ClientImageManager::ClientImageManager(Renderer& renderer) : m_renderer{renderer} {}
+ClientImageManager::ClientImageManager(Renderer& renderer)
+    : m_renderer{renderer}, m_atlas{renderer} {}
 
 ImageHandle ClientImageManager::Load(const Path& filename, bool force) {
-    if (auto it = Find(filename); it && !force) {
-        return it;
+    auto old = Find(filename);
+    if (old && !force) {
+        return old;
+    }
+
+    // release old space first so reloaded image can take it, and replace
+    // payload in place instead of leaking it under the old uuid
+    if (auto atlas_image = dynamic_cast<AtlasImage*>(old.Get())) {
+        m_atlas.Release(*atlas_image);
+    }
+
+    std::unique_ptr<ImageBase> image;
+    if (auto pixels = ImagePixels::Decode(filename)) {
+        image = createImage(*pixels, filename);
+    } else {
+        image = std::make_unique<Image>();
     }
+    return store(&filename, old ? old.GetUUID() : UUIDv4::CreateV4(),
+                 std::move(image));
+}
+
+void ClientImageManager::Unload(ImageHandle handle) {
+    if (auto atlas_image =
+            dynamic_cast<AtlasImage*>(Find(handle.GetUUID()).Get())) {
+        m_atlas.Release(*atlas_image);
+    }
+    ImageManagerBase::Unload(handle);
+}
 
-    return store(&filename, UUIDv4::CreateV4(),
-                 std::make_unique<Image>(m_renderer, filename));
+void ClientImageManager::loadAsync(const Path& filename,
+                                   const UUIDv4& pending_uuid) {
+    auto pixels = std::make_shared<std::unique_ptr<ImagePixels>>();
+    GetWorkerPool()->Submit(
+        [=]() { *pixels = ImagePixels::Decode(filename); },
+        [=]() {
+            AssetLoadResult<ImageBase> result;
+            result.m_uuid = UUIDv4::CreateV4();
+            if (*pixels) {
+                result.m_payload = createImage(**pixels, filename);
+            } else {
+                result.m_payload = std::make_unique<Image>();
+            }
+            finishAsyncLoad(filename, pending_uuid, std::move(result));
+        });
+}
+
+std::unique_ptr<ImageBase> ClientImageManager::createImage(
+    const ImagePixels& pixels, const Path& filename) {
+    if (auto image = m_atlas.Pack(pixels, filename)) {
+        return image;
+    }
+    return std::make_unique<Image>(m_renderer, pixels, filename);
 }
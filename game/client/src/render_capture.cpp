@@ -0,0 +1,248 @@
+#include "client/render_capture.hpp"
+#include "common/log.hpp"
+#include "common/macros.hpp"
+#include "common/storage.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+
+namespace {
+
+using DrawCommandVariant = decltype(DrawCommand::m_cmd);
+
+template <typename T, typename = void>
+struct HasTexture : std::false_type {};
+
+template <typename T>
+struct HasTexture<T, std::void_t<decltype(T::m_texture)>> : std::true_type {};
+
+// frames are a sequence of passes, each prefixed by `PassTag`
+constexpr uint8_t PassTag = 1;
+constexpr uint8_t FrameEndTag = 0;
+
+/**
+ * @param texture_id set if command draws texture
+ */
+template <size_t I = 0>
+bool readCommand(BinaryReader& reader, uint8_t type, size_t texture_count,
+                 DrawCommand& cmd, std::optional<uint32_t>& texture_id) {
+    if constexpr (I < std::variant_size_v<DrawCommandVariant>) {
+        if (type != I) {
+            return readCommand<I + 1>(reader, type, texture_count, cmd,
+                                      texture_id);
+        }
+
+        std::variant_alternative_t<I, DrawCommandVariant> value;
+        reader.Read(value);
+        if constexpr (HasTexture<decltype(value)>::value) {
+            uint32_t id = 0;
+            reader.Read(id);
+            TL_RETURN_FALSE_IF_FALSE(id < texture_count);
+            value.m_texture = nullptr;
+            texture_id = id;
+        }
+        cmd.m_cmd = value;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+}  // namespace
+
+RenderCaptureWriter::RenderCaptureWriter(const Path& filename,
+                                         uint32_t frame_count,
+                                         const Vec2UI& viewport_size)
+    : m_filename{filename},
+      m_frame_count{frame_count},
+      m_viewport_size{viewport_size} {
+    LOGI("capturing {} frames into {}", frame_count, filename);
+}
+
+void RenderCaptureWriter::RecordPass(const DrawPass& pass) {
+    m_frames.Write(PassTag);
+
+    m_frames.Write(static_cast<uint32_t>(pass.m_commands.size()));
+    for (auto& cmd : pass.m_commands) {
+        m_frames.Write(static_cast<uint8_t>(cmd.m_cmd.index()));
+        m_frames.Write(cmd.m_color);
+        m_frames.Write(cmd.m_z_order);
+        m_frames.Write(cmd.m_y_sorting);
+        std::visit(
+            [this](const auto& payload) {
+                auto value = payload;
+                if constexpr (HasTexture<decltype(value)>::value) {
+                    value.m_texture = nullptr;
+                    m_frames.Write(value);
+                    m_frames.Write(getTextureID(payload.m_texture));
+                } else {
+                    m_frames.Write(value);
+                }
+            },
+            cmd.m_cmd);
+    }
+
+    m_frames.Write(static_cast<uint32_t>(pass.m_y_sorting_range.size()));
+    for (auto& [begin, end] : pass.m_y_sorting_range) {
+        m_frames.Write(static_cast<uint32_t>(begin));
+        m_frames.Write(static_cast<uint32_t>(end));
+    }
+
+    m_frames.Write(static_cast<uint32_t>(pass.m_points.size()));
+    m_frames.Write(pass.m_points.data(),
+                   pass.m_points.size() * sizeof(SDL_FPoint));
+}
+
+bool RenderCaptureWriter::EndFrame() {
+    m_frames.Write(FrameEndTag);
+    m_captured_frame_count++;
+    TL_RETURN_FALSE_IF_FALSE(m_captured_frame_count >= m_frame_count);
+
+    save();
+    return true;
+}
+
+uint32_t RenderCaptureWriter::getTextureID(SDL_Texture* texture) {
+    auto [it, inserted] = m_texture_ids.emplace(
+        texture, static_cast<uint32_t>(m_texture_sizes.size()));
+    if (inserted) {
+        Vec2 size;
+        SDL_GetTextureSize(texture, &size.w, &size.h);
+        m_texture_sizes.push_back(size);
+    }
+    return it->second;
+}
+
+void RenderCaptureWriter::save() const {
+    BinaryWriter writer;
+    writer.Write(Magic);
+    writer.Write(Version);
+    writer.Write(m_viewport_size);
+    writer.Write(static_cast<uint32_t>(m_texture_sizes.size()));
+    for (auto& size : m_texture_sizes) {
+        writer.Write(size);
+    }
+    writer.Write(m_captured_frame_count);
+    writer.Write(m_frames.GetBuffer().data(), m_frames.GetBuffer().size());
+
+    if (!writer.SaveToFile(m_filename)) {
+        LOGE("save render capture {} failed", m_filename);
+        return;
+    }
+    LOGI("render capture saved to {}, {} frames, {} bytes", m_filename,
+         m_captured_frame_count, writer.GetBuffer().size());
+}
+
+std::unique_ptr<RenderCapture> RenderCapture::Load(const Path& filename) {
+    auto file = MappedFile::Open(filename);
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(file, nullptr, LOGE,
+                                      "open render capture {} failed",
+                                      filename);
+    BinaryReader reader{file->GetData(), file->GetSize()};
+
+    std::array<char, 4> magic{};
+    uint32_t version = 0;
+    reader.Read(magic);
+    reader.Read(version);
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(
+        magic == RenderCaptureWriter::Magic &&
+            version == RenderCaptureWriter::Version,
+        nullptr, LOGE, "{} is not a render capture of version {}", filename,
+        RenderCaptureWriter::Version);
+
+    auto capture = std::make_unique<RenderCapture>();
+    reader.Read(capture->m_viewport_size);
+
+    // textures are created later, commands get them in `CreateTextures`
+    uint32_t texture_count = reader.ReadCount();
+    for (uint32_t i = 0; i < texture_count; i++) {
+        reader.Read(capture->m_texture_sizes.emplace_back());
+    }
+
+    uint32_t frame_count = reader.ReadCount();
+    capture->m_frames.resize(frame_count);
+    for (uint32_t frame_idx = 0; frame_idx < frame_count; frame_idx++) {
+        auto& frame = capture->m_frames[frame_idx];
+        uint8_t tag = FrameEndTag;
+        while (reader.Read(tag) && tag == PassTag) {
+            auto& pass = frame.emplace_back();
+
+            uint32_t cmd_count = reader.ReadCount();
+            for (uint32_t i = 0; i < cmd_count; i++) {
+                uint8_t type = 0;
+                DrawCommand cmd;
+                std::optional<uint32_t> texture_id;
+                reader.Read(type);
+                reader.Read(cmd.m_color);
+                reader.Read(cmd.m_z_order);
+                reader.Read(cmd.m_y_sorting);
+                TL_RETURN_VALUE_IF_FALSE_WITH_LOG(
+                    readCommand(reader, type, texture_count, cmd, texture_id),
+                    nullptr, LOGE, "render capture {} is broken", filename);
+                if (texture_id) {
+                    capture->m_texture_bindings.push_back(
+                        {frame_idx, static_cast<uint32_t>(frame.size() - 1), i,
+                         *texture_id});
+                }
+                pass.Push(std::move(cmd));
+            }
+
+            uint32_t range_count = reader.ReadCount();
+            for (uint32_t i = 0; i < range_count; i++) {
+                uint32_t begin = 0, end = 0;
+                reader.Read(begin);
+                reader.Read(end);
+                pass.m_y_sorting_range.emplace_back(begin, end);
+            }
+
+            pass.m_points.resize(reader.ReadCount());
+            reader.Read(pass.m_points.data(),
+                        pass.m_points.size() * sizeof(SDL_FPoint));
+        }
+    }
+
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(reader.IsValid(), nullptr, LOGE,
+                                      "render capture {} is broken", filename);
+    return capture;
+}
+
+void RenderCapture::CreateTextures(Renderer& renderer) {
+    m_textures.clear();
+    for (auto& size : m_texture_sizes) {
+        SDL_Surface* surface =
+            SDL_CreateSurface(std::max<int>(size.w, 1),
+                              std::max<int>(size.h, 1), SDL_PIXELFORMAT_RGBA32);
+        if (!surface) {
+            LOGE("create surface failed: {}", SDL_GetError());
+            m_textures.push_back(std::make_unique<Image>());
+            continue;
+        }
+        SDL_FillSurfaceRect(surface, nullptr, 0xFFFFFFFF);
+        m_textures.push_back(std::make_unique<Image>(renderer, surface));
+    }
+
+    for (auto& binding : m_texture_bindings) {
+        auto& cmd = m_frames[binding.m_frame][binding.m_pass]
+                        .m_commands[binding.m_command];
+        SDL_Texture* texture = binding.m_texture < m_textures.size()
+                                   ? m_textures[binding.m_texture]->GetTexture()
+                                   : nullptr;
+        std::visit(
+            [texture](auto& payload) {
+                if constexpr (HasTexture<std::decay_t<decltype(payload)>>::
+                                  value) {
+                    payload.m_texture = texture;
+                }
+            },
+            cmd.m_cmd);
+    }
+}
+
+const std::vector<RenderCapture::Frame>& RenderCapture::GetFrames() const {
+    return m_frames;
+}
+
+const Vec2UI& RenderCapture::GetViewportSize() const {
+    return m_viewport_size;
+}
@@ -4,13 +4,44 @@
 
 #include "client/camera.hpp"
 #include "client/context.hpp"
+#include "client/render_capture.hpp"
 #include "common/log.hpp"
 #include "common/macros.hpp"
 #include "common/physics.hpp"
 #include "common/profile.hpp"
+#include "common/radix_sort.hpp"
 #include "common/sdl_call.hpp"
 
-Renderer::Renderer(Window& window) {
+TextureDestroyQueue::~TextureDestroyQueue() {
+    Flush();
+}
+
+void TextureDestroyQueue::Push(SDL_Texture* texture) {
+    if (texture) {
+        m_textures.push_back(texture);
+    }
+}
+
+void TextureDestroyQueue::Flush() {
+    for (auto texture : m_textures) {
+        SDL_DestroyTexture(texture);
+    }
+    m_textures.clear();
+}
+
+void TextureDestroyQueue::Destroy(
+    const std::weak_ptr<TextureDestroyQueue>& queue, SDL_Texture* texture) {
+    if (auto locked = queue.lock()) {
+        locked->Push(texture);
+    } else {
+        SDL_DestroyTexture(texture);
+    }
+}
+
+Renderer::Renderer(Window& window)
+    : m_window{&window},
+      m_recording_pass{std::make_unique<DrawPass>()},
+      m_texture_destroy_queue{std::make_shared<TextureDestroyQueue>()} {
     m_renderer = SDL_CreateRenderer(window.GetWindow(), nullptr);
     if (!m_renderer) {
         LOGE("create SDL renderer failed: {}", SDL_GetError());
@@ -18,7 +49,18 @@ Renderer::Renderer(Window& window) {
     SDL_CALL(SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND));
 }
 
+Renderer::Renderer(SDL_Surface* target)
+    : m_recording_pass{std::make_unique<DrawPass>()},
+      m_texture_destroy_queue{std::make_shared<TextureDestroyQueue>()} {
+    m_renderer = SDL_CreateSoftwareRenderer(target);
+    if (!m_renderer) {
+        LOGE("create software renderer failed: {}", SDL_GetError());
+    }
+    SDL_CALL(SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND));
+}
+
 Renderer::~Renderer() {
+    m_texture_destroy_queue->Flush();
     SDL_DestroyTexture(m_text_texture);
     SDL_DestroyRenderer(m_renderer);
 }
@@ -50,7 +92,7 @@ void Renderer::DrawLine(const Vec2& p1, const Vec2& p2, const Color& color,
 
     cmd.m_cmd = cmd_line;
 
-    m_draw_commands.emplace_back(std::move(cmd));
+    pushDrawCommand(std::move(cmd));
 }
 
 void Renderer::DrawRect(const Rect& r, const Color& c, double z_order,
@@ -71,40 +113,48 @@ void Renderer::DrawRect(const Rect& r, const Color& c, double z_order,
 
     cmd.m_cmd = cmd_rect;
 
-    m_draw_commands.emplace_back(std::move(cmd));
+    pushDrawCommand(std::move(cmd));
 }
 
 void Renderer::DrawCircle(const Circle& c, const Color& color,
                           uint32_t fragment, double z_order, bool use_camera,
                           float y_sorting) {
+    TL_RETURN_IF_TRUE(fragment == 0);
+
     Radians angle_step = 2 * PI / fragment;
-    Vec2 p = c.m_center + Vec2::X_UNIT * c.m_radius;
     auto& camera = CLIENT_CONTEXT.m_camera;
-    if (use_camera) {
-        transformByCamera(camera, &p, nullptr);
-    }
-    for (int i = 1; i <= fragment; i++) {
-        Vec2 new_p = c.m_center;
+    auto& points = m_recording_pass->m_points;
+    uint32_t first = points.size();
+    for (uint32_t i = 0; i <= fragment; i++) {
+        Vec2 p = c.m_center;
         Radians angle = angle_step * i;
-        new_p.x += c.m_radius * std::cos(angle.Value());
-        new_p.y += c.m_radius * std::sin(angle.Value());
+        p.x += c.m_radius * std::cos(angle.Value());
+        p.y += c.m_radius * std::sin(angle.Value());
         if (use_camera) {
-            transformByCamera(camera, &new_p, nullptr);
+            transformByCamera(camera, &p, nullptr);
         }
+        points.push_back({p.x, p.y});
+    }
 
-        DrawCommand cmd;
-        cmd.m_color = color;
-        cmd.m_z_order = z_order;
-        cmd.m_y_sorting = y_sorting;
+    pushLineStrip(first, color, z_order, y_sorting);
+}
 
-        DrawLineCommand cmd_line;
-        cmd_line.m_p1 = p;
-        cmd_line.m_p2 = new_p;
-        cmd.m_cmd = cmd_line;
+void Renderer::DrawLineStrip(const Vec2* pts, size_t count,
+                             const Color& color, double z_order,
+                             bool use_camera, float y_sorting) {
+    TL_RETURN_IF_TRUE(count < 2);
 
-        m_draw_commands.emplace_back(std::move(cmd));
-        p = new_p;
+    auto& points = m_recording_pass->m_points;
+    uint32_t first = points.size();
+    for (size_t i = 0; i < count; i++) {
+        Vec2 p = pts[i];
+        if (use_camera) {
+            transformByCamera(CLIENT_CONTEXT.m_camera, &p, nullptr);
+        }
+        points.push_back({p.x, p.y});
     }
+
+    pushLineStrip(first, color, z_order, y_sorting);
 }
 
 void Renderer::FillRect(const Rect& r, const Color& c, double z_order,
@@ -124,7 +174,16 @@ void Renderer::FillRect(const Rect& r, const Color& c, double z_order,
     cmd_rect.m_rect = dst;
     cmd.m_cmd = cmd_rect;
 
-    m_draw_commands.emplace_back(std::move(cmd));
+    pushDrawCommand(std::move(cmd));
+}
+
+/**
+ * convert region in image to region in its texture(image may be in atlas)
+ */
+static Region toTextureRegion(const ImageBase& image, const Region& src) {
+    Region region = src;
+    region.m_topleft += image.GetTextureRegion().m_topleft;
+    return region;
 }
 
 void Renderer::DrawImage(const ImageBase& image, const Region& src,
@@ -151,16 +210,16 @@ void Renderer::DrawImage(const ImageBase& image, const Region& src,
     cmd.m_color = color;
 
     DrawImageCommand cmd_image;
-    cmd_image.m_src = src;
+    cmd_image.m_src = toTextureRegion(image, src);
     cmd_image.m_dst = dst_region;
     cmd_image.m_rot_center = rot_center;
     cmd_image.m_rotation = rotation;
     cmd_image.m_flip = flip;
-    cmd_image.m_image = &image;
+    cmd_image.m_texture = image.GetTexture();
 
     cmd.m_cmd = cmd_image;
 
-    m_draw_commands.emplace_back(std::move(cmd));
+    pushDrawCommand(std::move(cmd));
 }
 
 void Renderer::DrawImage9Grid(const ImageBase& image, const Region& src,
@@ -183,15 +242,30 @@ void Renderer::DrawImage9Grid(const ImageBase& image, const Region& src,
     cmd.m_y_sorting = y_sorting;
 
     DrawImage9GridCommand cmd_image;
-    cmd_image.m_src = src;
+    cmd_image.m_src = toTextureRegion(image, src);
     cmd_image.m_dst = dst_region;
-    cmd_image.m_image = &image;
+    cmd_image.m_texture = image.GetTexture();
     cmd_image.border_scale = border_scale;
     cmd_image.m_grid = grid;
 
     cmd.m_cmd = cmd_image;
 
-    m_draw_commands.emplace_back(std::move(cmd));
+    pushDrawCommand(std::move(cmd));
+}
+
+void Renderer::DrawTextLayout(FontBase& font, const TextLayout& layout,
+                              const Vec2& topleft, const Color& color,
+                              double z_order, bool use_camera,
+                              float y_sorting) {
+    for (auto& glyph : layout.m_glyphs) {
+        const ImageBase* image =
+            font.GetGlyphImage(glyph.m_codepoint, layout.m_pt);
+        TL_CONTINUE_IF_NULL(image);
+        Vec2 size = image->GetSize();
+        DrawImage(*image, Region{Vec2::ZERO, size},
+                  Region{topleft + glyph.m_position, size}, color, 0, {},
+                  Flip::None, z_order, use_camera, y_sorting);
+    }
 }
 
 void Renderer::DrawImageEx(const ImageBase& image, const Region& src,
@@ -212,14 +286,14 @@ void Renderer::DrawImageEx(const ImageBase& image, const Region& src,
     cmd.m_color = color;
 
     DrawImageExCommand cmd_image;
-    cmd_image.m_image = &image;
-    cmd_image.m_src = src;
+    cmd_image.m_texture = image.GetTexture();
+    cmd_image.m_src = toTextureRegion(image, src);
     cmd_image.m_origin = tl;
     cmd_image.m_down = bl;
     cmd_image.m_right = tr;
 
     cmd.m_cmd = cmd_image;
-    m_draw_commands.emplace_back(std::move(cmd));
+    pushDrawCommand(std::move(cmd));
 }
 
 void Renderer::Clear() {
@@ -227,44 +301,94 @@ void Renderer::Clear() {
                                     m_clear_color.g, m_clear_color.b,
                                     m_clear_color.a));
     SDL_CALL(SDL_RenderClear(m_renderer));
+    m_stats = {};
 }
 
 void Renderer::ApplyDrawcall() {
     PROFILE_SECTION();
 
-    sortDrawCommands();
-    applyDrawCommands();
-
-    m_draw_commands.clear();
-    m_y_sorting_range.clear();
     m_is_y_sorting_range_close = true;
+    TL_RETURN_IF_TRUE(m_recording_pass->m_commands.empty());
+
+    if (m_capture) {
+        m_capture->RecordPass(*m_recording_pass);
+    }
+
+    m_recording_pass->Sort();
+    m_submitted_passes.push_back(std::move(m_recording_pass));
+
+    if (m_free_passes.empty()) {
+        m_recording_pass = std::make_unique<DrawPass>();
+    } else {
+        m_recording_pass = std::move(m_free_passes.back());
+        m_free_passes.pop_back();
+    }
+}
+
+void Renderer::Execute() {
+    PROFILE_SECTION();
+
+    for (auto& pass : m_submitted_passes) {
+        ExecutePass(*pass);
+        pass->Clear();
+        m_free_passes.push_back(std::move(pass));
+    }
+    m_submitted_passes.clear();
+
+    // commands recorded after last `ApplyDrawcall` may still refer them
+    if (m_recording_pass->m_commands.empty()) {
+        m_texture_destroy_queue->Flush();
+    }
 }
 
 void Renderer::Present() {
     PROFILE_SECTION();
 
+    Execute();
     SDL_CALL(SDL_RenderPresent(m_renderer));
+
+    if (m_capture && m_capture->EndFrame()) {
+        m_capture.reset();
+    }
+}
+
+void Renderer::StartCapture(const Path& filename, uint32_t frame_count) {
+    Vec2UI size;
+    if (m_window) {
+        size = m_window->GetWindowSize();
+    }
+    m_capture =
+        std::make_unique<RenderCaptureWriter>(filename, frame_count, size);
+}
+
+const RenderStats& Renderer::GetStats() const {
+    return m_stats;
 }
 
 SDL_Renderer* Renderer::GetRenderer() const {
     return m_renderer;
 }
 
+std::weak_ptr<TextureDestroyQueue> Renderer::GetTextureDestroyQueue() const {
+    return m_texture_destroy_queue;
+}
+
 void Renderer::BeginYSorting() {
     TL_RETURN_IF_FALSE(m_is_y_sorting_range_close);
 
     m_is_y_sorting_range_close = false;
-    m_y_sorting_range.emplace_back(
-        std::make_pair<size_t, size_t>(m_draw_commands.size(), 0));
+    m_recording_pass->m_y_sorting_range.emplace_back(
+        m_recording_pass->m_commands.size(), 0);
 }
 
 void Renderer::EndYSorting() {
-    TL_RETURN_IF_TRUE(m_y_sorting_range.empty());
+    auto& ranges = m_recording_pass->m_y_sorting_range;
+    TL_RETURN_IF_TRUE(ranges.empty());
 
     m_is_y_sorting_range_close = true;
 
-    auto& range = m_y_sorting_range.back();
-    range.second = m_draw_commands.size();
+    auto& range = ranges.back();
+    range.second = m_recording_pass->m_commands.size();
 }
 
 bool Renderer::IsRecordingYSorting() const {
@@ -300,31 +424,45 @@ void Renderer::resizeTexture(const Vec2UI& new_size) {
 }
 
 struct ApplyDrawCmdVisitor {
-    ApplyDrawCmdVisitor(SDL_Renderer* renderer, const Vec2UI window_size)
-        : m_renderer{renderer}, m_window_rect{Vec2::ZERO, Vec2{window_size}} {}
+    ApplyDrawCmdVisitor(SDL_Renderer* renderer, const Vec2UI window_size,
+                        const std::vector<SDL_FPoint>& points,
+                        RenderStats& stats)
+        : m_renderer{renderer},
+          m_window_rect{Vec2::ZERO, Vec2{window_size}},
+          m_points{points},
+          m_stats{stats} {}
 
     void ChangeColor(const Color& color) { m_color = color; }
 
     void operator()(const DrawLineCommand& cmd) {
         setRenderColor(m_color);
+        m_stats.m_draw_call_count++;
         SDL_CALL(SDL_RenderLine(m_renderer, cmd.m_p1.x, cmd.m_p1.y, cmd.m_p2.x,
                                 cmd.m_p2.y));
     }
 
+    void operator()(const DrawLineStripCommand& cmd) {
+        TL_RETURN_IF_FALSE(isVisible(cmd.m_bounds));
+
+        setRenderColor(m_color);
+        m_stats.m_draw_call_count++;
+        SDL_CALL(SDL_RenderLines(m_renderer, m_points.data() + cmd.m_first,
+                                 cmd.m_count));
+    }
+
     void operator()(const DrawRectCommand& cmd) {
-        TL_RETURN_IF_FALSE(IsRectsIntersect(m_window_rect, cmd.m_rect));
+        TL_RETURN_IF_FALSE(isVisible(cmd.m_rect));
 
         setRenderColor(m_color);
         Vec2 tl = cmd.m_rect.m_center - cmd.m_rect.m_half_size;
         SDL_FRect rect{tl.x, tl.y, cmd.m_rect.m_half_size.w * 2.0f,
                        cmd.m_rect.m_half_size.h * 2.0f};
-
+        m_stats.m_draw_call_count++;
         SDL_CALL(SDL_RenderRect(m_renderer, &rect));
     }
 
     void operator()(const DrawImageCommand& cmd) {
-        TL_RETURN_IF_FALSE(IsRectsIntersect(
-            m_window_rect,
+        TL_RETURN_IF_FALSE(isVisible(
             GetDrawImageAABB(cmd.m_dst, cmd.m_rotation, cmd.m_rot_center)));
 
         SDL_FRect src_rect, dst_rect;
@@ -341,11 +479,12 @@ struct ApplyDrawCmdVisitor {
 
         SDL_FPoint rot_center{cmd.m_rot_center.x, cmd.m_rot_center.y};
 
-        SDL_SetTextureColorModFloat(cmd.m_image->GetTexture(), m_color.r,
+        SDL_SetTextureColorModFloat(cmd.m_texture, m_color.r,
                                     m_color.g, m_color.b);
-        SDL_SetTextureAlphaModFloat(cmd.m_image->GetTexture(), m_color.a);
+        SDL_SetTextureAlphaModFloat(cmd.m_texture, m_color.a);
+        m_stats.m_draw_call_count++;
         SDL_CALL(SDL_RenderTextureRotated(
-            m_renderer, cmd.m_image->GetTexture(), &src_rect, &dst_rect,
+            m_renderer, cmd.m_texture, &src_rect, &dst_rect,
             cmd.m_rotation.Value(), &rot_center,
             static_cast<SDL_FlipMode>(cmd.m_flip.Value())));
     }
@@ -365,7 +504,7 @@ struct ApplyDrawCmdVisitor {
             {(min_x + max_x) * 0.5f, (min_y + max_y) * 0.5f},
             {(max_x - min_x) * 0.5f, (max_y - min_y) * 0.5f}
         };
-        TL_RETURN_IF_FALSE(IsRectsIntersect(m_window_rect, aabb));
+        TL_RETURN_IF_FALSE(isVisible(aabb));
 
         SDL_FRect rect = {std::roundf(cmd.m_src.m_topleft.x),
                           std::roundf(cmd.m_src.m_topleft.y),
@@ -374,25 +513,27 @@ struct ApplyDrawCmdVisitor {
         SDL_FPoint sdl_tl{std::roundf(cmd.m_origin.x), std::roundf(cmd.m_origin.y)},
             sdl_tr{std::roundf(cmd.m_right.x), std::roundf(cmd.m_right.y)},
             sdl_bl{std::roundf(cmd.m_down.x), std::roundf(cmd.m_down.y)};
-        SDL_SetTextureColorModFloat(cmd.m_image->GetTexture(), m_color.r,
+        SDL_SetTextureColorModFloat(cmd.m_texture, m_color.r,
                                     m_color.g, m_color.b);
-        SDL_SetTextureAlphaModFloat(cmd.m_image->GetTexture(), m_color.a);
-        SDL_CALL(SDL_RenderTextureAffine(m_renderer, cmd.m_image->GetTexture(),
+        SDL_SetTextureAlphaModFloat(cmd.m_texture, m_color.a);
+        m_stats.m_draw_call_count++;
+        SDL_CALL(SDL_RenderTextureAffine(m_renderer, cmd.m_texture,
                                          &rect, &sdl_tl, &sdl_tr, &sdl_bl));
     }
 
     void operator()(const FillRectCommand& cmd) {
-        TL_RETURN_IF_FALSE(IsRectsIntersect(m_window_rect, cmd.m_rect));
+        TL_RETURN_IF_FALSE(isVisible(cmd.m_rect));
 
         setRenderColor(m_color);
         Vec2 tl = cmd.m_rect.m_center - cmd.m_rect.m_half_size;
         SDL_FRect rect{tl.x, tl.y, cmd.m_rect.m_half_size.w * 2.0f,
                        cmd.m_rect.m_half_size.h * 2.0f};
+        m_stats.m_draw_call_count++;
         SDL_CALL(SDL_RenderFillRect(m_renderer, &rect));
     }
 
     void operator()(const DrawImage9GridCommand& cmd) {
-        TL_RETURN_IF_FALSE(IsRectsIntersect(m_window_rect, cmd.m_dst));
+        TL_RETURN_IF_FALSE(isVisible(cmd.m_dst));
 
         SDL_FRect final_rect;
 
@@ -407,6 +548,11 @@ struct ApplyDrawCmdVisitor {
         float scaled_top = cmd.m_grid.m_top * cmd.border_scale;
         float scaled_bottom = cmd.m_grid.m_bottom * cmd.border_scale;
 
+        SDL_SetTextureColorModFloat(cmd.m_texture, m_color.r,
+                                    m_color.g, m_color.b);
+        SDL_SetTextureAlphaModFloat(cmd.m_texture, m_color.a);
+        m_stats.m_draw_call_count += 9;
+
         // top left corner
         {
             SDL_FRect src_rect;
@@ -420,7 +566,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = top_left.y;
             dst_rect.w = scaled_left;
             dst_rect.h = scaled_top;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -438,7 +584,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = top_left.y;
             dst_rect.w = final_rect.w - scaled_left - scaled_right;
             dst_rect.h = scaled_top;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -456,7 +602,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = top_left.y;
             dst_rect.w = scaled_right;
             dst_rect.h = scaled_top;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -474,7 +620,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = final_rect.y + scaled_top;
             dst_rect.w = scaled_left;
             dst_rect.h = final_rect.h - scaled_top - scaled_bottom;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -493,7 +639,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = final_rect.y + scaled_top;
             dst_rect.w = final_rect.w - scaled_left - scaled_bottom;
             dst_rect.h = final_rect.h - scaled_top - scaled_bottom;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -512,7 +658,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = final_rect.y + scaled_top;
             dst_rect.w = scaled_right;
             dst_rect.h = final_rect.h - scaled_top - scaled_bottom;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -530,7 +676,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = final_rect.y + final_rect.h - scaled_bottom;
             dst_rect.w = scaled_left;
             dst_rect.h = scaled_bottom;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -549,7 +695,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = final_rect.y + final_rect.h - scaled_bottom;
             dst_rect.w = final_rect.w - scaled_left - scaled_right;
             dst_rect.h = scaled_bottom;
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
 
@@ -568,10 +714,7 @@ struct ApplyDrawCmdVisitor {
             dst_rect.y = final_rect.y + final_rect.h - scaled_bottom;
             dst_rect.w = scaled_right;
             dst_rect.h = scaled_bottom;
-            SDL_SetTextureColorModFloat(cmd.m_image->GetTexture(), m_color.r,
-                                        m_color.g, m_color.b);
-            SDL_SetTextureAlphaModFloat(cmd.m_image->GetTexture(), m_color.a);
-            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_image->GetTexture(),
+            SDL_CALL(SDL_RenderTexture(m_renderer, cmd.m_texture,
                                        &src_rect, &dst_rect));
         }
     }
@@ -580,6 +723,16 @@ private:
     SDL_Renderer* m_renderer;
     Rect m_window_rect;
     Color m_color;
+    const std::vector<SDL_FPoint>& m_points;
+    RenderStats& m_stats;
+
+    bool isVisible(const Rect& rect) {
+        if (IsRectsIntersect(m_window_rect, rect)) {
+            return true;
+        }
+        m_stats.m_culled_count++;
+        return false;
+    }
 
     Rect GetDrawImageAABB(const Rect& rect, Degrees rotation,
                           const Vec2& pivot) const {
@@ -624,33 +777,95 @@ private:
     }
 };
 
-void Renderer::applyDrawCommands() {
+void Renderer::ExecutePass(const DrawPass& pass) {
     PROFILE_SECTION();
 
-    auto window_size = CLIENT_CONTEXT.m_window->GetWindowSize();
+    Vec2UI window_size;
+    if (m_window) {
+        window_size = m_window->GetWindowSize();
+    } else {
+        int w = 0, h = 0;
+        SDL_GetCurrentRenderOutputSize(m_renderer, &w, &h);
+        window_size = Vec2UI(w, h);
+    }
+
+    m_stats.m_command_count += pass.m_sorted_indices.size();
 
-    ApplyDrawCmdVisitor visitor{m_renderer, window_size};
-    for (auto& cmd : m_draw_commands) {
+    ApplyDrawCmdVisitor visitor{m_renderer, window_size, pass.m_points,
+                                m_stats};
+    for (uint32_t index : pass.m_sorted_indices) {
+        auto& cmd = pass.m_commands[index];
         visitor.ChangeColor(cmd.m_color);
         std::visit(visitor, cmd.m_cmd);
     }
 }
 
-void Renderer::sortDrawCommands() {
+void Renderer::pushDrawCommand(DrawCommand&& cmd) {
+    m_recording_pass->Push(std::move(cmd));
+}
+
+void Renderer::pushLineStrip(uint32_t first, const Color& color,
+                             double z_order, float y_sorting) {
+    auto& points = m_recording_pass->m_points;
+
+    Vec2 min{points[first].x, points[first].y}, max = min;
+    for (size_t i = first + 1; i < points.size(); i++) {
+        min.x = std::min(min.x, points[i].x);
+        min.y = std::min(min.y, points[i].y);
+        max.x = std::max(max.x, points[i].x);
+        max.y = std::max(max.y, points[i].y);
+    }
+
+    DrawLineStripCommand cmd_strip;
+    cmd_strip.m_first = first;
+    cmd_strip.m_count = points.size() - first;
+    cmd_strip.m_bounds = Rect{(min + max) * 0.5, (max - min) * 0.5};
+
+    DrawCommand cmd;
+    cmd.m_color = color;
+    cmd.m_z_order = z_order;
+    cmd.m_y_sorting = y_sorting;
+    cmd.m_cmd = cmd_strip;
+
+    pushDrawCommand(std::move(cmd));
+}
+
+void DrawPass::Push(DrawCommand&& cmd) {
+    // sequence is in low bits, so commands with same z order keep submit order
+    uint64_t key = static_cast<uint64_t>(FloatToSortableKey(cmd.m_z_order))
+                   << 32;
+    key |= static_cast<uint32_t>(m_commands.size());
+    m_sort_keys.push_back(key);
+    m_commands.emplace_back(std::move(cmd));
+}
+
+void DrawPass::Sort() {
     PROFILE_SECTION();
 
+    // sort commands in y-sorting range by y, then reorder their sequence
     for (auto& range : m_y_sorting_range) {
         TL_CONTINUE_IF_FALSE(range.first < range.second);
 
-        auto it = m_draw_commands.begin();
-        std::sort(it + range.first, it + range.second,
-                  [](const DrawCommand& lhs, const DrawCommand& rhs) {
-                      return lhs.m_y_sorting < rhs.m_y_sorting;
-                  });
+        m_y_sorting_keys.clear();
+        for (size_t i = range.first; i < range.second; i++) {
+            m_y_sorting_keys.push_back(
+                FloatToSortableKey(m_commands[i].m_y_sorting));
+        }
+        RadixSortIndices(m_y_sorting_keys, m_sorted_indices, m_sort_buffer);
+
+        for (size_t rank = 0; rank < m_sorted_indices.size(); rank++) {
+            uint64_t& key = m_sort_keys[range.first + m_sorted_indices[rank]];
+            key = (key & 0xFFFFFFFF00000000ull) | (range.first + rank);
+        }
     }
 
-    std::stable_sort(m_draw_commands.begin(), m_draw_commands.end(),
-                     [](const DrawCommand& lhs, const DrawCommand& rhs) {
-                         return lhs.m_z_order < rhs.m_z_order;
-                     });
+    RadixSortIndices(m_sort_keys, m_sorted_indices, m_sort_buffer);
+}
+
+void DrawPass::Clear() {
+    m_commands.clear();
+    m_y_sorting_range.clear();
+    m_points.clear();
+    m_sort_keys.clear();
+    m_sorted_indices.clear();
 }
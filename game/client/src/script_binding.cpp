@@ -304,7 +304,7 @@ static void bindUI(lua_State* L) {
                 .addFunction("MoveCursorEnd", &UITextInput::MoveCursorEnd)
                 .addFunction("DeleteBeforeCursor", &UITextInput::DeleteBeforeCursor)
                 .addFunction("DeleteAfterCursor", &UITextInput::DeleteAfterCursor)
-                .addFunction("GetTextImageSize", &UITextInput::GetTextImageSize)
+                .addFunction("GetTextImageSize", &UITextInput::GetTextSize)
                 .addFunction("GetCursorX", &UITextInput::GetCursorX)
                 .addFunction("RefreshText", &UITextInput::RefreshText)
             .endClass()
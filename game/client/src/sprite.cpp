@@ -5,6 +5,7 @@
 #include "common/sdl_call.hpp"
 #include "common/transform.hpp"
 
+#include <algorithm>
 #include <array>
 
 #include "common/profile.hpp"
@@ -20,40 +21,83 @@ void SpriteManager::SubmitDrawCommand(Entity entity) {
     const Transform* transform = transform_manager->Get(entity);
     TL_RETURN_IF_FALSE(transform);
 
-    auto src_region = sprite->m_region;
+    RenderProxy& proxy = m_proxies[entity];
+    if (isProxyOutdated(proxy, *sprite, *transform)) {
+        updateProxy(proxy, *sprite, *transform);
+    }
+
+    TL_RETURN_IF_FALSE(IsRectsIntersect(
+        proxy.m_bounds, CLIENT_CONTEXT.m_camera.GetVisibleRect()));
+
+    auto draw_order = CLIENT_CONTEXT.m_draw_order_manager->Get(entity);
+    float z_order = draw_order ? draw_order->GetGlobalOrder() : 0;
+
+    renderer->DrawImageEx(*sprite->m_image, proxy.m_src, proxy.m_pts[0],
+                          proxy.m_pts[1], proxy.m_pts[2], sprite->m_color,
+                          z_order, true, transform->m_position.y);
+}
+
+void SpriteManager::RemoveEntity(Entity entity) {
+    ComponentManager::RemoveEntity(entity);
+    m_proxies.erase(entity);
+}
+
+bool SpriteManager::isProxyOutdated(const RenderProxy& proxy,
+                                    const Sprite& sprite,
+                                    const Transform& transform) {
+    return proxy.m_transform_version != transform.GetVersion() ||
+           proxy.m_image != sprite.m_image.Get() ||
+           proxy.m_image_size != sprite.m_image->GetSize() ||
+           proxy.m_region.m_topleft != sprite.m_region.m_topleft ||
+           proxy.m_region.m_size != sprite.m_region.m_size ||
+           proxy.m_anchor != sprite.m_anchor ||
+           proxy.m_flip.Value() != sprite.m_flip.Value();
+}
+
+void SpriteManager::updateProxy(RenderProxy& proxy, const Sprite& sprite,
+                                const Transform& transform) {
+    proxy.m_transform_version = transform.GetVersion();
+    proxy.m_image = sprite.m_image.Get();
+    proxy.m_image_size = sprite.m_image->GetSize();
+    proxy.m_region = sprite.m_region;
+    proxy.m_anchor = sprite.m_anchor;
+    proxy.m_flip = sprite.m_flip;
+
+    auto src_region = sprite.m_region;
     if (src_region.m_size.w == 0 || src_region.m_size.h == 0) {
-        src_region.m_size = sprite->m_image->GetSize();
+        src_region.m_size = sprite.m_image->GetSize();
     }
+    proxy.m_src = src_region;
 
-    Vec2 half_size = sprite->m_region.m_size * 0.5f;
+    Vec2 half_size = sprite.m_region.m_size * 0.5f;
 
     if (half_size.x == 0 || half_size.y == 0) {
-        half_size = sprite->m_image->GetSize() * 0.5;
+        half_size = sprite.m_image->GetSize() * 0.5;
     }
 
-    std::array<Vec2, 3> pts;
+    auto& pts = proxy.m_pts;
     pts[0] = -half_size;                   // top left
     pts[1] = {half_size.x, -half_size.y};  // top right
     pts[2] = {-half_size.x, half_size.y};  // bottom left
 
-    if (sprite->m_flip & Flip::Horizontal && sprite->m_flip & Flip::Vertical) {
+    if (sprite.m_flip & Flip::Horizontal && sprite.m_flip & Flip::Vertical) {
         pts[0] = half_size;
         pts[1] = {-half_size.x, half_size.y};
         pts[2] = {half_size.x, -half_size.y};
-    } else if (sprite->m_flip & Flip::Horizontal) {
+    } else if (sprite.m_flip & Flip::Horizontal) {
         pts[0] = {half_size.x, -half_size.y};
         pts[1] = {-half_size.x, -half_size.y};
         pts[2] = {half_size.x, half_size.y};
-    } else if (sprite->m_flip & Flip::Vertical) {
+    } else if (sprite.m_flip & Flip::Vertical) {
         pts[0] = {-half_size.x, half_size.y};
         pts[1] = {half_size.x, half_size.y};
         pts[2] = -half_size;
     }
 
-    auto& m = transform->GetGlobalMat();
+    auto& m = transform.GetGlobalMat();
     for (auto& pt : pts) {
         Vec2 pt_with_anchor = pt;
-        pt_with_anchor -= sprite->m_anchor;
+        pt_with_anchor -= sprite.m_anchor;
         Vec2 new_pt;
         new_pt.x = pt_with_anchor.x * m.Get(0, 0) +
                    pt_with_anchor.y * m.Get(1, 0) + m.Get(2, 0);
@@ -62,9 +106,10 @@ void SpriteManager::SubmitDrawCommand(Entity entity) {
         pt = new_pt;
     }
 
-    auto draw_order = CLIENT_CONTEXT.m_draw_order_manager->Get(entity);
-    float z_order = draw_order ? draw_order->GetGlobalOrder() : 0;
-
-    renderer->DrawImageEx(*sprite->m_image, src_region, pts[0], pts[1], pts[2],
-                          sprite->m_color, z_order, true, transform->m_position.y);
+    Vec2 bottom_right = pts[1] + pts[2] - pts[0];
+    Vec2 min{std::min({pts[0].x, pts[1].x, pts[2].x, bottom_right.x}),
+             std::min({pts[0].y, pts[1].y, pts[2].y, bottom_right.y})};
+    Vec2 max{std::max({pts[0].x, pts[1].x, pts[2].x, bottom_right.x}),
+             std::max({pts[0].y, pts[1].y, pts[2].y, bottom_right.y})};
+    proxy.m_bounds = Rect{(min + max) * 0.5, (max - min) * 0.5};
 }
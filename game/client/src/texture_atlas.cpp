@@ -0,0 +1,250 @@
+#include "client/texture_atlas.hpp"
+#include "client/image.hpp"
+#include "client/renderer.hpp"
+#include "common/log.hpp"
+#include "common/macros.hpp"
+#include "common/sdl_call.hpp"
+
+#include <algorithm>
+
+AtlasImage::AtlasImage(SDL_Texture* page, const Region& region,
+                       const SDL_Rect& slot)
+    : m_page{page}, m_region{region}, m_slot{slot} {}
+
+Vec2 AtlasImage::GetSize() const {
+    return m_region.m_size;
+}
+
+SDL_Texture* AtlasImage::GetTexture() const {
+    return m_page;
+}
+
+Region AtlasImage::GetTextureRegion() const {
+    return m_region;
+}
+
+void AtlasImage::ChangeColorMask(const Color&) {
+    LOGE("can't change color mask of atlas image, draw it with color instead");
+}
+
+TextureAtlas::TextureAtlas(Renderer& renderer, int page_size)
+    : m_renderer{renderer},
+      m_destroy_queue{renderer.GetTextureDestroyQueue()},
+      m_page_size{page_size} {}
+
+TextureAtlas::~TextureAtlas() {
+    for (auto& page : m_pages) {
+        TextureDestroyQueue::Destroy(m_destroy_queue, page.m_texture);
+    }
+}
+
+std::unique_ptr<AtlasImage> TextureAtlas::Pack(const ImagePixels& pixels,
+                                               const Path& filename) {
+    return Pack(pixels.GetData(), pixels.GetWidth(), pixels.GetHeight(),
+                pixels.GetWidth() * 4, filename);
+}
+
+std::unique_ptr<AtlasImage> TextureAtlas::Pack(const void* pixels, int w,
+                                               int h, int pitch,
+                                               const Path& name) {
+    int extruded_w = w + Extrude * 2, extruded_h = h + Extrude * 2;
+    int slot_w = extruded_w + Padding, slot_h = extruded_h + Padding;
+    if (w <= 0 || h <= 0 || w > MaxImageSize || h > MaxImageSize ||
+        slot_w > m_page_size || slot_h > m_page_size) {
+        return nullptr;
+    }
+
+    Page* page = nullptr;
+    std::optional<SDL_Rect> free_slot;
+    std::optional<Placement> placement;
+    for (auto& p : m_pages) {
+        if ((free_slot = takeFreeSlot(p, slot_w, slot_h))) {
+            page = &p;
+            break;
+        }
+    }
+    if (!page) {
+        for (auto& p : m_pages) {
+            if ((placement = findPosition(p, slot_w, slot_h))) {
+                page = &p;
+                break;
+            }
+        }
+    }
+    if (!page) {
+        TL_RETURN_VALUE_IF_FALSE(createPage(), nullptr);
+        page = &m_pages.back();
+        placement = findPosition(*page, slot_w, slot_h);
+        TL_RETURN_VALUE_IF_FALSE(placement, nullptr);
+    }
+
+    SDL_Rect slot = free_slot ? *free_slot
+                              : SDL_Rect{placement->m_x, placement->m_y,
+                                         slot_w, slot_h};
+
+    // copy pixels with border pixels repeated `Extrude` times
+    std::vector<uint32_t> extruded(extruded_w * extruded_h);
+    for (int y = 0; y < extruded_h; y++) {
+        int src_y = std::clamp(y - Extrude, 0, h - 1);
+        auto src_row = reinterpret_cast<const uint32_t*>(
+            static_cast<const char*>(pixels) + src_y * pitch);
+        for (int x = 0; x < extruded_w; x++) {
+            int src_x = std::clamp(x - Extrude, 0, w - 1);
+            extruded[y * extruded_w + x] = src_row[src_x];
+        }
+    }
+
+    SDL_Rect rect{slot.x, slot.y, extruded_w, extruded_h};
+    if (!SDL_UpdateTexture(page->m_texture, &rect, extruded.data(),
+                           extruded_w * 4)) {
+        LOGE("upload {} to texture atlas failed: {}", name, SDL_GetError());
+        if (free_slot) {
+            page->m_free_slots.push_back(*free_slot);
+        }
+        return nullptr;
+    }
+    if (!free_slot) {
+        addSkylineLevel(*page, *placement, slot_w, slot_h);
+    }
+
+    Region region;
+    region.m_topleft = Vec2{static_cast<float>(slot.x + Extrude),
+                            static_cast<float>(slot.y + Extrude)};
+    region.m_size = Vec2{static_cast<float>(w), static_cast<float>(h)};
+    return std::make_unique<AtlasImage>(page->m_texture, region, slot);
+}
+
+void TextureAtlas::Release(AtlasImage& image) {
+    TL_RETURN_IF_NULL(image.m_page);
+
+    auto it = std::find_if(m_pages.begin(), m_pages.end(), [&](const Page& p) {
+        return p.m_texture == image.m_page;
+    });
+    TL_RETURN_IF_TRUE_WITH_LOG(it == m_pages.end(), LOGE,
+                               "release image not in this atlas");
+
+    // clear old pixels, sampling neighbors mustn't see them
+    std::vector<uint32_t> empty(image.m_slot.w * image.m_slot.h, 0);
+    SDL_CALL(SDL_UpdateTexture(it->m_texture, &image.m_slot, empty.data(),
+                               image.m_slot.w * 4));
+    it->m_free_slots.push_back(image.m_slot);
+
+    image.m_page = nullptr;
+    image.m_region = {};
+    image.m_slot = {};
+}
+
+std::optional<SDL_Rect> TextureAtlas::takeFreeSlot(Page& page, int w, int h) {
+    auto& slots = page.m_free_slots;
+    auto best = slots.end();
+    for (auto it = slots.begin(); it != slots.end(); ++it) {
+        TL_CONTINUE_IF_FALSE(it->w >= w && it->h >= h);
+        if (best == slots.end() || it->w * it->h < best->w * best->h) {
+            best = it;
+        }
+    }
+    TL_RETURN_VALUE_IF_TRUE(best == slots.end(), std::nullopt);
+
+    SDL_Rect slot = *best;
+    slots.erase(best);
+    return slot;
+}
+
+size_t TextureAtlas::GetPageCount() const {
+    return m_pages.size();
+}
+
+bool TextureAtlas::createPage() {
+    SDL_Texture* texture =
+        SDL_CreateTexture(m_renderer.GetRenderer(), SDL_PIXELFORMAT_RGBA32,
+                          SDL_TEXTUREACCESS_STATIC, m_page_size, m_page_size);
+    if (!texture) {
+        LOGE("create texture atlas page failed: {}", SDL_GetError());
+        return false;
+    }
+
+    // padding between images must be transparent
+    std::vector<uint32_t> empty(m_page_size * m_page_size, 0);
+    SDL_CALL(
+        SDL_UpdateTexture(texture, nullptr, empty.data(), m_page_size * 4));
+    SDL_CALL(SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND));
+    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+
+    Page page;
+    page.m_texture = texture;
+    page.m_skyline.push_back(SkylineNode{0, 0, m_page_size});
+    m_pages.push_back(std::move(page));
+    LOGI("texture atlas page {} created", m_pages.size());
+    return true;
+}
+
+std::optional<TextureAtlas::Placement> TextureAtlas::findPosition(
+    const Page& page, int w, int h) const {
+    auto& skyline = page.m_skyline;
+
+    std::optional<Placement> best;
+    int best_bottom = m_page_size + 1, best_width = m_page_size + 1;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        int x = skyline[i].m_x;
+        if (x + w > m_page_size) {
+            break;
+        }
+
+        // rect lays on the highest node it spans
+        int y = 0, width_left = w;
+        size_t j = i;
+        while (width_left > 0 && j < skyline.size()) {
+            y = std::max(y, skyline[j].m_y);
+            width_left -= skyline[j].m_w;
+            j++;
+        }
+        if (width_left > 0 || y + h > m_page_size) {
+            continue;
+        }
+
+        int bottom = y + h;
+        if (bottom < best_bottom ||
+            (bottom == best_bottom && skyline[i].m_w < best_width)) {
+            best_bottom = bottom;
+            best_width = skyline[i].m_w;
+            best = Placement{i, x, y};
+        }
+    }
+    return best;
+}
+
+void TextureAtlas::addSkylineLevel(Page& page, const Placement& placement,
+                                   int w, int h) {
+    auto& skyline = page.m_skyline;
+    skyline.insert(skyline.begin() + placement.m_node,
+                   SkylineNode{placement.m_x, placement.m_y + h, w});
+
+    // shrink or remove nodes covered by the new one
+    for (size_t i = placement.m_node + 1; i < skyline.size();) {
+        auto& prev = skyline[i - 1];
+        auto& node = skyline[i];
+        int prev_right = prev.m_x + prev.m_w;
+        if (node.m_x >= prev_right) {
+            break;
+        }
+
+        int shrink = prev_right - node.m_x;
+        if (node.m_w <= shrink) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        node.m_x += shrink;
+        node.m_w -= shrink;
+        break;
+    }
+
+    // merge neighbors at same level
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].m_y == skyline[i + 1].m_y) {
+            skyline[i].m_w += skyline[i + 1].m_w;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+}
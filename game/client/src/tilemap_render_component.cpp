@@ -3,38 +3,26 @@
 #include "client/draw_order.hpp"
 #include "client/image.hpp"
 #include "client/renderer.hpp"
+#include "common/asset_manager.hpp"
 #include "common/profile.hpp"
 
+#include <cfloat>
+
 TilemapLayerRenderComponent::TilemapLayerRenderComponent(
     Entity entity, const TilemapLayerDefinition& create_info) {
     TL_RETURN_IF_FALSE(create_info.m_tilemap);
 
     m_tilemap_handle = create_info.m_tilemap;
-
-    for (auto& layer : create_info.m_tilemap->GetLayers()) {
-        if (layer->GetName() == create_info.m_layer_name) {
-            switch (layer->GetType()) {
-                case TilemapLayer::Type::Tiled:
-                    m_tilemap_layer = std::make_unique<TilemapTileLayer>(
-                        *layer->AsTiledLayer());
-                    break;
-                case TilemapLayer::Type::Object:
-                    m_tilemap_layer = std::make_unique<TilemapObjectLayer>(
-                        *layer->AsObjectLayer());
-                    break;
-                case TilemapLayer::Type::Image:
-                    m_tilemap_layer = std::make_unique<TilemapImageLayer>(
-                        *layer->AsImageLayer());
-                    break;
-            }
-        }
-    }
+    m_name = create_info.m_layer_name;
+    m_built_tilemap = m_tilemap_handle.Get();
 
     TL_RETURN_IF_FALSE_WITH_LOG(
-        m_tilemap_layer, LOGE,
+        findLayer(*m_built_tilemap), LOGE,
         "[Tilemap]: create tilemap layer {} from tilemap {} failed",
         create_info.m_layer_name,
         create_info.m_tilemap.GetFilename()->string());
+
+    buildTileProxies(*m_built_tilemap);
 }
 
 const TilemapLayer* TilemapLayerRenderComponent::GetLayer() const {
@@ -42,57 +30,144 @@ const TilemapLayer* TilemapLayerRenderComponent::GetLayer() const {
 }
 
 const Tilemap* TilemapLayerRenderComponent::GetTilemap() const {
-    return m_tilemap_handle.Get();
+    TL_RETURN_VALUE_IF_FALSE(m_tilemap_handle, nullptr);
+
+    auto& manager = CLIENT_CONTEXT.m_assets_manager->GetManager<Tilemap>();
+    return manager.Find(m_tilemap_handle.GetUUID()).Get();
+}
+
+const Tilemap* TilemapLayerRenderComponent::refreshTilemap() {
+    const Tilemap* tilemap = GetTilemap();
+    TL_RETURN_VALUE_IF_NULL(tilemap, nullptr);
+
+    if (tilemap != m_built_tilemap) {
+        m_built_tilemap = tilemap;
+        m_tile_proxies.clear();
+        m_tile_chunks.clear();
+        if (findLayer(*m_built_tilemap)) {
+            buildTileProxies(*m_built_tilemap);
+        }
+    }
+    return m_built_tilemap;
+}
+
+const std::vector<TilemapLayerRenderComponent::TileProxy>&
+TilemapLayerRenderComponent::GetTileProxies() const {
+    return m_tile_proxies;
+}
+
+const std::vector<TilemapLayerRenderComponent::TileChunk>&
+TilemapLayerRenderComponent::GetTileChunks() const {
+    return m_tile_chunks;
+}
+
+bool TilemapLayerRenderComponent::findLayer(const Tilemap& tilemap) {
+    m_tilemap_layer.reset();
+    for (auto& layer : tilemap.GetLayers()) {
+        if (layer->GetName() == m_name) {
+            m_tilemap_layer = layer;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TilemapLayerRenderComponent::buildTileProxies(const Tilemap& tilemap) {
+    TL_RETURN_IF_FALSE(m_tilemap_layer->GetType() == TilemapLayer::Type::Tiled);
+
+    auto tiled_layer = m_tilemap_layer->AsTiledLayer();
+    auto& size = tiled_layer->GetSize();
+    size_t width = static_cast<size_t>(size.x);
+    size_t height = static_cast<size_t>(size.y);
+
+    // proxies of one chunk are stored together, row by row inside chunk
+    for (size_t chunk_y = 0; chunk_y < height; chunk_y += ChunkSize) {
+        for (size_t chunk_x = 0; chunk_x < width; chunk_x += ChunkSize) {
+            TileChunk chunk;
+            chunk.m_begin = static_cast<uint32_t>(m_tile_proxies.size());
+            Vec2 min{FLT_MAX, FLT_MAX}, max{-FLT_MAX, -FLT_MAX};
+
+            size_t end_y = std::min(chunk_y + ChunkSize, height);
+            size_t end_x = std::min(chunk_x + ChunkSize, width);
+            for (size_t y = chunk_y; y < end_y; y++) {
+                for (size_t x = chunk_x; x < end_x; x++) {
+                    auto& layer_tile = tiled_layer->GetTile(x, y);
+                    auto tile = tilemap.GetTile(layer_tile.GetGID());
+                    if (!tile) {
+                        continue;
+                    }
+                    Rect dst_rect;
+                    dst_rect.m_half_size = tile->m_region.m_size * 0.5;
+
+                    float scale = 1.0;
+                    Vec2 scaled_tile_size = tilemap.GetTileSize() * scale;
+
+                    dst_rect.m_center =
+                        Vec2(x, y + 1) * scaled_tile_size +
+                        Vec2(tile->m_tile_size.w, -tile->m_tile_size.h) * 0.5;
+
+                    constexpr float scale_expand = 0.01;
+                    scale += scale_expand;
+                    dst_rect.m_half_size *= scale;
+
+                    TileProxy proxy;
+                    proxy.m_gid = layer_tile.GetGID();
+                    proxy.m_dst.m_topleft =
+                        dst_rect.m_center - dst_rect.m_half_size;
+                    proxy.m_dst.m_size = dst_rect.m_half_size * 2.0;
+                    proxy.m_flip = layer_tile.GetFlip();
+                    proxy.m_y_sorting =
+                        dst_rect.m_center.y + dst_rect.m_half_size.y;
+                    m_tile_proxies.push_back(proxy);
+
+                    Vec2 bottom_right =
+                        proxy.m_dst.m_topleft + proxy.m_dst.m_size;
+                    min.x = std::min(min.x, proxy.m_dst.m_topleft.x);
+                    min.y = std::min(min.y, proxy.m_dst.m_topleft.y);
+                    max.x = std::max(max.x, bottom_right.x);
+                    max.y = std::max(max.y, bottom_right.y);
+                }
+            }
+
+            chunk.m_end = static_cast<uint32_t>(m_tile_proxies.size());
+            TL_CONTINUE_IF_TRUE(chunk.m_begin == chunk.m_end);
+            chunk.m_bounds = Rect{(min + max) * 0.5, (max - min) * 0.5};
+            m_tile_chunks.push_back(chunk);
+        }
+    }
 }
 
 void TilemapLayerRenderComponentManager::SubmitDrawCommand(Entity entity) {
     PROFILE_SECTION();
 
     auto tilemap_layer = Get(entity);
-    TL_RETURN_IF_FALSE(IsEnable(entity) && tilemap_layer->GetLayer() &&
-                       tilemap_layer->GetTilemap());
+    TL_RETURN_IF_FALSE(IsEnable(entity));
+    const Tilemap* tilemap = tilemap_layer->refreshTilemap();
+    TL_RETURN_IF_FALSE(tilemap && tilemap_layer->GetLayer());
 
     drawTilemapLayer(CLIENT_CONTEXT.m_draw_order_manager->Get(entity),
-                     *tilemap_layer);
+                     *tilemap, *tilemap_layer);
 }
 
 void TilemapLayerRenderComponentManager::drawTilemapLayer(
-    const DrawOrder* draw_order, const TilemapLayerRenderComponent& component) {
+    const DrawOrder* draw_order, const Tilemap& tilemap,
+    const TilemapLayerRenderComponent& component) {
     auto& renderer = CLIENT_CONTEXT.m_renderer;
     auto tilemap_layer = component.GetLayer();
-    const Tilemap* tilemap = component.GetTilemap();
     if (tilemap_layer->GetType() == TilemapLayer::Type::Tiled) {
-        auto tiled_layer = tilemap_layer->AsTiledLayer();
-        auto& size = tiled_layer->GetSize();
-        for (size_t y = 0; y < size.y; y++) {
-            for (size_t x = 0; x < size.x; x++) {
-                auto& layer_tile = tiled_layer->GetTile(x, y);
-                auto tile = tilemap->GetTile(layer_tile.m_gid);
-                if (!tile) {
-                    continue;
-                }
-                Rect dst_rect;
-                dst_rect.m_half_size = tile->m_region.m_size * 0.5;
-
-                float scale = 1.0;
-                Vec2 scaled_tile_size = tilemap->GetTileSize() * scale;
-
-                dst_rect.m_center =
-                    Vec2(x, y + 1) * scaled_tile_size +
-                    Vec2(tile->m_tile_size.w, -tile->m_tile_size.h) * 0.5;
-
-                constexpr float scale_expand = 0.01;
-                scale += scale_expand;
-                dst_rect.m_half_size *= scale;
-
-                Region dst_region;
-                dst_region.m_topleft = dst_rect.m_center - dst_rect.m_half_size;
-                dst_region.m_size = dst_rect.m_half_size * 2.0;
+        Rect visible_rect = CLIENT_CONTEXT.m_camera.GetVisibleRect();
+        auto& proxies = component.GetTileProxies();
+        for (auto& chunk : component.GetTileChunks()) {
+            TL_CONTINUE_IF_FALSE(IsRectsIntersect(chunk.m_bounds, visible_rect));
 
-                renderer->DrawImage(
-                    *tile->m_image, tile->m_region, dst_region, Color::White, 0,
-                    {0, 0}, layer_tile.m_flip, draw_order->GetGlobalOrder(),
-                    true, dst_rect.m_center.y + dst_rect.m_half_size.y);
+            for (uint32_t i = chunk.m_begin; i < chunk.m_end; i++) {
+                auto& proxy = proxies[i];
+                const Tile* tile = tilemap.GetTile(proxy.m_gid);
+                TL_CONTINUE_IF_FALSE(tile && tile->m_image);
+                renderer->DrawImage(*tile->m_image, tile->m_region,
+                                    proxy.m_dst, Color::White, 0, {0, 0},
+                                    proxy.m_flip, draw_order->GetGlobalOrder(),
+                                    true, proxy.m_y_sorting);
             }
         }
     } else if (tilemap_layer->GetType() == TilemapLayer::Type::Image) {
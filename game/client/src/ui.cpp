@@ -36,14 +36,12 @@ const UTF8String& UITextInput::GetText() const {
 void UITextInput::SetText(const std::string& text) {
     m_text = UTF8String(text);
     m_cursor_pos = m_text.size();
-    m_cursor_x_dirty = true;
     regenerateText();
 }
 
 void UITextInput::SetText(const UTF8String& text) {
     m_text = text;
     m_cursor_pos = text.size();
-    m_cursor_x_dirty = true;
     regenerateText();
 }
 
@@ -54,84 +52,61 @@ size_t UITextInput::GetCursorPos() const {
 void UITextInput::SetCursorPos(size_t pos) {
     if (pos > m_text.size()) pos = m_text.size();
     m_cursor_pos = pos;
-    m_cursor_x_dirty = true;
 }
 
 void UITextInput::MoveCursorLeft() {
     if (m_cursor_pos > 0) {
         m_cursor_pos--;
-        m_cursor_x_dirty = true;
     }
 }
 
 void UITextInput::MoveCursorRight() {
     if (m_cursor_pos < m_text.size()) {
         m_cursor_pos++;
-        m_cursor_x_dirty = true;
     }
 }
 
 void UITextInput::MoveCursorHome() {
     m_cursor_pos = 0;
-    m_cursor_x_dirty = true;
 }
 
 void UITextInput::MoveCursorEnd() {
     m_cursor_pos = m_text.size();
-    m_cursor_x_dirty = true;
 }
 
 void UITextInput::DeleteBeforeCursor() {
     TL_RETURN_IF_TRUE(m_cursor_pos == 0);
     m_text.erase(m_cursor_pos - 1, 1);
     m_cursor_pos--;
-    m_cursor_x_dirty = true;
     regenerateText();
 }
 
 void UITextInput::DeleteAfterCursor() {
     TL_RETURN_IF_TRUE(m_cursor_pos >= m_text.size());
     m_text.erase(m_cursor_pos, 1);
-    m_cursor_x_dirty = true;
     regenerateText();
 }
 
-Image& UITextInput::GetTextImage() {
-    return m_text_image;
+const TextLayout& UITextInput::GetTextLayout() const {
+    return m_text_layout;
 }
 
-Vec2 UITextInput::GetTextImageSize() const {
-    return m_text_image.GetSize();
+Vec2 UITextInput::GetTextSize() const {
+    return m_text_layout.m_size;
 }
 
 void UITextInput::RefreshText() {
     regenerateText();
 }
 
-float UITextInput::GetCursorX() {
-    TL_RETURN_VALUE_IF_FALSE(m_cursor_pos != 0, 0);
-
-    if (m_cursor_x_dirty) {
-        m_cursor_x_dirty = false;
-        m_font->SetFontSize(m_pt);
-        UTF8String left = m_text.substr(0, m_cursor_pos);
-        std::string left_utf8(left.c_str());
-        SDL_Surface* surf = m_font->GenerateText(left_utf8, m_color);
-        m_cursor_x_cache = surf ? static_cast<float>(surf->w) : 0;
-        if (surf) {
-            SDL_DestroySurface(surf);
-        }
-    }
-    return m_cursor_x_cache;
+float UITextInput::GetCursorX() const {
+    TL_RETURN_VALUE_IF_TRUE(m_cursor_pos >= m_text_layout.m_pen_x.size(), 0);
+    return m_text_layout.m_pen_x[m_cursor_pos];
 }
 
 void UITextInput::regenerateText() {
-    m_font->SetFontSize(m_pt);
-    m_cursor_x_dirty = true;
-    TL_RETURN_IF_TRUE(m_text.empty());
-    m_text_image =
-        Image{*CLIENT_CONTEXT.m_renderer,
-              m_font->GenerateText(std::string(m_text.c_str()), m_color)};
+    TL_RETURN_IF_FALSE(m_font);
+    m_text_layout = m_font->LayoutText(m_text, m_pt);
 }
 
 void UITextInput::HandleTextInput(const SDL_TextInputEvent& event) {
@@ -145,7 +120,6 @@ void UITextInput::HandleTextInput(const SDL_TextInputEvent& event) {
         changed = true;
     }
     if (changed) {
-        m_cursor_x_dirty = true;
         regenerateText();
     }
 }
@@ -157,6 +131,10 @@ void UIText::SetFont(FontHandle font) {
     regenerateText();
 }
 
+FontHandle UIText::GetFont() const {
+    return m_font;
+}
+
 void UIText::ChangeText(const std::string& text) {
     m_text = text;
     regenerateText();
@@ -167,25 +145,21 @@ void UIText::SetFontSize(uint32_t pt) {
     regenerateText();
 }
 
-Vec2 UIText::GetTextImageSize() const {
-    return m_text_image.GetSize();
+Vec2 UIText::GetTextSize() const {
+    return m_text_layout.m_size;
 }
 
 const std::string& UIText::GetText() const {
     return m_text;
 }
 
-Image& UIText::GetTextImage() {
-    return m_text_image;
+const TextLayout& UIText::GetTextLayout() const {
+    return m_text_layout;
 }
 
 void UIText::regenerateText() {
-    TL_RETURN_IF_FALSE(!m_text.empty());
-
-    m_font->SetFontSize(m_pt_size);
-
-    m_text_image = Image{*CLIENT_CONTEXT.m_renderer,
-                         m_font->GenerateText(m_text, m_color)};
+    TL_RETURN_IF_FALSE(m_font);
+    m_text_layout = m_font->LayoutText(UTF8String{m_text}, m_pt_size);
 }
 
 void UIPanelComponent::UpdateSize(const Transform& old_transform,
@@ -469,6 +443,96 @@ bool UIComponentManager::IsCursorVisible() const {
     return m_cursor_visible;
 }
 
+void UIHitGrid::Build(const std::vector<Rect>& rects, size_t first) {
+    m_cols = 0;
+    m_rows = 0;
+    m_cell_begin.clear();
+    m_items.clear();
+    TL_RETURN_IF_TRUE(first >= rects.size());
+
+    Vec2 min = rects[first].m_center - rects[first].m_half_size;
+    Vec2 max = rects[first].m_center + rects[first].m_half_size;
+    for (size_t i = first + 1; i < rects.size(); i++) {
+        Vec2 topleft = rects[i].m_center - rects[i].m_half_size;
+        Vec2 bottomright = rects[i].m_center + rects[i].m_half_size;
+        min.x = std::min(min.x, topleft.x);
+        min.y = std::min(min.y, topleft.y);
+        max.x = std::max(max.x, bottomright.x);
+        max.y = std::max(max.y, bottomright.y);
+    }
+
+    Vec2 extent = max - min;
+    m_min = min;
+    m_cell_size.x = std::max(CellSize, extent.x / MaxCellCount);
+    m_cell_size.y = std::max(CellSize, extent.y / MaxCellCount);
+    m_cols = std::min(static_cast<int>(extent.x / m_cell_size.x) + 1,
+                      MaxCellCount);
+    m_rows = std::min(static_cast<int>(extent.y / m_cell_size.y) + 1,
+                      MaxCellCount);
+
+    auto for_each_cell = [&](const Rect& rect, auto&& fn) {
+        Vec2 topleft = rect.m_center - rect.m_half_size - m_min;
+        Vec2 bottomright = rect.m_center + rect.m_half_size - m_min;
+        int min_col = static_cast<int>(topleft.x / m_cell_size.x);
+        int min_row = static_cast<int>(topleft.y / m_cell_size.y);
+        int max_col = std::min(static_cast<int>(bottomright.x / m_cell_size.x),
+                               m_cols - 1);
+        int max_row = std::min(static_cast<int>(bottomright.y / m_cell_size.y),
+                               m_rows - 1);
+        for (int row = min_row; row <= max_row; row++) {
+            for (int col = min_col; col <= max_col; col++) {
+                fn(row * m_cols + col);
+            }
+        }
+    };
+
+    // count rects of each cell, then fill them by prefix sum
+    m_cell_begin.assign(m_cols * m_rows + 1, 0);
+    for (size_t i = first; i < rects.size(); i++) {
+        for_each_cell(rects[i], [&](int cell) { m_cell_begin[cell + 1]++; });
+    }
+    for (size_t i = 1; i < m_cell_begin.size(); i++) {
+        m_cell_begin[i] += m_cell_begin[i - 1];
+    }
+
+    m_items.resize(m_cell_begin.back());
+    std::vector<uint32_t> cursor(m_cell_begin.begin(), m_cell_begin.end() - 1);
+    for (size_t i = first; i < rects.size(); i++) {
+        for_each_cell(rects[i], [&](int cell) {
+            m_items[cursor[cell]++] = static_cast<uint32_t>(i);
+        });
+    }
+}
+
+void UIHitGrid::Query(const Vec2& position, const std::vector<Rect>& rects,
+                      std::vector<uint32_t>& hits) const {
+    hits.clear();
+    TL_RETURN_IF_TRUE(m_cols == 0 || m_rows == 0);
+
+    Vec2 local = position - m_min;
+    TL_RETURN_IF_TRUE(local.x < 0 || local.y < 0);
+    int col = static_cast<int>(local.x / m_cell_size.x);
+    int row = static_cast<int>(local.y / m_cell_size.y);
+    TL_RETURN_IF_TRUE(col >= m_cols || row >= m_rows);
+
+    int cell = row * m_cols + col;
+    for (uint32_t i = m_cell_begin[cell]; i < m_cell_begin[cell + 1]; i++) {
+        uint32_t index = m_items[i];
+        if (IsPointInRect(position, rects[index])) {
+            hits.push_back(index);
+        }
+    }
+}
+
+void UIComponentManager::RemoveEntity(Entity entity) {
+    ComponentManager::RemoveEntity(entity);
+    InvalidateLayout();
+}
+
+void UIComponentManager::InvalidateLayout() {
+    m_layout_dirty = true;
+}
+
 void UIComponentManager::Update(TimeType elapse_time) {
     PROFILE_SECTION();
 
@@ -487,8 +551,9 @@ void UIComponentManager::Update(TimeType elapse_time) {
     Transform* transform =
         CLIENT_CONTEXT.m_transform_manager->Get(ui_root_entity);
     TL_RETURN_IF_TRUE(transform->m_size == Vec2::ZERO);
-    updateSize(ui_root_entity);
-    updateTransform(ui_root_entity);
+    refreshLayoutNodes(ui_root_entity);
+    updateSize();
+    updateTransform();
 
     m_is_first_update = false;
 }
@@ -506,18 +571,15 @@ void UIComponentManager::HandleEvent() {
         return;
     }
 
-    Entity ui_root_entity = level->GetUIRootEntity();
-    auto relationship =
-        CLIENT_CONTEXT.m_relationship_manager->Get(ui_root_entity);
+    // scripts may move widgets after last layout, so refresh rects here
+    refreshLayoutNodes(level->GetUIRootEntity());
+    refreshScreenRects();
 
     auto& mouse = CLIENT_CONTEXT.m_mouse;
     const Button& left_button = mouse->Get(MouseButtonType::Left);
 
 #ifndef TL_ANDROID
-    for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-        handleEvent(relationship->Get(i), -1, left_button, mouse->Position(),
-                    mouse->Offset());
-    }
+    handlePointer(-1, left_button, mouse->Position(), mouse->Offset());
 #else
     auto& touches = CLIENT_CONTEXT.m_touches;
     for (size_t i = 0; i < touches->GetFingers().size(); i++) {
@@ -526,110 +588,191 @@ void UIComponentManager::HandleEvent() {
             continue;
         }
 
-        for (uint32_t i = 0; i < relationship->GetChildrenCount(); i++) {
-            Entity child = relationship->Get(i);
-            UIWidget* child_ui = CLIENT_CONTEXT.m_ui_manager->Get(child);
-            if (child_ui->m_focus_index && child_ui->m_focus_index != i) {
-                continue;
-            }
-            handleEvent(child, i, finger, finger.Position(), finger.Offset());
-        }
+        handlePointer(i, finger, finger.Position(), finger.Offset());
     }
 #endif
 }
 
-void UIComponentManager::updateSize(Entity entity) {
-    auto relationship = CLIENT_CONTEXT.m_relationship_manager->Get(entity);
-    auto transform = CLIENT_CONTEXT.m_transform_manager->Get(entity);
-    auto ui = Get(entity);
+void UIComponentManager::refreshLayoutNodes(Entity root) {
+    if (m_layout_root != root) {
+        m_layout_root = root;
+        m_layout_dirty = true;
+    }
 
-    TL_RETURN_IF_FALSE(transform && ui && relationship);
+    // relationship registered or removed don't bump any cached node's version
+    uint32_t relationship_manager_version =
+        CLIENT_CONTEXT.m_relationship_manager->GetVersion();
+    if (m_relationship_manager_version != relationship_manager_version) {
+        m_relationship_manager_version = relationship_manager_version;
+        m_layout_dirty = true;
+    }
 
-    if (ui->m_panel) {
-        if (ui->m_old_transform.m_size == Vec2::ZERO) {
-            ui->m_old_transform = *transform;
+    if (!m_layout_dirty) {
+        for (auto& node : m_layout_nodes) {
+            if (node.m_relationship &&
+                node.m_relationship->GetVersion() !=
+                    node.m_relationship_version) {
+                m_layout_dirty = true;
+                break;
+            }
         }
-        ui->m_panel->UpdateSize(ui->m_old_transform, *transform, *relationship,
-                                *ui, m_is_first_update);
     }
-
-    for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-        updateSize(relationship->Get(i));
+    TL_RETURN_IF_FALSE(m_layout_dirty);
+
+    m_layout_dirty = false;
+    m_layout_nodes.clear();
+    collectLayoutNodes(root, NoParent);
+    m_screen_rects.assign(m_layout_nodes.size(), Rect{});
+    m_hit_grid_dirty = true;
+
+    m_pointer_nodes.clear();
+    for (uint32_t i = 0; i < m_layout_nodes.size(); i++) {
+        UIWidget* ui = m_layout_nodes[i].m_ui;
+        if (ui->m_state != UIState::Normal || ui->m_focus_index) {
+            m_pointer_nodes.push_back(i);
+        }
     }
 }
 
-void UIComponentManager::updateTransform(Entity entity) {
-    auto relationship = CLIENT_CONTEXT.m_relationship_manager->Get(entity);
-    auto ui = Get(entity);
+void UIComponentManager::collectLayoutNodes(Entity entity, uint32_t parent) {
     auto transform = CLIENT_CONTEXT.m_transform_manager->Get(entity);
+    auto ui = Get(entity);
 
     TL_RETURN_IF_FALSE(transform && ui);
 
-    TL_RETURN_IF_NULL(relationship);
+    auto relationship = CLIENT_CONTEXT.m_relationship_manager->Get(entity);
 
-    if (ui->m_panel) {
-        if (ui->m_old_transform.m_size == Vec2::ZERO) {
-            ui->m_old_transform = *transform;
-        }
-        ui->m_panel->UpdatePosition(ui->m_old_transform, *transform,
-                                    *relationship, *ui, m_is_first_update);
+    LayoutNode node;
+    node.m_entity = entity;
+    node.m_ui = ui;
+    node.m_transform = transform;
+    node.m_relationship = relationship;
+    node.m_parent = parent;
+    if (relationship) {
+        node.m_relationship_version = relationship->GetVersion();
     }
 
+    uint32_t index = static_cast<uint32_t>(m_layout_nodes.size());
+    m_layout_nodes.push_back(node);
+
+    TL_RETURN_IF_NULL(relationship);
     for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-        updateTransform(relationship->Get(i));
+        collectLayoutNodes(relationship->Get(i), index);
+    }
+}
+
+void UIComponentManager::refreshScreenRects() {
+    for (size_t i = 0; i < m_layout_nodes.size(); i++) {
+        const Transform& transform = *m_layout_nodes[i].m_transform;
+        Rect rect;
+        rect.m_half_size = transform.m_size * 0.5;
+        rect.m_center = transform.m_position + rect.m_half_size;
+
+        Rect& cached = m_screen_rects[i];
+        if (!(cached.m_center == rect.m_center &&
+              cached.m_half_size == rect.m_half_size)) {
+            cached = rect;
+            m_hit_grid_dirty = true;
+        }
     }
 
-    ui->m_old_transform = *transform;
+    if (m_hit_grid_dirty) {
+        // ui root covers the whole screen and never receives pointer
+        m_hit_grid.Build(m_screen_rects, 1);
+        m_hit_grid_dirty = false;
+    }
 }
 
-void UIComponentManager::handleEvent(Entity entity, size_t finger_index,
-                                     const Button& button, const Vec2& position,
-                                     const Vec2& offset) {
-    auto transform = CLIENT_CONTEXT.m_transform_manager->Get(entity);
-    auto ui = Get(entity);
+void UIComponentManager::updateSize() {
+    for (auto& node : m_layout_nodes) {
+        UIWidget& ui = *node.m_ui;
+        TL_CONTINUE_IF_FALSE(ui.m_panel && node.m_relationship);
 
-    TL_RETURN_IF_FALSE(transform && ui);
+        if (ui.m_old_transform.m_size == Vec2::ZERO) {
+            ui.m_old_transform = *node.m_transform;
+        }
 
-    bool need_handle_event = true;
-    auto relationship = CLIENT_CONTEXT.m_relationship_manager->Get(entity);
-    if (!isFocusing(*ui, finger_index) && relationship) {
-        for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-            Entity child = relationship->Get(i);
-            auto child_transform =
-                CLIENT_CONTEXT.m_transform_manager->Get(child);
-            if (!child_transform) {
-                continue;
-            }
+        // children of unchanged panel keep their layout
+        TL_CONTINUE_IF_TRUE(!m_is_first_update &&
+                            ui.m_old_transform == *node.m_transform);
+        ui.m_panel->UpdateSize(ui.m_old_transform, *node.m_transform,
+                               *node.m_relationship, ui, m_is_first_update);
+    }
+}
 
-            Rect child_ui_rect;
-            child_ui_rect.m_half_size = child_transform->m_size * 0.5;
-            child_ui_rect.m_center =
-                child_transform->m_position + child_ui_rect.m_half_size;
-            if (IsPointInRect(position, child_ui_rect)) {
-                need_handle_event = true;
-                break;
+void UIComponentManager::updateTransform() {
+    // nodes are in depth-first order, so parent always layouts its children
+    // before they layout theirs
+    for (auto& node : m_layout_nodes) {
+        UIWidget& ui = *node.m_ui;
+        TL_CONTINUE_IF_NULL(node.m_relationship);
+
+        if (ui.m_panel) {
+            if (ui.m_old_transform.m_size == Vec2::ZERO) {
+                ui.m_old_transform = *node.m_transform;
+            }
+            if (m_is_first_update || ui.m_old_transform != *node.m_transform) {
+                ui.m_panel->UpdatePosition(ui.m_old_transform,
+                                           *node.m_transform,
+                                           *node.m_relationship, ui,
+                                           m_is_first_update);
             }
         }
+
+        ui.m_old_transform = *node.m_transform;
     }
+}
 
-    if (ui->m_disabled) {
-        need_handle_event = false;
+bool UIComponentManager::isEventTarget(uint32_t node) const {
+    uint32_t parent = m_layout_nodes[node].m_parent;
+    while (parent != NoParent) {
+        auto& parent_node = m_layout_nodes[parent];
+        if (parent_node.m_parent == NoParent) {
+            return true;
+        }
+        if (!parent_node.m_ui->m_disabled) {
+            return false;
+        }
+        parent = parent_node.m_parent;
     }
+    return false;
+}
 
-    if (!need_handle_event) {
-        if (relationship) {
-            for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-                handleEvent(relationship->Get(i), finger_index, button,
-                            position, offset);
-            }
+void UIComponentManager::handlePointer(size_t finger_index,
+                                       const Button& button,
+                                       const Vec2& position,
+                                       const Vec2& offset) {
+    m_hit_grid.Query(position, m_screen_rects, m_hit_nodes);
+
+    // widgets pointer left must be handled too, to leave hover/down state
+    m_handling_nodes.clear();
+    std::set_union(m_hit_nodes.begin(), m_hit_nodes.end(),
+                   m_pointer_nodes.begin(), m_pointer_nodes.end(),
+                   std::back_inserter(m_handling_nodes));
+
+    m_pointer_nodes.clear();
+    for (uint32_t node : m_handling_nodes) {
+        UIWidget* ui = m_layout_nodes[node].m_ui;
+        bool focused_by_other =
+            ui->m_focus_index && ui->m_focus_index != finger_index;
+        if (!ui->m_disabled && !focused_by_other && isEventTarget(node)) {
+            handleEvent(node, finger_index, button, position, offset);
+        }
+
+        if (ui->m_state != UIState::Normal || ui->m_focus_index) {
+            m_pointer_nodes.push_back(node);
         }
-        return;
     }
+}
+
+void UIComponentManager::handleEvent(uint32_t node, size_t finger_index,
+                                     const Button& button, const Vec2& position,
+                                     const Vec2& offset) {
+    Entity entity = m_layout_nodes[node].m_entity;
+    UIWidget* ui = m_layout_nodes[node].m_ui;
 
-    Rect ui_rect;
-    ui_rect.m_half_size = transform->m_size * 0.5;
-    ui_rect.m_center = transform->m_position + ui_rect.m_half_size;
-    if (!isFocusing(*ui, finger_index) && !IsPointInRect(position, ui_rect)) {
+    if (!isFocusing(*ui, finger_index) &&
+        !IsPointInRect(position, m_screen_rects[node])) {
         ui->m_state = UIState::Normal;
         return;
     }
@@ -694,6 +837,13 @@ void UIComponentManager::handleEvent(Entity entity, size_t finger_index,
     }
 }
 
+/**
+ * text glyphs are white, tint them by text color & theme color
+ */
+static Color modulateColor(const Color& a, const Color& b) {
+    return {a.r * b.r, a.g * b.g, a.b * b.b, a.a * b.a};
+}
+
 void UIComponentManager::render(Renderer& renderer, Entity entity) {
     auto transform = CLIENT_CONTEXT.m_transform_manager->Get(entity);
     auto ui = Get(entity);
@@ -741,16 +891,18 @@ void UIComponentManager::render(Renderer& renderer, Entity entity) {
     if (theme->m_image) {
         Region src;
         src.m_size = theme->m_image->GetSize();
-        theme->m_image->ChangeColorMask(theme->m_background_color);
+        // tint by draw color, image may share texture with others in atlas
         if (theme->m_image_9grid.m_border_scale > 0) {
-            renderer.DrawImage9Grid(
-                *theme->m_image, src, dst, Color::White, theme->m_image_9grid,
-                theme->m_image_9grid.m_border_scale, z_order, false, y);
+            renderer.DrawImage9Grid(*theme->m_image, src, dst,
+                                    theme->m_background_color,
+                                    theme->m_image_9grid,
+                                    theme->m_image_9grid.m_border_scale,
+                                    z_order, false, y);
         } else {
-            renderer.DrawImage(*theme->m_image, src, dst, Color::White, 0, {},
-                               Flip::None, z_order, false, y);
+            renderer.DrawImage(*theme->m_image, src, dst,
+                               theme->m_background_color, 0, {}, Flip::None,
+                               z_order, false, y);
         }
-        theme->m_image->ChangeColorMask(Color::White);
     } else {
         renderer.FillRect(rect, theme->m_background_color, z_order, false, y);
     }
@@ -758,7 +910,7 @@ void UIComponentManager::render(Renderer& renderer, Entity entity) {
     renderer.DrawRect(rect, theme->m_border_color, z_order, false, y);
 
     if (ui->m_text_input) {
-        auto text_size = ui->m_text_input->GetTextImageSize();
+        auto text_size = ui->m_text_input->GetTextSize();
 
         Region region;
         switch (ui->m_text_input->m_align) {
@@ -778,14 +930,13 @@ void UIComponentManager::render(Renderer& renderer, Entity entity) {
         region.m_size = text_size;
         region.m_topleft.y = rect.m_center.y - region.m_size.y * 0.5;
 
-        Image& image = ui->m_text_input->GetTextImage();
-        if (text_size.w > 0 && text_size.h > 0) {
-            image.ChangeColorMask(theme->m_foreground_color);
-            Region src;
-            src.m_size = image.GetSize();
-            renderer.DrawImage(image, src, region, Color::White, 0, Vec2::ZERO,
-                               Flip::None, z_order, false, y);
-            image.ChangeColorMask(Color::White);
+        FontHandle font = ui->m_text_input->GetFont();
+        if (font && text_size.w > 0 && text_size.h > 0) {
+            renderer.DrawTextLayout(
+                *font, ui->m_text_input->GetTextLayout(), region.m_topleft,
+                modulateColor(ui->m_text_input->m_color,
+                              theme->m_foreground_color),
+                z_order, false, y);
         }
 
         if (IsFocusedWidget(entity) && IsCursorVisible()) {
@@ -800,7 +951,7 @@ void UIComponentManager::render(Renderer& renderer, Entity entity) {
                               false, y);
         }
     } else if (ui->m_text) {
-        auto text_size = ui->m_text->GetTextImageSize();
+        auto text_size = ui->m_text->GetTextSize();
 
         Region region;
 
@@ -819,15 +970,13 @@ void UIComponentManager::render(Renderer& renderer, Entity entity) {
                 break;
         }
 
-        Image& image = ui->m_text->GetTextImage();
-        region.m_size = image.GetSize();
-        region.m_topleft.y = rect.m_center.y - region.m_size.y * 0.5;
-        image.ChangeColorMask(theme->m_foreground_color);
-        Region src;
-        src.m_size = image.GetSize();
-        renderer.DrawImage(image, src, region, Color::White, 0, Vec2::ZERO,
-                           Flip::None, z_order, false, y);
-        image.ChangeColorMask(Color::White);
+        region.m_topleft.y = rect.m_center.y - text_size.h * 0.5;
+        if (FontHandle font = ui->m_text->GetFont()) {
+            renderer.DrawTextLayout(
+                *font, ui->m_text->GetTextLayout(), region.m_topleft,
+                modulateColor(ui->m_text->m_color, theme->m_foreground_color),
+                z_order, false, y);
+        }
     }
 
     if (ui->m_use_clip) {
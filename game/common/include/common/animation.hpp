@@ -2,6 +2,7 @@
 #include "common/asset.hpp"
 #include "common/asset_manager_interface.hpp"
 #include "common/entity.hpp"
+#include "common/flag.hpp"
 #include "common/manager.hpp"
 #include "common/math.hpp"
 
@@ -10,8 +11,13 @@
 #include "common/timer.hpp"
 #include "common/timer.hpp"
 #include "schema/cpp_asset_def_extension.hpp"
+#include "schema/flip.hpp"
 
+#include <array>
+#include <limits>
 #include <memory>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 template <typename T>
@@ -83,6 +89,137 @@ public:
     }
 };
 
+class Animation;
+class AnimationClip;
+
+using AnimationValueArrays =
+    std::tuple<std::vector<Vec2>, std::vector<Degrees>, std::vector<Color>,
+               std::vector<ImageHandle>, std::vector<Flags<Flip>>>;
+
+/**
+ * values of all tracks of a clip sampled at one time
+ */
+struct AnimationPose {
+    AnimationValueArrays m_values;  // grouped by type as clip tracks
+    std::vector<uint8_t> m_sampled;  // 0 if before track's first keyframe
+
+    // scratch for sampling
+    std::vector<int> m_frames;
+    std::vector<float> m_factors;
+
+    /**
+     * @return nullptr if track not sampled
+     */
+    template <typename T>
+    const T* Get(const AnimationClip& clip, uint32_t track) const;
+};
+
+/**
+ * animation compiled for playing. Keyframes of all tracks lay in contiguous
+ * arrays grouped by value type, tracks are found by a fixed binding point
+ * table instead of hashing
+ */
+class AnimationClip {
+public:
+    static constexpr uint32_t InvalidTrack =
+        std::numeric_limits<uint32_t>::max();
+
+    struct Track {
+        AnimationTrackType m_type = AnimationTrackType::Discrete;
+        uint32_t m_first{};        // first keyframe in times array
+        uint32_t m_first_value{};  // first keyframe in value array of its type
+        uint32_t m_count{};
+    };
+
+    struct BindPointTrack {
+        std::string m_name;
+        uint32_t m_track = InvalidTrack;
+    };
+
+    explicit AnimationClip(const Animation& animation);
+
+    [[nodiscard]] uint32_t GetTrackIndex(AnimationBindingPoint) const;
+    [[nodiscard]] const std::vector<BindPointTrack>& GetBindPointTracks() const;
+    [[nodiscard]] size_t GetTrackCount() const;
+    [[nodiscard]] TimeType GetDuration() const;
+
+    /**
+     * find the last keyframe at or before `time` by binary search
+     * @param hint keyframe found last time, checked first so playing forward
+     * is O(1). Updated to the result
+     * @return -1 if `time` is before the first keyframe
+     */
+    int Seek(uint32_t track, TimeType time, uint32_t& hint) const;
+
+    /**
+     * sample all tracks at `time`. Keyframes are seeked first, then values of
+     * each type are blended in one flat loop
+     * @param hints one per track, see `Seek`
+     */
+    void SamplePose(TimeType time, uint32_t* hints, AnimationPose& pose) const;
+
+    /**
+     * index of track in pose values of its type
+     */
+    template <typename T>
+    [[nodiscard]] uint32_t GetPoseSlot(uint32_t track) const {
+        return track - m_type_tracks[valueTypeIndex<T>()].m_begin;
+    }
+
+private:
+    struct PendingTrack {
+        const AnimationTrackBase* m_track{};
+        uint32_t* m_index{};  // where to write compiled track index
+        bool m_can_linear = true;
+    };
+
+    template <typename T>
+    static constexpr size_t valueTypeIndex() {
+        if constexpr (std::is_same_v<T, Vec2>) {
+            return 0;
+        } else if constexpr (std::is_same_v<T, Degrees>) {
+            return 1;
+        } else if constexpr (std::is_same_v<T, Color>) {
+            return 2;
+        } else if constexpr (std::is_same_v<T, ImageHandle>) {
+            return 3;
+        } else {
+            static_assert(std::is_same_v<T, Flags<Flip>>);
+            return 4;
+        }
+    }
+
+    template <typename T>
+    static constexpr bool canLerp =
+        !std::is_same_v<T, ImageHandle> && !std::is_same_v<T, Flags<Flip>>;
+
+    std::array<uint32_t, kAnimationBindingPoint_Count> m_binding_tracks;
+    std::vector<BindPointTrack> m_bind_point_tracks;
+
+    // tracks of same value type are adjacent
+    std::vector<Track> m_tracks;
+    std::array<Range<uint32_t>, std::tuple_size_v<AnimationValueArrays>>
+        m_type_tracks;
+
+    std::vector<TimeType> m_times;
+    AnimationValueArrays m_values;
+    TimeType m_duration{};
+
+    template <typename T>
+    void compileTracks(const std::vector<PendingTrack>& tracks);
+
+    template <typename T>
+    void blendPose(AnimationPose& pose) const;
+};
+
+template <typename T>
+const T* AnimationPose::Get(const AnimationClip& clip, uint32_t track) const {
+    if (track == AnimationClip::InvalidTrack || !m_sampled[track]) {
+        return nullptr;
+    }
+    return &std::get<std::vector<T>>(m_values)[clip.GetPoseSlot<T>(track)];
+}
+
 class Animation {
 public:
     void AddTrack(AnimationBindingPoint binding,
@@ -93,20 +230,37 @@ public:
 
     auto& GetTracks() const { return m_tracks; }
 
-    auto& GetTracks() { return m_tracks; }
+    /**
+     * @note mutable access drops compiled clip, it is recompiled on next
+     * `GetClip()`
+     */
+    auto& GetTracks() {
+        m_clip.reset();
+        return m_tracks;
+    }
 
     auto& GetBindPointTracks() const { return m_bind_point_tracks; }
 
-    auto& GetBindPointTracks() { return m_bind_point_tracks; }
+    auto& GetBindPointTracks() {
+        m_clip.reset();
+        return m_bind_point_tracks;
+    }
 
     [[nodiscard]] TimeType GetFinishTime() const;
 
+    /**
+     * compile tracks into clip, called after loading
+     */
+    void Compile() const;
+    [[nodiscard]] const AnimationClip& GetClip() const;
+
 private:
     std::unordered_map<AnimationBindingPoint,
                        std::unique_ptr<AnimationTrackBase>>
         m_tracks;
     std::unordered_map<std::string, std::unique_ptr<AnimationTrackBase>>
         m_bind_point_tracks;
+    mutable std::unique_ptr<AnimationClip> m_clip;
 };
 
 using AnimationHandle = Handle<Animation>;
@@ -123,10 +277,16 @@ AssetLoadResult<Animation> LoadAsset<Animation>(const Path& filename);
 template <>
 AssetLoadResult<Animation> LoadAsset<Animation>(const rapidxml::xml_node<>&);
 
+template <>
+AssetLoadResult<Animation> LoadAsset<Animation>(const CookedAssetFile&);
+
 void SaveAsset(const UUIDv4& uuid, const Animation& payload,
                const Path& filename);
 
 class AnimationManager : public AssetManagerBase<Animation> {
 public:
     AnimationHandle Load(const Path& filename, bool force = false) override;
+
+protected:
+    void loadAsync(const Path& filename, const UUIDv4& pending_uuid) override;
 };
@@ -3,7 +3,12 @@
 #include "common/path.hpp"
 #include "rapidxml.hpp"
 
+#include <functional>
 #include <memory>
+#include <vector>
+
+class WorkerPool;
+class CookedAssetFile;
 
 template <typename T>
 struct AssetLoadResult {
@@ -22,11 +27,56 @@ AssetLoadResult<T> LoadAsset(const Path& filename);
 template <typename T>
 AssetLoadResult<T> LoadAsset(const rapidxml::xml_node<>&);
 
+template <typename T>
+AssetLoadResult<T> LoadAsset(const CookedAssetFile&);
+
+/**
+ * xml asset file read & parsed in worker thread, deserialize it on main thread.
+ * Cooked file is preferred if exists
+ */
+class XMLAssetSource {
+public:
+    XMLAssetSource();
+    ~XMLAssetSource();
+
+    bool Load(const Path& filename);
+
+    const rapidxml::xml_node<>* GetRootNode() const;
+    const CookedAssetFile* GetCookedFile() const;
+
+private:
+    std::unique_ptr<CookedAssetFile> m_cooked_file;
+    std::vector<char> m_content;
+    rapidxml::xml_document<> m_doc;
+    bool m_parsed = false;
+};
+
+/**
+ * load assets referred by paths in xml tree in background, so deserializing
+ * the tree won't load them on main thread. Assets already loading are not
+ * waited, which also breaks reference cycles
+ * @param on_loaded called on main thread after all of them loaded,
+ * immediately if nothing to load
+ */
+void PrefetchAssetDependencies(const rapidxml::xml_node<>&,
+                               std::function<void()> on_loaded);
+
 class IAssetManager {
 public:
+    /**
+     * worker pool used by async loading. Without it `LoadAsync` falls back to
+     * synchronous `Load`
+     */
+    static void SetWorkerPool(WorkerPool*);
+    static WorkerPool* GetWorkerPool();
+
     virtual ~IAssetManager() = default;
     virtual const Path* GetFilename(const UUIDv4& uuid) const  = 0;
     virtual bool IsExists(const Path& filename) const = 0;
     virtual bool IsExists(const UUIDv4& uuid) const = 0;
+    virtual bool IsPending(const UUIDv4& uuid) const = 0;
+
+private:
+    static WorkerPool* s_worker_pool;
 };
 
@@ -6,9 +6,12 @@
 #include "common/log.hpp"
 #include "common/path.hpp"
 #include "common/type_index.hpp"
+#include "common/worker_pool.hpp"
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "macros.hpp"
 
@@ -20,12 +23,71 @@ template <typename T>
 class AssetManagerBase : public IAssetManager {
 public:
     using HandleType = Handle<T>;
+    using LoadedCallback = std::function<void(HandleType)>;
 
     virtual ~AssetManagerBase() = default;
 
     // load asset from path
     virtual HandleType Load(const Path& filename, bool force = false) = 0;
 
+    /**
+     * load asset from path in background. IO & decode run on worker pool,
+     * deserialize & GPU upload run on main thread.
+     *
+     * @param on_loaded called on main thread when finished(empty handle if
+     * failed). Called immediately if asset already loaded
+     * @return loaded handle, or pending handle(`IsPending()`) which can be
+     * resolved by `Find(handle.GetUUID())` after loaded
+     */
+    HandleType LoadAsync(const Path& filename, LoadedCallback on_loaded = {}) {
+        if (auto handle = Find(filename)) {
+            if (on_loaded) {
+                on_loaded(handle);
+            }
+            return handle;
+        }
+
+        if (auto it = m_pending_paths.find(filename);
+            it != m_pending_paths.end()) {
+            if (on_loaded) {
+                m_pending_loads[it->second].push_back(std::move(on_loaded));
+            }
+            return HandleType{it->second, nullptr, this};
+        }
+
+        if (!GetWorkerPool()) {
+            auto handle = Load(filename);
+            if (on_loaded) {
+                on_loaded(handle);
+            }
+            return handle;
+        }
+
+        UUIDv4 pending_uuid = UUIDv4::CreateV4();
+        m_pending_paths[filename] = pending_uuid;
+        auto& callbacks = m_pending_loads[pending_uuid];
+        if (on_loaded) {
+            callbacks.push_back(std::move(on_loaded));
+        }
+        loadAsync(filename, pending_uuid);
+        return HandleType{pending_uuid, nullptr, this};
+    }
+
+    /**
+     * `LoadAsync` if not loaded or loading
+     * @return true if `on_loaded` will be called
+     */
+    bool Prefetch(const Path& filename, std::function<void()> on_loaded) {
+        if (Find(filename) ||
+            m_pending_paths.find(filename) != m_pending_paths.end()) {
+            return false;
+        }
+        LoadAsync(filename, [on_loaded = std::move(on_loaded)](HandleType) {
+            on_loaded();
+        });
+        return true;
+    }
+
     // create an empty asset
     HandleType Create() {
         return this->store(nullptr, UUIDv4::CreateV4(), std::make_unique<T>());
@@ -46,12 +108,22 @@ public:
 
     virtual void Unload(HandleType handle) {
         auto uuid = handle.GetUUID();
+        if (auto it = m_uuid_aliases.find(uuid); it != m_uuid_aliases.end()) {
+            uuid = it->second;
+        }
         if (auto it = m_uuid_path_map.find(uuid); it != m_uuid_path_map.end()) {
             m_paths_uuid_map.erase(it->second);
             m_uuid_path_map.erase(it);
         }
 
         m_payloads.erase(uuid);
+        for (auto it = m_uuid_aliases.begin(); it != m_uuid_aliases.end();) {
+            if (it->second == uuid) {
+                it = m_uuid_aliases.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
 
     HandleType Find(const Path& filename) {
@@ -63,6 +135,9 @@ public:
     }
 
     HandleType Find(UUIDv4 uuid) {
+        if (auto it = m_uuid_aliases.find(uuid); it != m_uuid_aliases.end()) {
+            uuid = it->second;
+        }
         if (auto it = m_payloads.find(uuid); it != m_payloads.end()) {
             return {it->first, it->second.get(), this};
         }
@@ -104,6 +179,10 @@ public:
         return m_payloads.find(uuid) != m_payloads.end();
     }
 
+    bool IsPending(const UUIDv4& uuid) const override {
+        return m_pending_loads.find(uuid) != m_pending_loads.end();
+    }
+
     const Path* GetFilename(const UUIDv4& uuid) const override {
         if (auto it = m_uuid_path_map.find(uuid); it != m_uuid_path_map.end()) {
             return &it->second;
@@ -158,9 +237,96 @@ public:
         m_payloads.clear();
         m_paths_uuid_map.clear();
         m_uuid_path_map.clear();
+        m_uuid_aliases.clear();
     }
 
 protected:
+    /**
+     * start background loading, must call `finishAsyncLoad` on main thread
+     * at last. Default implementation loads synchronously on next
+     * `WorkerPool::Update`
+     */
+    virtual void loadAsync(const Path& filename, const UUIDv4& pending_uuid) {
+        GetWorkerPool()->PostToMainThread([=]() {
+            AssetLoadResult<T> result;
+            if (auto handle = Load(filename)) {
+                result.m_uuid = handle.GetUUID();
+            }
+            finishAsyncLoad(filename, pending_uuid, std::move(result));
+        });
+    }
+
+    /**
+     * read & parse xml in worker thread, deserialize in main thread(it may
+     * load nested assets through other managers, which are not thread safe).
+     * Assets referred by xml are loaded in background before deserializing
+     */
+    void loadXMLAssetAsync(const Path& filename, const UUIDv4& pending_uuid) {
+        auto source = std::make_shared<XMLAssetSource>();
+        GetWorkerPool()->Submit(
+            [=]() { source->Load(filename); },
+            [=]() {
+                if (auto cooked = source->GetCookedFile()) {
+                    AssetLoadResult<T> result = LoadAsset<T>(*cooked);
+                    // corrupted cooked file, use xml
+                    if (!result) {
+                        result = LoadAsset<T>(filename);
+                    }
+                    finishAsyncLoad(filename, pending_uuid, std::move(result));
+                    return;
+                }
+
+                auto node = source->GetRootNode();
+                if (!node) {
+                    finishAsyncLoad(filename, pending_uuid, {});
+                    return;
+                }
+
+                PrefetchAssetDependencies(*node, [=]() {
+                    finishAsyncLoad(filename, pending_uuid,
+                                    LoadAsset<T>(*source->GetRootNode()));
+                });
+            });
+    }
+
+    /**
+     * store loaded payload & notify waiters.
+     * @param result payload is empty means asset already stored by
+     * `m_uuid`(or failed if `m_uuid` is invalid)
+     */
+    void finishAsyncLoad(const Path& filename, const UUIDv4& pending_uuid,
+                         AssetLoadResult<T>&& result) {
+        m_pending_paths.erase(filename);
+        auto it = m_pending_loads.find(pending_uuid);
+        std::vector<LoadedCallback> callbacks;
+        if (it != m_pending_loads.end()) {
+            callbacks = std::move(it->second);
+            m_pending_loads.erase(it);
+        }
+
+        HandleType handle;
+        if (result.m_payload) {
+            // loaded synchronously by others during loading
+            handle = Find(filename);
+            if (!handle) {
+                handle = store(&filename, result.m_uuid,
+                               std::move(result.m_payload));
+            }
+        } else if (result.m_uuid) {
+            handle = Find(result.m_uuid);
+        }
+
+        if (handle) {
+            m_uuid_aliases[pending_uuid] = handle.GetUUID();
+        } else {
+            LOGE("load asset {} async failed", filename);
+        }
+
+        for (auto& callback : callbacks) {
+            callback(handle);
+        }
+    }
+
     HandleType store(const Path* filename, UUIDv4 uuid,
                      std::unique_ptr<T>&& payload) {
         if (auto it = m_payloads.find(uuid); it != m_payloads.end()) {
@@ -182,6 +348,11 @@ private:
     std::unordered_map<UUIDv4, std::unique_ptr<T>> m_payloads;
     std::unordered_map<Path, UUIDv4> m_paths_uuid_map;
     std::unordered_map<UUIDv4, Path> m_uuid_path_map;
+
+    std::unordered_map<Path, UUIDv4> m_pending_paths;
+    std::unordered_map<UUIDv4, std::vector<LoadedCallback>> m_pending_loads;
+    // pending uuid -> real uuid
+    std::unordered_map<UUIDv4, UUIDv4> m_uuid_aliases;
 };
 
 template <typename T>
@@ -201,4 +372,9 @@ public:
         return this->store(&filename, result.m_uuid,
                            std::move(result.m_payload));
     }
+
+protected:
+    void loadAsync(const Path& filename, const UUIDv4& pending_uuid) override {
+        this->loadXMLAssetAsync(filename, pending_uuid);
+    }
 };
@@ -0,0 +1,478 @@
+#pragma once
+#include "common/animation.hpp"
+#include "common/asset.hpp"
+#include "common/asset_manager.hpp"
+#include "common/context.hpp"
+#include "common/flag.hpp"
+#include "common/handle.hpp"
+#include "common/log.hpp"
+#include "common/math.hpp"
+#include "common/storage.hpp"
+#include "schema/asset_info.hpp"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class CollisionGroup;
+
+/*
+ * Binary form of the xml `Serialize`/`Deserialize`, used by cooked assets.
+ *
+ * Fields are written in declaration order without names, numbers are written
+ * in host byte order(little endian on all our platforms). Cooked files carry
+ * the schema hash, so files cooked by an older schema are ignored.
+ */
+
+class BinaryWriter {
+public:
+    void Write(const void* data, size_t size);
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write(&value, sizeof(T));
+    }
+
+    void WriteString(std::string_view str);
+
+    const std::vector<char>& GetBuffer() const;
+
+    bool SaveToFile(const Path& filename) const;
+
+private:
+    std::vector<char> m_buffer;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size);
+
+    bool Read(void* data, size_t size);
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return Read(&value, sizeof(T));
+    }
+
+    /**
+     * @return view into the underlying memory, no copy
+     */
+    std::string_view ReadString();
+
+    /**
+     * read element count of container, fails if it's bigger than remain bytes
+     */
+    uint32_t ReadCount();
+
+    /**
+     * @return false if read out of range happened
+     */
+    [[nodiscard]] bool IsValid() const;
+
+private:
+    const char* m_data{};
+    size_t m_size{};
+    size_t m_offset{};
+    bool m_failed = false;
+};
+
+/**
+ * cooked file of an xml asset(`foo.prefab.xml` -> `foo.prefab.bin`), mapped
+ * into memory
+ */
+class CookedAssetFile {
+public:
+    static constexpr std::array<char, 4> Magic = {'T', 'L', 'C', 'K'};
+    static constexpr uint32_t Version = 2;
+
+    static Path GetCookedPath(const Path& filename);
+
+    /**
+     * open cooked file of xml asset
+     * @return nullptr if not cooked, or xml file changed after cooking or is
+     * cooked with other schemas. Cooked file is used if xml file not exists
+     */
+    static std::unique_ptr<CookedAssetFile> Open(const Path& filename);
+
+    /**
+     * @return hash of xml file content, nullopt if file not exists
+     */
+    static std::optional<uint64_t> HashSource(const Path& filename);
+
+    static void WriteHeader(BinaryWriter&, uint64_t source_hash);
+
+    /**
+     * @return reader positioned after header
+     */
+    BinaryReader CreateReader() const;
+
+    const Path& GetFilename() const;
+
+private:
+    std::unique_ptr<MappedFile> m_file;
+    Path m_filename;
+
+    CookedAssetFile() = default;
+};
+
+// integral & floating
+template <typename T>
+std::enable_if_t<std::is_arithmetic_v<T>> SerializeBinary(CommonContext&,
+                                                          BinaryWriter& writer,
+                                                          const T& payload) {
+    writer.Write(payload);
+}
+
+template <typename T>
+std::enable_if_t<std::is_arithmetic_v<T>> DeserializeBinary(
+    CommonContext&, BinaryReader& reader, T& payload) {
+    reader.Read(payload);
+}
+
+// enum(also Entity & std::byte)
+template <typename T>
+std::enable_if_t<std::is_enum_v<T>> SerializeBinary(CommonContext&,
+                                                    BinaryWriter& writer,
+                                                    const T& payload) {
+    writer.Write(static_cast<std::underlying_type_t<T>>(payload));
+}
+
+template <typename T>
+std::enable_if_t<std::is_enum_v<T>> DeserializeBinary(CommonContext&,
+                                                      BinaryReader& reader,
+                                                      T& payload) {
+    std::underlying_type_t<T> value{};
+    reader.Read(value);
+    payload = static_cast<T>(value);
+}
+
+// Path
+void SerializeBinary(CommonContext&, BinaryWriter&, const Path& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Path& payload);
+
+// std::string
+void SerializeBinary(CommonContext&, BinaryWriter&, const std::string& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, std::string& payload);
+
+// UUID
+void SerializeBinary(CommonContext&, BinaryWriter&, const UUIDv4& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, UUIDv4& payload);
+
+// region
+void SerializeBinary(CommonContext&, BinaryWriter&, const Region& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Region& payload);
+
+// Degrees
+void SerializeBinary(CommonContext&, BinaryWriter&, const Degrees& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Degrees& payload);
+
+// Radians
+void SerializeBinary(CommonContext&, BinaryWriter&, const Radians& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Radians& payload);
+
+// transform
+void SerializeBinary(CommonContext&, BinaryWriter&, const Transform& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Transform& payload);
+
+// Color
+void SerializeBinary(CommonContext&, BinaryWriter&, const Color& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Color& payload);
+
+// collision group
+void SerializeBinary(CommonContext&, BinaryWriter&,
+                     const CollisionGroup& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, CollisionGroup& payload);
+
+// Animation
+void SerializeBinary(CommonContext&, BinaryWriter&, const Animation& payload);
+void DeserializeBinary(CommonContext&, BinaryReader&, Animation& payload);
+
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const TVec2<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, TVec2<T>&);
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const Flags<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, Flags<T>&);
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const std::optional<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, std::optional<T>&);
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const std::vector<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, std::vector<T>&);
+template <typename T, size_t Size>
+void SerializeBinary(CommonContext&, BinaryWriter&,
+                     const std::array<T, Size>&);
+template <typename T, size_t Size>
+void DeserializeBinary(CommonContext&, BinaryReader&, std::array<T, Size>&);
+template <typename Key, typename Value>
+void SerializeBinary(CommonContext&, BinaryWriter&,
+                     const std::unordered_map<Key, Value>&);
+template <typename Key, typename Value>
+void DeserializeBinary(CommonContext&, BinaryReader&,
+                       std::unordered_map<Key, Value>&);
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const AssetLoadResult<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, AssetLoadResult<T>&);
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const KeyFrame<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, KeyFrame<T>&);
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter&, const Handle<T>&);
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader&, Handle<T>&);
+
+// TVec2
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const TVec2<T>& payload) {
+    writer.Write(payload.x);
+    writer.Write(payload.y);
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       TVec2<T>& payload) {
+    reader.Read(payload.x);
+    reader.Read(payload.y);
+}
+
+// Flags
+template <typename T>
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const Flags<T>& payload) {
+    writer.Write(payload.Value());
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       Flags<T>& payload) {
+    std::underlying_type_t<T> value{};
+    reader.Read(value);
+    payload = value;
+}
+
+// optional
+template <typename T>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const std::optional<T>& payload) {
+    writer.Write<uint8_t>(payload.has_value());
+    if (payload) {
+        SerializeBinary(ctx, writer, payload.value());
+    }
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       std::optional<T>& payload) {
+    uint8_t has_value = 0;
+    reader.Read(has_value);
+    if (!has_value) {
+        payload = std::nullopt;
+        return;
+    }
+
+    T value;
+    DeserializeBinary(ctx, reader, value);
+    payload.emplace(std::move(value));
+}
+
+// vector
+template <typename T>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const std::vector<T>& payload) {
+    writer.Write(static_cast<uint32_t>(payload.size()));
+    for (auto& elem : payload) {
+        SerializeBinary(ctx, writer, elem);
+    }
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       std::vector<T>& payload) {
+    uint32_t count = reader.ReadCount();
+    payload.reserve(payload.size() + count);
+    for (uint32_t i = 0; i < count; i++) {
+        T new_value;
+        DeserializeBinary(ctx, reader, new_value);
+        payload.emplace_back(std::move(new_value));
+    }
+}
+
+// array
+template <typename T, size_t Size>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const std::array<T, Size>& payload) {
+    for (auto& elem : payload) {
+        SerializeBinary(ctx, writer, elem);
+    }
+}
+
+template <typename T, size_t Size>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       std::array<T, Size>& payload) {
+    for (auto& elem : payload) {
+        DeserializeBinary(ctx, reader, elem);
+    }
+}
+
+// unordered_map
+template <typename Key, typename Value>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const std::unordered_map<Key, Value>& payload) {
+    writer.Write(static_cast<uint32_t>(payload.size()));
+    for (auto&& [key, value] : payload) {
+        SerializeBinary(ctx, writer, key);
+        SerializeBinary(ctx, writer, value);
+    }
+}
+
+template <typename Key, typename Value>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       std::unordered_map<Key, Value>& payload) {
+    uint32_t count = reader.ReadCount();
+    payload.reserve(payload.size() + count);
+    for (uint32_t i = 0; i < count; i++) {
+        Key key;
+        Value value;
+        DeserializeBinary(ctx, reader, key);
+        DeserializeBinary(ctx, reader, value);
+        payload.emplace(std::move(key), std::move(value));
+    }
+}
+
+// AssetLoadResult
+template <typename T>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const AssetLoadResult<T>& payload) {
+    SerializeBinary(ctx, writer, payload.m_uuid);
+    SerializeBinary(ctx, writer, *payload.m_payload);
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       AssetLoadResult<T>& payload) {
+    DeserializeBinary(ctx, reader, payload.m_uuid);
+    payload.m_payload = std::make_unique<T>();
+    DeserializeBinary(ctx, reader, *payload.m_payload);
+}
+
+// Keyframe
+template <typename T>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const KeyFrame<T>& payload) {
+    SerializeBinary(ctx, writer, payload.m_time);
+    SerializeBinary(ctx, writer, payload.m_value);
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       KeyFrame<T>& payload) {
+    DeserializeBinary(ctx, reader, payload.m_time);
+    DeserializeBinary(ctx, reader, payload.m_value);
+}
+
+// Handle<T>
+enum class BinaryHandleTag : uint8_t {
+    Null,
+    External,
+    Embed,
+};
+
+template <typename T>
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const Handle<T>& payload) {
+    if (!payload) {
+        writer.Write(BinaryHandleTag::Null);
+        return;
+    }
+
+    if constexpr (AssetSLInfo<T>::CanEmbed) {
+        if (payload.IsEmbed()) {
+            writer.Write(BinaryHandleTag::Embed);
+            SerializeBinary(ctx, writer, payload.GetUUID());
+            SerializeBinary(ctx, writer, *payload);
+            return;
+        }
+    }
+
+    auto filename = payload.GetFilename();
+    if (!filename) {
+        writer.Write(BinaryHandleTag::Null);
+        return;
+    }
+    writer.Write(BinaryHandleTag::External);
+    SerializeBinary(ctx, writer, *filename);
+}
+
+template <typename T>
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       Handle<T>& payload) {
+    auto& manager = static_cast<AssetManagerBase<T>&>(
+        COMMON_CONTEXT.m_assets_manager->GetManager<T>());
+
+    BinaryHandleTag tag = BinaryHandleTag::Null;
+    reader.Read(tag);
+    if (tag == BinaryHandleTag::Embed) {
+        if constexpr (AssetSLInfo<T>::CanEmbed) {
+            AssetLoadResult<T> result;
+            DeserializeBinary(ctx, reader, result);
+            payload = manager.Create(result.m_uuid, std::move(result.m_payload),
+                                     nullptr);
+        } else {
+            LOGE("[Asset]: asset {} can't embed",
+                 AssetInfoManager::GetName<T>());
+        }
+        return;
+    }
+
+    if (tag == BinaryHandleTag::External) {
+        Path filename;
+        DeserializeBinary(ctx, reader, filename);
+        payload = manager.Find(filename);
+        if (!payload) {
+            payload = manager.Load(filename);
+        }
+    }
+}
+
+template <typename T>
+AssetLoadResult<T> LoadCookedAsset(const CookedAssetFile& file) {
+    auto reader = file.CreateReader();
+    AssetLoadResult<T> result;
+    DeserializeBinary(COMMON_CONTEXT, reader, result);
+    if (!reader.IsValid()) {
+        LOGW("cooked asset {} is corrupted", file.GetFilename());
+        return {};
+    }
+    return result;
+}
+
+/**
+ * save cooked file of xml asset `filename`
+ */
+template <typename T>
+bool SaveCookedAsset(const UUIDv4& uuid, const T& payload,
+                     const Path& filename) {
+    auto source_hash = CookedAssetFile::HashSource(filename);
+    TL_RETURN_FALSE_IF_FALSE(source_hash);
+
+    BinaryWriter writer;
+    CookedAssetFile::WriteHeader(writer, source_hash.value());
+    SerializeBinary(COMMON_CONTEXT, writer, uuid);
+    SerializeBinary(COMMON_CONTEXT, writer, payload);
+    return writer.SaveToFile(CookedAssetFile::GetCookedPath(filename));
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "common/entity.hpp"
+#include "common/entity_registry.hpp"
 #include "common/math.hpp"
 #include "common/path.hpp"
 #include "net/sync.hpp"
@@ -17,6 +18,7 @@ class TransformManager;
 class IAssetsManager;
 class Scene;
 class ScriptComponentManager;
+class ScriptCoroutineScheduler;
 class Script;
 class Renderer;
 class PhysicsScene;
@@ -28,6 +30,7 @@ class EventDebugger;
 class UDPHost;
 class EntityNameManager;
 class ReplicateComponentManager;
+class WorkerPool;
 
 class CommonContext {
 public:
@@ -71,6 +74,13 @@ public:
 
     Entity CreateEntity();
 
+    /**
+     * remove all components on entity, then recycle it
+     */
+    void DestroyEntity(Entity);
+
+    [[nodiscard]] bool IsEntityAlive(Entity) const;
+
     const CommonConfig& GetCommonConfig() const;
 
     [[nodiscard]] bool ShouldExit() const;
@@ -79,6 +89,7 @@ public:
     [[nodiscard]] const std::vector<std::string_view>& GetOSArgs() const;
     [[nodiscard]] std::string_view GetAppPath() const;
 
+    std::unique_ptr<WorkerPool> m_worker_pool;
     std::unique_ptr<EventSystem> m_event_system;
     std::unique_ptr<EventDebugger> m_event_debugger_system;
     std::unique_ptr<IAssetsManager> m_assets_manager;
@@ -96,6 +107,7 @@ public:
         m_tilemap_layer_collision_component_manager;
     std::unique_ptr<ScriptBinaryDataManager> m_script_binary_data_manager;
     std::unique_ptr<ScriptComponentManager> m_script_component_manager;
+    std::unique_ptr<ScriptCoroutineScheduler> m_script_coroutine_scheduler;
     // Global script: created at startup, not attached to any entity, ticked at
     // the start of every frame and kept alive across scene switches.
     std::unique_ptr<Script> m_global_script;
@@ -115,7 +127,7 @@ private:
 
     bool m_should_exit = true;
     bool m_is_inited = false;
-    std::underlying_type_t<Entity> m_last_entity = 1;
+    EntityRegistry m_entity_registry;
 
     CommonConfig m_common_config;
 };
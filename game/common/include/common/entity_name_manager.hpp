@@ -3,19 +3,62 @@
 #include "common/entity.hpp"
 #include "common/manager.hpp"
 
+#include <cstdint>
+#include <unordered_map>
+
+using EntityNameID = uint32_t;
+
 struct EntityName {
     EntityName() = default;
     explicit EntityName(const std::string& name);
     std::string m_name;
+
+    // interned by EntityNameManager, don't change `m_name` directly
+    EntityNameID m_name_id{};
 };
 
+/**
+ * names are interned into ids at registration, and entities are indexed by
+ * name id, so finding by name only visits entities with that name
+ */
 class EntityNameManager: public ComponentManager<EntityName> {
 public:
+    void RegisterEntity(Entity entity, const std::string& name);
+    void RemoveEntity(Entity entity) override;
+    void Rename(Entity entity, const std::string& name);
+
+    /**
+     * @return first descendant named `name` in depth-first(pre-order) order
+     */
     Entity FindChildByName(Entity entity, const std::string& name);
+
+    /**
+     * @return descendants named `name` in depth-first(pre-order) order
+     */
     std::vector<Entity> FindChildrenByName(Entity entity, const std::string& name);
 
 private:
-    void findChildByName(Entity entity, const std::string& name, Entity& result);
-    void findChildrenByName(Entity entity, const std::string& name, std::vector<Entity>& result);
-};
+    std::unordered_map<std::string, EntityNameID> m_name_ids;
+    std::unordered_map<EntityNameID, std::vector<Entity>> m_name_index;
+    EntityNameID m_next_name_id = 0;
+
+    EntityNameID internName(const std::string& name);
+    const std::vector<Entity>* findNamedEntities(const std::string& name) const;
+
+    // drop interned name when no entity uses it
+    void removeFromIndex(Entity entity, const EntityName& component);
 
+    /**
+     * walk up parents only, no sibling scan
+     */
+    bool isDescendant(Entity entity, Entity ancestor) const;
+
+    /**
+     * child indices from `ancestor` down to `entity`, comparing them
+     * lexicographically gives depth-first order. Scans siblings on each
+     * level, so only call it on matched descendants
+     * @return false if `entity` is not descendant of `ancestor`
+     */
+    bool getDescendantPath(Entity entity, Entity ancestor,
+                           std::vector<size_t>& out_path) const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "common/entity.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * Entity packs index(low bits) and generation(high bits). Destroyed indices
+ * are recycled with bumped generation, so stale entities are detected by
+ * `IsAlive`, and indices stay in a dense range
+ */
+class EntityRegistry {
+public:
+    static constexpr uint32_t IndexBits = 20;
+    static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+    // keep packed entity below 2^31, Lua binds entity as 32-bit signed integer
+    static constexpr uint32_t MaxGeneration = (1u << (31 - IndexBits)) - 1;
+
+    // recycle index only when enough indices freed, so same index won't be
+    // reused soon after destroyed
+    static constexpr size_t MinFreeIndices = 1024;
+
+    static uint32_t GetIndex(Entity);
+    static uint32_t GetGeneration(Entity);
+
+    EntityRegistry();
+
+    Entity Create();
+    void Destroy(Entity);
+    [[nodiscard]] bool IsAlive(Entity) const;
+
+    /**
+     * indices of alive entities are all in [1, GetIndexRange()), array based
+     * component storage can index by `GetIndex(entity)` directly
+     */
+    [[nodiscard]] uint32_t GetIndexRange() const;
+    [[nodiscard]] uint32_t GetAliveCount() const;
+
+private:
+    struct Slot {
+        uint32_t m_generation = 0;
+        bool m_alive = false;
+    };
+
+    // indexed by entity index, index 0 is reserved for null_entity
+    std::vector<Slot> m_slots;
+    std::deque<uint32_t> m_free_indices;
+    uint32_t m_alive_count = 0;
+};
@@ -1,11 +1,14 @@
 #pragma once
 #include "SDL3/SDL.h"
 #include "common/log.hpp"
+#include "common/macros.hpp"
 #include "common/type_index.hpp"
 
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 
 enum class EventListenerID : uint32_t {};
 
@@ -32,6 +35,40 @@ constexpr NullEventListenerID null_event_listener_id;
 template <typename T>
 using EventListener = std::function<void(EventListenerID, const T&)>;
 
+using EventRouteKeyType = uint32_t;
+
+/**
+ * specialize it(with `Get(const T&) -> EventRouteKeyType`) to make event
+ * routable. Listeners added with a route key only receive events whose key
+ * matches, so producers don't have to wake up every listener
+ */
+template <typename T>
+struct EventRouteKey {
+    static constexpr bool routable = false;
+};
+
+template <typename T, typename = void>
+struct is_routable_event : std::false_type {};
+
+template <typename T>
+struct is_routable_event<T, std::enable_if_t<EventRouteKey<T>::routable>>
+    : std::true_type {};
+
+template <typename T>
+constexpr bool is_routable_event_v = is_routable_event<T>::value;
+
+/**
+ * routable event can also provide `IsRoutedOnly(const T&) -> bool`, matched
+ * events are only dispatched to listeners with route key
+ */
+template <typename T, typename = void>
+struct has_routed_only_filter : std::false_type {};
+
+template <typename T>
+struct has_routed_only_filter<
+    T, std::void_t<decltype(EventRouteKey<T>::IsRoutedOnly(
+           std::declval<const T&>()))>> : std::true_type {};
+
 class EventSinkBase {
 public:
     virtual ~EventSinkBase() = default;
@@ -47,7 +84,16 @@ public:
     using Event = T;
 
     void AddListener(EventListenerID id, const EventListenerType& listener) {
-        m_pending_add_listeners.emplace_back(EventListenerInfo{id, listener});
+        m_pending_add_listeners.emplace_back(
+            EventListenerInfo{id, listener, std::nullopt});
+    }
+
+    void AddListener(EventListenerID id, EventRouteKeyType key,
+                     const EventListenerType& listener) {
+        static_assert(is_routable_event_v<T>,
+                      "event type don't have EventRouteKey specialization");
+        m_pending_add_listeners.emplace_back(
+            EventListenerInfo{id, listener, key});
     }
 
     void RemoveListener(EventListenerID id) {
@@ -56,36 +102,54 @@ public:
 
     void ClearEvents() override { m_enqueued_events.clear(); }
 
-    void ClearListener() override { m_listener.clear(); }
-
-    void EnqueueEvent(const T& event) { m_enqueued_events.push_back(event); }
+    void ClearListener() override {
+        m_listener.clear();
+        m_routed_listeners.clear();
+        m_routed_listener_keys.clear();
+    }
 
-    void TriggerEvent(const T& event) {
-        for (auto& listener : m_listener) {
-            listener.m_listener(listener.m_id, event);
+    /**
+     * whether someone may receive this event(pending listeners included)
+     */
+    bool HasListener(const T& event) const {
+        if (!m_listener.empty() || !m_pending_add_listeners.empty()) {
+            return true;
+        }
+        if constexpr (is_routable_event_v<T>) {
+            return m_routed_listeners.find(EventRouteKey<T>::Get(event)) !=
+                   m_routed_listeners.end();
+        } else {
+            return false;
         }
     }
 
+    void EnqueueEvent(const T& event) {
+        // fast path: drop events nobody listens to
+        TL_RETURN_IF_FALSE(HasListener(event));
+        m_enqueued_events.push_back(event);
+    }
+
+    void TriggerEvent(const T& event) { dispatch(event); }
+
     void Update() override {
-        m_listener.insert(
-            m_listener.end(),
-            std::make_move_iterator(m_pending_add_listeners.begin()),
-            std::make_move_iterator(m_pending_add_listeners.end()));
+        for (auto& info : m_pending_add_listeners) {
+            if (info.m_key) {
+                m_routed_listener_keys[info.m_id] = info.m_key.value();
+                m_routed_listeners[info.m_key.value()].push_back(
+                    std::move(info));
+            } else {
+                m_listener.push_back(std::move(info));
+            }
+        }
         m_pending_add_listeners.clear();
 
         for (auto id : m_pending_delete_listeners) {
-            m_listener.erase(
-                std::remove_if(
-                    std::begin(m_listener), std::end(m_listener),
-                    [id](const EventListenerInfo& e) { return e.m_id == id; }),
-                m_listener.end());
+            removeListener(id);
         }
         m_pending_delete_listeners.clear();
 
         for (auto& event : m_enqueued_events) {
-            for (auto& listener : m_listener) {
-                listener.m_listener(listener.m_id, event);
-            }
+            dispatch(event);
         }
         ClearEvents();
     }
@@ -94,13 +158,64 @@ private:
     struct EventListenerInfo {
         EventListenerID m_id;
         EventListenerType m_listener;
+        std::optional<EventRouteKeyType> m_key;
     };
 
     std::vector<T> m_enqueued_events;
     std::vector<EventListenerInfo> m_listener;
+    std::unordered_map<EventRouteKeyType, std::vector<EventListenerInfo>>
+        m_routed_listeners;
+    std::unordered_map<EventListenerID, EventRouteKeyType>
+        m_routed_listener_keys;
 
     std::vector<EventListenerID> m_pending_delete_listeners;
     std::vector<EventListenerInfo> m_pending_add_listeners;
+
+    void dispatch(const T& event) {
+        bool routed_only = false;
+        if constexpr (has_routed_only_filter<T>::value) {
+            routed_only = EventRouteKey<T>::IsRoutedOnly(event);
+        }
+
+        if (!routed_only) {
+            for (auto& listener : m_listener) {
+                listener.m_listener(listener.m_id, event);
+            }
+        }
+
+        if constexpr (is_routable_event_v<T>) {
+            auto it = m_routed_listeners.find(EventRouteKey<T>::Get(event));
+            TL_RETURN_IF_TRUE(it == m_routed_listeners.end());
+            for (auto& listener : it->second) {
+                listener.m_listener(listener.m_id, event);
+            }
+        }
+    }
+
+    void removeListener(EventListenerID id) {
+        auto remove_from = [id](std::vector<EventListenerInfo>& listeners) {
+            listeners.erase(
+                std::remove_if(
+                    std::begin(listeners), std::end(listeners),
+                    [id](const EventListenerInfo& e) { return e.m_id == id; }),
+                listeners.end());
+        };
+
+        auto key_it = m_routed_listener_keys.find(id);
+        if (key_it == m_routed_listener_keys.end()) {
+            remove_from(m_listener);
+            return;
+        }
+
+        if (auto it = m_routed_listeners.find(key_it->second);
+            it != m_routed_listeners.end()) {
+            remove_from(it->second);
+            if (it->second.empty()) {
+                m_routed_listeners.erase(it);
+            }
+        }
+        m_routed_listener_keys.erase(key_it);
+    }
 };
 
 class EventSystem {
@@ -115,6 +230,21 @@ public:
         return {};
     }
 
+    /**
+     * add listener which only receives events routed to `key`(see
+     * `EventRouteKey`)
+     */
+    template <typename T>
+    EventListenerID AddListener(EventRouteKeyType key,
+                                const EventListener<T>& listener) {
+        if (auto sink = ensureSink<T>()) {
+            auto id = static_cast<EventListenerID>(m_cur_id++);
+            sink->AddListener(id, key, listener);
+            return id;
+        }
+        return {};
+    }
+
     template <typename T>
     void RemoveListener(EventListenerID id) {
         if (auto sink = ensureSink<T>()) {
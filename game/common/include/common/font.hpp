@@ -2,8 +2,28 @@
 #include "SDL3_ttf/SDL_ttf.h"
 #include "common/asset_manager_interface.hpp"
 #include "common/handle.hpp"
+#include "common/image.hpp"
 #include "common/math.hpp"
 #include "common/path.hpp"
+#include "common/utf8_string.hpp"
+
+#include <vector>
+
+struct TextGlyph {
+    char32_t m_codepoint{};
+    Vec2 m_position;  // relative to text topleft
+};
+
+/**
+ * laid out glyphs of one line text. Glyph images are looked up from font by
+ * codepoint when drawing, so layout stays valid after font reloaded or moved
+ */
+struct TextLayout {
+    std::vector<TextGlyph> m_glyphs;  // whitespaces have no glyph
+    std::vector<float> m_pen_x;       // x before each codepoint & at the end
+    Vec2 m_size;
+    int m_pt{};
+};
 
 class FontBase {
 public:
@@ -12,6 +32,16 @@ public:
     virtual bool IsValid() const noexcept = 0;
     virtual SDL_Surface* GenerateText(const std::string& text,
                                       const Color& color) const = 0;
+
+    /**
+     * layout text by cached glyphs, glyphs are white so tint it when drawing
+     */
+    virtual TextLayout LayoutText(const UTF8String& text, int pt) = 0;
+
+    /**
+     * @return null if codepoint has no visible glyph
+     */
+    virtual const ImageBase* GetGlyphImage(char32_t cp, int pt) = 0;
     virtual int GetHeight() const = 0;
     virtual void SetFontSize(int) = 0;
 };
@@ -42,6 +42,13 @@ public:
         return m_manager ? m_manager->GetFilename(m_uuid) : nullptr;
     }
 
+    /**
+     * whether it's a handle returned by `LoadAsync` and asset is still loading
+     */
+    bool IsPending() const {
+        return !m_data && m_manager && m_manager->IsPending(m_uuid);
+    }
+
     bool IsEmbed() const {
         return static_cast<bool>(*this) && GetFilename() == nullptr;
     }
@@ -11,6 +11,15 @@ public:
 
     virtual Vec2 GetSize() const = 0;
     [[nodiscard]] virtual SDL_Texture* GetTexture() const = 0;
+
+    /**
+     * region of this image in `GetTexture()`, not the whole texture when
+     * image is packed in atlas
+     */
+    [[nodiscard]] virtual Region GetTextureRegion() const {
+        return {Vec2::ZERO, GetSize()};
+    }
+
     virtual void ChangeColorMask(const Color&) = 0;
 };
 
@@ -59,7 +59,7 @@ public:
         }
     }
 
-    void RemoveEntity(Entity entity) { m_components.erase(entity); }
+    virtual void RemoveEntity(Entity entity) { m_components.erase(entity); }
 
     void ReplaceComponent(Entity entity, T&& component) {
         this->doReplaceComponent(entity, std::move(component));
@@ -2,6 +2,7 @@
 #include "spdlog/fmt/ostr.h"
 #include "spdlog/spdlog.h"
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 template <typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
@@ -375,6 +376,9 @@ struct Mat33 {
 
     Mat33 &operator*=(const Mat33 &);
 
+    bool operator==(const Mat33 &) const;
+    bool operator!=(const Mat33 &) const;
+
 private:
     float m_data[3][3] = {0};
 };
@@ -572,6 +576,12 @@ struct Transform {
 
     void UpdateMat(const Transform *parent);
 
+    /**
+     * bumped by `UpdateMat` when global matrix changed. Starts from 1, so
+     * caching 0 means "never synced"
+     */
+    uint32_t GetVersion() const;
+
     bool operator==(const Transform &o) const noexcept {
         return m_position == o.m_position && m_rotation == o.m_rotation &&
                m_size == o.m_size;
@@ -582,6 +592,7 @@ struct Transform {
 private:
     Mat33 m_mat;
     Mat33 m_global_mat;
+    uint32_t m_version = 1;
 };
 
 /**
@@ -3,9 +3,11 @@
 #include "common/entity.hpp"
 #include "common/flag.hpp"
 #include "common/math.hpp"
+#include "common/physics_stats.hpp"
 #include "schema/common.hpp"
 #include "schema/physics_schema.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -41,12 +43,27 @@ struct HitResult {
 
 struct SweepResult : HitResult {
     Entity m_entity = null_entity;
-    PhysicsShape *m_shape = nullptr;
+    PhysicsShape *m_shape = nullptr;  // nullptr if hit tile in tile grid
 };
 
 struct OverlapResult {
     Entity m_dst_entity = null_entity;
+    PhysicsShape *m_dst_shape = nullptr;  // nullptr if overlap tile grid
+};
+
+enum class ContactState {
+    Begin,
+    Persist,
+    End,
+};
+
+struct Contact {
+    PhysicsShape *m_src_shape = nullptr;
+
+    // only used as key when `m_is_dst_removed` is true
     PhysicsShape *m_dst_shape = nullptr;
+    Entity m_dst_entity = null_entity;
+    bool m_is_dst_removed = false;
 };
 
 Rect RectUnion(const Rect &r1, const Rect &r2);
@@ -140,9 +157,12 @@ public:
     Entity GetOwner() const;
 
 private:
+    friend class PhysicsScene;
+
     Entity m_owner = null_entity;
     Type m_type = Type::Unknown;
     bool m_enable_query = true;
+    uint32_t m_query_id = 0;  // last query tested it, see `PhysicsScene`
     PhysicsStorageType m_storage_type;
     CollisionGroup m_collision_layer;
     CollisionGroup m_collision_mask;
@@ -155,7 +175,11 @@ private:
 
 class PhysicsScene {
 public:
-    using Chunk = MatStorage<std::vector<PhysicsShape *> >;
+    /**
+     * shapes overlapping the chunk, a shape across chunks is in each of them
+     * and tested once per query
+     */
+    using Chunk = std::vector<PhysicsShape *>;
 
     struct Chunks {
         Vec2UI m_tile_extent{};   // tile width and height
@@ -174,12 +198,32 @@ public:
 
         void getOverlapChunkRange(const Rect &bounding_box,
                                   const Vec2 &topleft,
-                                  Range2D<int> &out_chunk_range,
-                                  Range2D<int> &out_tile_range);
+                                  Range2D<int> &out_chunk_range);
+    };
+
+    /**
+     * packed collision of grid aligned tiles, no PhysicsShape is created for
+     * them. Each chunk stores an occupancy bitmap and per-tile index into
+     * unique tile rects
+     */
+    struct TileGrid {
+        struct Chunk {
+            std::vector<uint64_t> m_occupancy;     // 1 bit per tile
+            std::vector<uint16_t> m_rect_indices;  // index of m_tile_rects
+        };
 
-        void getTileRangeInCurrentChunk(const Range2D<int> &chunk_range,
-                                        const Range2D<int> &tile_range, int x,
-                                        int y, Range2D<int> &out_tile_range);
+        Entity m_owner = null_entity;
+        CollisionGroup m_collision_layer;
+        CollisionGroup m_collision_mask;
+
+        std::vector<Rect> m_tile_rects;  // relative to tile topleft
+        MatStorage<Chunk> m_chunks;
+
+        /**
+         * @return tile rect relative to tile topleft, nullptr if no tile
+         */
+        [[nodiscard]] const Rect *GetTileRect(const Vec2UI &chunk_extent,
+                                              int x, int y) const;
     };
 
     struct TilemapCollision {
@@ -207,11 +251,34 @@ public:
 
         Chunks m_chunks;
         std::vector<std::unique_ptr<PhysicsShape> > m_physics_shapes;
+        TileGrid m_grid;
 
     private:
         Vec2 m_topleft;
     };
 
+    struct RaycastInfo {
+        Vec2 m_origin;
+        Vec2 m_dir;  // normalized
+        float m_dist{};
+        CollisionGroup m_collision_mask;
+        Entity m_ignore_entity = null_entity;  // usually the caster itself
+    };
+
+    struct ShapeCastInfo {
+        const PhysicsShape *m_shape = nullptr;
+        Vec2 m_dir;  // normalized
+        float m_dist{};
+    };
+
+    struct ContactRange {
+        const Contact *m_begin = nullptr;
+        const Contact *m_end = nullptr;
+
+        const Contact *begin() const { return m_begin; }
+        const Contact *end() const { return m_end; }
+    };
+
     PhysicsScene();
 
     PhysicsShape *CreateShapeInChunk(Entity,
@@ -225,6 +292,15 @@ public:
                                              const Vec2UI &tile_size,
                                              const Vec2UI &chunk_size);
 
+    /**
+     * add a grid aligned tile into tile grid of tilemap collision, queries
+     * traverse it along sweep direction
+     * @param tile tile coordinate in tilemap
+     * @param rect collision rect relative to tile topleft, must be inside
+     * tile
+     */
+    void AddGridTile(TilemapCollision *, const Vec2UI &tile, const Rect &rect);
+
     PhysicsShape *CreateShape(Entity, PhysicsShapeDefinitionHandle);
 
     void RemoveTilemapCollision(TilemapCollision *);
@@ -233,30 +309,133 @@ public:
 
     /*
      * @param dir is normalized vector
+     * @param ignore_entity shapes owned by it are skipped
      */
     uint32_t Sweep(const PhysicsShape &, const Vec2 &dir, float dist,
-                   SweepResult *out_result, size_t out_size);
+                   SweepResult *out_result, size_t out_size,
+                   Entity ignore_entity = null_entity);
 
     uint32_t Overlap(const PhysicsShape &, OverlapResult *out_result,
                      size_t out_size);
 
+    /**
+     * @return nearest hit of ray
+     */
+    std::optional<SweepResult> Raycast(const RaycastInfo &);
+
+    /**
+     * @return hit count, hits are sorted by distance
+     */
+    uint32_t RaycastAll(const RaycastInfo &, SweepResult *out_result,
+                        size_t out_size);
+
+    /**
+     * nearest hit of each ray, `out_results[i]` is empty if `rays[i]` hits
+     * nothing
+     * @return hit count
+     */
+    uint32_t RaycastBatch(const RaycastInfo *rays, size_t count,
+                          std::optional<SweepResult> *out_results);
+
+    /**
+     * nearest hit of each cast, `out_results[i]` is empty if `casts[i]` hits
+     * nothing
+     * @return hit count
+     */
+    uint32_t ShapeCastBatch(const ShapeCastInfo *casts, size_t count,
+                            std::optional<SweepResult> *out_results);
+
     [[nodiscard]] bool Overlap(const PhysicsShape &,
                                const PhysicsShape &) const;
 
+    /**
+     * track overlapping pairs of shape in `UpdateContacts`. Tracking stops
+     * when shape removed
+     */
+    void EnableContactTracking(PhysicsShape *);
+
+    /**
+     * update overlapping pair cache of tracked shapes, and generate
+     * begin/persist/end contacts of this step. Contacts of query disabled
+     * shapes are kept unchanged and not reported
+     */
+    void UpdateContacts();
+
+    /**
+     * @return contacts of tracked shape generated by last `UpdateContacts`
+     */
+    [[nodiscard]] ContactRange GetContacts(const PhysicsShape &,
+                                           ContactState) const;
+
+    /**
+     * hash of all shapes' position & size bits, to compare physics state
+     * between client and server (build with TL_DETERMINISTIC_PHYSICS)
+     */
+    [[nodiscard]] uint64_t ComputeStateHash() const;
+
     [[nodiscard]] bool IsEnableDebugDraw() const;
 
     void ToggleDebugDraw() { m_should_debug_draw = !m_should_debug_draw; }
 
     void RenderDebug() const;
 
+    /**
+     * publish query stats of this frame(tracy plots, or periodic log when log
+     * interval is set), then reset them. Call once per frame
+     */
+    void UpdateStats(TimeType elapse);
+
+    /**
+     * log average query stats every `interval` seconds, 0 to disable
+     */
+    void SetStatsLogInterval(TimeType interval);
+
+    [[nodiscard]] const PhysicsStats &GetLastFrameStats() const;
+
+    // show last frame stats in imgui window
+    void RenderStatsPanel() const;
+
 private:
     std::vector<std::unique_ptr<TilemapCollision> > m_tilemap_collisions;
 
     std::vector<std::unique_ptr<PhysicsShape> > m_shapes;  // shapes in chunk
     std::vector<SweepResult> m_cached_sweep_results;
     std::vector<OverlapResult> m_cached_overlaps_results;
+    std::vector<float> m_cached_nearest_hits;  // of `sweepTileGrid`
     bool m_should_debug_draw = false;
 
+    PhysicsStats m_stats;
+    PhysicsStats m_last_frame_stats;
+    PhysicsStats m_log_stats;
+    uint32_t m_log_frame_count = 0;
+    TimeType m_log_elapse = 0;
+
+    // id of running query, shapes stamped with it are already tested
+    uint32_t m_query_id = 0;
+    TimeType m_stats_log_interval = 0;
+
+    std::vector<PhysicsShape *> m_contact_tracked_shapes;
+    std::vector<Contact> m_contacts;  // sorted by src & dst shape
+    std::vector<Contact> m_cached_new_contacts;
+    std::vector<Contact> m_begin_contacts;
+    std::vector<Contact> m_persist_contacts;
+    std::vector<Contact> m_end_contacts;
+
+    // contacts with removed dst shape, report as end contact in next update
+    std::vector<Contact> m_removed_contacts;
+
+    // query all overlaps into `m_cached_overlaps_results`
+    void overlap(const PhysicsShape &);
+
+    void removeContacts(PhysicsShape *);
+
+    void beginQuery();
+
+    /**
+     * @return false if shape was already tested by running query
+     */
+    bool markQueried(PhysicsShape &);
+
     [[nodiscard]] Rect computeSweepBoundingBox(const Rect &, const Vec2 &dir,
                                                float dist) const;
 
@@ -283,8 +462,23 @@ private:
                                                          const PhysicsShape &,
                                                          const Vec2 &dir) const;
 
-    [[nodiscard]] bool checkNeedQuery(const PhysicsShape &src,
-                                      const PhysicsShape &target) const;
+    [[nodiscard]] std::optional<HitResult> sweepShape(const PhysicsShape &,
+                                                      const Rect &,
+                                                      const Vec2 &dir) const;
+
+    [[nodiscard]] bool checkNeedQuery(
+        const PhysicsShape &src, const PhysicsShape &target,
+        Entity ignore_entity = null_entity) const;
+
+    /**
+     * DDA traverse tiles along `dir`, tiles newly covered by moving shape are
+     * tested only once
+     */
+    void sweepTileGrid(const PhysicsShape &, const TilemapCollision &,
+                       const Vec2 &dir, float dist, size_t out_size,
+                       Entity ignore_entity);
+
+    void overlapTileGrid(const PhysicsShape &, const TilemapCollision &);
 
     void removeShapeInChunk(TilemapCollision *, PhysicsShape *actor);
 };
@@ -0,0 +1,51 @@
+#pragma once
+#include "common/timer.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+struct PhysicsQueryStats {
+    uint32_t m_query_count = 0;
+    uint32_t m_candidate_count = 0;  // shapes & tiles reached narrowphase
+    uint32_t m_hit_count = 0;
+    uint32_t m_cell_count = 0;  // chunk cells & grid tiles visited
+    TimeType m_time = 0;        // in seconds
+
+    PhysicsQueryStats& operator+=(const PhysicsQueryStats&);
+};
+
+/**
+ * counters of physics queries in one frame. Only collected when built with
+ * TL_ENABLE_PHYSICS_STATS(implied by TL_ENABLE_PROFILE)
+ */
+struct PhysicsStats {
+    PhysicsQueryStats m_sweep;  // raycasts & shape casts are sweeps
+    PhysicsQueryStats m_overlap;
+    PhysicsQueryStats m_contact;  // time includes its overlap queries
+
+    PhysicsStats& operator+=(const PhysicsStats&);
+};
+
+#ifdef TL_ENABLE_PHYSICS_STATS
+
+class PhysicsQueryTimer {
+public:
+    explicit PhysicsQueryTimer(PhysicsQueryStats& stats);
+    ~PhysicsQueryTimer();
+
+private:
+    PhysicsQueryStats& m_stats;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+#define PHYSICS_STAT_ADD(stats, field, n) ((stats).field += (n))
+#define PHYSICS_STAT_QUERY(stats) \
+    (stats).m_query_count++;      \
+    PhysicsQueryTimer _physics_query_timer{stats}
+
+#else
+
+#define PHYSICS_STAT_ADD(stats, field, n)
+#define PHYSICS_STAT_QUERY(stats)
+
+#endif
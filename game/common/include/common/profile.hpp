@@ -12,6 +12,8 @@
 #define PROFILE_SECION_NAMED(name) ZoneScopedN(name)
 #define PROFILE_SECTION_NAMED_COLORED(name, color) ZoneScopedNC(name, color)
 
+#define PROFILE_PLOT(name, value) TracyPlot(name, value)
+
 #else
 
 #define PROFILE_FRAME()
@@ -23,4 +25,6 @@
 #define PROFILE_SECION_NAMED(name)
 #define PROFILE_SECTION_NAMED_COLORED(name, color)
 
+#define PROFILE_PLOT(name, value)
+
 #endif
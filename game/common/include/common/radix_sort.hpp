@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * map float to uint32 which keeps order when compared as unsigned
+ */
+uint32_t FloatToSortableKey(float value);
+
+/**
+ * stable LSD radix sort by 64-bit keys, 8 bits per pass. Only indices are
+ * moved, passes whose byte is same for all keys are skipped
+ *
+ * @param indices output, `indices[i]` is the index in `keys` of i-th smallest
+ * key
+ * @param buffer scratch memory, keep it alive to avoid reallocation
+ */
+void RadixSortIndices(const std::vector<uint64_t>& keys,
+                      std::vector<uint32_t>& indices,
+                      std::vector<uint32_t>& buffer);
@@ -18,16 +18,32 @@ public:
     void RemoveChild(Entity);
     void RemoveFromParent();
 
+    /**
+     * bumped when children changed, for caching hierarchy
+     */
+    uint32_t GetVersion() const;
+
 private:
     Entity m_owner = null_entity;
     Entity m_parent = null_entity;
     std::vector<Entity> m_children;
+    uint32_t m_version = 0;
 };
 
 class RelationshipManager : public ComponentManager<Relationship> {
 public:
+    void RegisterEntity(Entity entity, Entity owner);
+    void RemoveEntity(Entity entity) override;
+
     void Update();
 
+    /**
+     * bumped when relationship registered or removed, for caching hierarchy
+     */
+    uint32_t GetVersion() const;
+
 private:
+    uint32_t m_version = 0;
+
     void updatePoseRecursive(const Transform& parent_transform, Entity child);
 };
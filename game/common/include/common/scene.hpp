@@ -65,15 +65,29 @@ using SceneHandle = Handle<Scene>;
 class SceneManager : public AssetManagerBase<Scene> {
 public:
     using AssetManagerBase<Scene>::Load;
+    using SwitchedCallback = std::function<void(SceneHandle)>;
     
     virtual SceneHandle Create(SceneDefinitionHandle) = 0;
 
+    /**
+     * switch immediately, cancels pending `SwitchAsync`
+     */
     virtual void Switch(SceneHandle);
 
+    /**
+     * load scene definition in background, then create scene from it and
+     * switch to it on main thread. Assets referred by the scene are loaded in
+     * background too. Only the latest request switches, older ones and ones
+     * followed by `Switch` are dropped when finished
+     * @param on_switched called after switched(empty handle if load failed)
+     */
+    void SwitchAsync(const Path& filename, SwitchedCallback on_switched = {});
+
     void PoseUpdate();
 
     SceneHandle GetCurrentScene() const;
 
 private:
     SceneHandle m_level;
+    uint32_t m_switch_version = 0;
 };
@@ -31,6 +31,31 @@ public:
         return eid;
     }
 
+    /**
+     * like `Add`, but callback is only called for events routed to
+     * `route_key`(trigger owner entity, timer id...)
+     */
+    template <typename T>
+    static EventListenerID AddRouted(EventRouteKeyType route_key,
+                                     luabridge::LuaRef cb) {
+        if (!s_es || !cb.isCallable()) {
+            return null_event_listener_id;
+        }
+
+        auto listener = [cb](EventListenerID id, const T& event) {
+            auto result = cb(static_cast<int>(id), event);
+            if (result.errorCode()) {
+                LOGE("[Lua] event callback error: {}", result.errorMessage());
+            }
+        };
+
+        EventListenerID eid = s_es->AddListener<T>(route_key, listener);
+        int key = static_cast<int>(eid);
+        s_callbacks.emplace(key, cb);
+        s_removers.emplace(key, [eid]() { s_es->RemoveListener<T>(eid); });
+        return eid;
+    }
+
     static void Remove(EventListenerID id);
     static void Clear();
 
@@ -47,3 +72,13 @@ private:
             return static_cast<int>(                                  \
                 LuaEventListenerRegistry::Add<EventType>(cb));        \
         })
+
+#define TL_BIND_LUA_ROUTED_EVENT_LISTENER(EventType, EventName, KeyType) \
+    .addFunction(                                                      \
+        "Add" EventName "For",                                         \
+        +[](EventSystem*, KeyType route_key,                           \
+            luabridge::LuaRef cb) -> int {                             \
+            return static_cast<int>(                                    \
+                LuaEventListenerRegistry::AddRouted<EventType>(         \
+                    static_cast<EventRouteKeyType>(route_key), cb));    \
+        })
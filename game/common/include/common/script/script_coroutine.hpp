@@ -0,0 +1,128 @@
+#pragma once
+
+#include "common/entity.hpp"
+#include "common/event.hpp"
+#include "common/timer.hpp"
+
+#include "common/script/luabridge_include.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class CoroutineID : uint32_t {};
+
+struct NullCoroutineID {
+    constexpr bool operator==(CoroutineID id) const {
+        return static_cast<uint32_t>(id) == 0;
+    }
+
+    constexpr bool operator!=(CoroutineID id) const { return !(*this == id); }
+
+    constexpr operator CoroutineID() const {
+        return static_cast<CoroutineID>(0);
+    }
+};
+
+constexpr NullCoroutineID null_coroutine_id;
+
+template <>
+struct luabridge::Stack<CoroutineID> : public luabridge::Enum<CoroutineID> {};
+
+/**
+ * Runs luau coroutines which yield on `TL_Common.Wait(seconds)`,
+ * `TL_Common.WaitFrames(n)` and `TL_Common.WaitForEvent(type, key)`.
+ *
+ * Waiting coroutines are parked on a timer / routed event listener / frame
+ * queue, and only resumed when ready, so idle coroutines cost nothing per
+ * frame.
+ */
+class ScriptCoroutineScheduler {
+public:
+    ScriptCoroutineScheduler() = default;
+    ScriptCoroutineScheduler(const ScriptCoroutineScheduler&) = delete;
+    ScriptCoroutineScheduler& operator=(const ScriptCoroutineScheduler&) =
+        delete;
+    ~ScriptCoroutineScheduler();
+
+    /**
+     * create coroutine from function then run it until first yield
+     * @param owner coroutine will be stopped when owner removed. Can be
+     * null_entity
+     */
+    CoroutineID Start(luabridge::LuaRef fn, Entity owner);
+
+    void Stop(CoroutineID);
+    void StopByOwner(Entity owner);
+    void Clear();
+
+    [[nodiscard]] bool IsAlive(CoroutineID) const;
+
+    /**
+     * resume coroutines waiting for frames
+     */
+    void Update();
+
+    /**
+     * bind `Wait`, `WaitFrames` & `WaitForEvent` into `TL_Common`
+     */
+    static void BindWaitFunctions(lua_State* L);
+
+private:
+    enum class WaitType {
+        None,
+        Time,
+        Frames,
+        Event,
+    };
+
+    struct Coroutine {
+        lua_State* m_thread{};
+        int m_thread_ref = LUA_NOREF;
+        Entity m_owner = null_entity;
+        bool m_is_running = false;
+        // stopped while running, destroy it after it yields/returns
+        bool m_pending_stop = false;
+
+        WaitType m_wait_type = WaitType::None;
+        // bumped when wait finished, to skip stale frame queue items
+        uint32_t m_wait_version = 0;
+        TimerID m_timer = null_timer_id;
+        EventListenerID m_listener = null_event_listener_id;
+        void (*m_listener_remover)(EventListenerID) = nullptr;
+    };
+
+    struct FrameWaitItem {
+        CoroutineID m_id;
+        uint32_t m_wait_version;
+    };
+
+    std::underlying_type_t<CoroutineID> m_cur_id = 0;
+    uint64_t m_frame = 0;
+    std::unordered_map<CoroutineID, Coroutine> m_coroutines;
+    std::unordered_map<lua_State*, CoroutineID> m_thread_to_coroutine;
+    std::unordered_map<Entity, std::vector<CoroutineID>> m_owner_coroutines;
+    std::multimap<uint64_t, FrameWaitItem> m_frame_waiting;
+
+    Coroutine* find(CoroutineID);
+    Coroutine* findByThread(lua_State*, CoroutineID& out_id);
+
+    void resume(CoroutineID, int nargs);
+    void clearWait(Coroutine&);
+    void destroy(CoroutineID);
+
+    void waitTime(CoroutineID, Coroutine&, TimeType seconds);
+    void waitFrames(CoroutineID, Coroutine&, int frames);
+    bool waitEvent(CoroutineID, Coroutine&, std::string_view event_type,
+                   EventRouteKeyType key);
+
+    template <typename T>
+    void listenEvent(CoroutineID, Coroutine&, EventRouteKeyType key,
+                     bool pass_event);
+
+    static int luaWait(lua_State* L);
+    static int luaWaitFrames(lua_State* L);
+    static int luaWaitForEvent(lua_State* L);
+};
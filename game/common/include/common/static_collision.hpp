@@ -36,6 +36,9 @@ private:
     };
 
     std::vector<ShapeInfo> m_shapes;
+
+    // owner transform version when shapes were moved last time
+    uint32_t m_transform_version = 0;
 };
 
 class StaticCollisionManager : public ComponentManager<StaticCollision> {
@@ -3,6 +3,7 @@
 #include "common/path.hpp"
 
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 /*
@@ -34,4 +35,35 @@ private:
     IOStream() = default;
     explicit IOStream(const Path& filename, IOMode mode,
                       bool binary, bool advance_mode);
-};
\ No newline at end of file
+};
+
+/**
+ * read-only whole file in memory. Use mmap on desktop, fallback to read the
+ * whole file when can't map(e.g. Android assets are inside apk)
+ */
+class MappedFile {
+public:
+    /**
+     * @return nullptr if file not exists(won't log error)
+     */
+    static std::unique_ptr<MappedFile> Open(const Path& filename);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const char* m_data{};
+    size_t m_size{};
+    bool m_is_mapped = false;
+
+#ifdef _WIN32
+    void* m_file{};
+    void* m_mapping{};
+#endif
+
+    MappedFile() = default;
+};
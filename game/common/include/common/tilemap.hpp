@@ -11,6 +11,8 @@
 #include "tmxlite/Map.hpp"
 #include "tmxlite/ObjectGroup.hpp"
 #include "tmxlite/Property.hpp"
+#include <memory>
+#include <unordered_map>
 #include <variant>
 
 class TilemapTileLayer;
@@ -84,9 +86,24 @@ private:
 
 class TilemapTileLayer : public TilemapLayer {
 public:
-    struct Tile {
-        uint32_t m_gid;
-        Flags<Flip> m_flip = Flip::None;
+    /**
+     * packed into 16 bits: low 14 bits are gid, high 2 bits are flip
+     */
+    class Tile {
+    public:
+        static constexpr uint32_t MaxGID = 0x3FFF;
+
+        Tile() = default;
+        Tile(uint32_t gid, Flags<Flip> flip);
+
+        uint32_t GetGID() const;
+        Flags<Flip> GetFlip() const;
+
+    private:
+        static constexpr uint16_t GIDMask = MaxGID;
+        static constexpr uint16_t FlipShift = 14;
+
+        uint16_t m_data = 0;
     };
 
     explicit TilemapTileLayer(const std::string& name, const tmx::TileLayer&);
@@ -210,10 +227,12 @@ private:
 class Tilemap {
 public:
     explicit Tilemap(const Path& filename);
+    Tilemap(const Path& filename, const tmx::Map& map);
 
-    Tilemap(const Tilemap& o);
+    // layers are immutable, copies share them
+    Tilemap(const Tilemap& o) = default;
     Tilemap(Tilemap&&) = default;
-    Tilemap& operator=(const Tilemap&);
+    Tilemap& operator=(const Tilemap&) = default;
     Tilemap& operator=(Tilemap&&) = default;
 
     auto& GetLayers() const { return m_layers; }
@@ -226,13 +245,35 @@ public:
 
     const Path& GetFilename() const;
 
+    /**
+     * collision rect of tile in layer, relative to layer topleft
+     * @return nullopt if tile has no collision
+     */
+    std::optional<Rect> GetLayerTileCollisionRect(const TilemapTileLayer&,
+                                                  int x, int y) const;
+
+    /**
+     * collision rects of tile layer, relative to layer topleft. Adjacent
+     * tile rects are merged into maximal rects, baked at first call and
+     * cached in tilemap
+     */
+    const std::vector<Rect>& GetLayerCollisionRects(
+        const TilemapTileLayer&) const;
+
 private:
     void parse(const Path& filename);
+    void parse(const tmx::Map& map, const Path& filename);
 
-    std::vector<std::unique_ptr<TilemapLayer>> m_layers;
+    std::vector<Rect> bakeLayerCollisionRects(const TilemapTileLayer&) const;
+
+    std::vector<std::shared_ptr<const TilemapLayer>> m_layers;
     std::vector<Tileset> m_tilesets;
     Vec2 m_tile_size;
     Path m_filename;
+
+    // layer name -> merged collision rects
+    mutable std::unordered_map<std::string, std::vector<Rect>>
+        m_layer_collision_rects;
 };
 
 template <>
@@ -246,4 +287,11 @@ using TilemapHandle = Handle<Tilemap>;
 class TilemapManager : public AssetManagerBase<Tilemap> {
 public:
     TilemapHandle Load(const Path& filename, bool force = false) override;
+
+protected:
+    /**
+     * tmx parsed in worker thread, then tileset & image layer images are
+     * loaded async before building tilemap on main thread
+     */
+    void loadAsync(const Path& filename, const UUIDv4& pending_uuid) override;
 };
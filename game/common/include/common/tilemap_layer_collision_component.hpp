@@ -18,7 +18,9 @@ public:
     const PhysicsScene::TilemapCollision* GetTilemapCollision() const;
 
 private:
-    std::unique_ptr<TilemapLayer> m_tilemap_layer;
+    void createGridCollision(Entity, const TilemapLayerDefinition&);
+
+    std::shared_ptr<const TilemapLayer> m_tilemap_layer;
     TilemapHandle m_tilemap_handle;  // FIXME: component rely on asset may cause
                                      // asset dangling reference
     std::string m_name;
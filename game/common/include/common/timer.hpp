@@ -1,11 +1,13 @@
 #pragma once
 #include <chrono>
+#include <deque>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
 #include "spdlog/fmt/ostr.h"
 #include "spdlog/spdlog.h"
 
+#include "common/event.hpp"
 #include "schema/timer_event.hpp"
 
 /**
@@ -99,8 +101,38 @@ private:
     TimerID m_timer_id = null_timer_id;
 };
 
+template <>
+struct EventRouteKey<TimerEvent> {
+    static constexpr bool routable = true;
+
+    static EventRouteKeyType Get(const TimerEvent& event) {
+        return static_cast<EventRouteKeyType>(event.GetID());
+    }
+
+    static bool IsRoutedOnly(const TimerEvent& event) {
+        return event.GetEventType() == TimerEventType::CoroutineWait;
+    }
+};
+
+template <>
+struct EventRouteKey<TimerStopEvent> {
+    static constexpr bool routable = true;
+
+    static EventRouteKeyType Get(const TimerStopEvent& event) {
+        return static_cast<EventRouteKeyType>(event.GetID());
+    }
+
+    static bool IsRoutedOnly(const TimerStopEvent& event) {
+        return event.GetEventType() == TimerEventType::CoroutineWait;
+    }
+};
+
+class TimerManager;
+
 class Timer {
 public:
+    friend class TimerManager;
+
     Timer() = default;
 
     Timer(const Timer&) = delete;
@@ -116,8 +148,6 @@ public:
 
     void SetInterval(TimeType interval);
 
-    void Update(TimeType);
-
     void Start();
 
     void Stop();
@@ -139,15 +169,42 @@ public:
 private:
     TimerID m_id = null_timer_id;
     bool m_is_running{false};
+
+    // elapsed time until `m_resume_time`, the real elapsed time when running
+    // is `m_cur_time + now - m_resume_time`
     TimeType m_cur_time{};
+    TimeType m_resume_time{};
     TimeType m_interval{};
     TimerEventType m_event_type = TimerEventType::Unknown;
     int m_loop = 0;
     int m_cur_loop = 0;
+
+    TimerManager* m_manager{};
+    // bumped on every reschedule, invalidates old entries in scheduler queue
+    uint32_t m_schedule_version = 0;
+
+    TimeType getNow() const;
+    void syncTime();
+    void reschedule();
+    void fire();
 };
 
+/**
+ * Timers live in a paged slab(pointers keep valid until manager destroyed),
+ * `TimerID` packs slab index and a generation so stale ids are rejected.
+ * Slots are recycled in FIFO order and retired at max generation, ids stay
+ * below 2^31 so they fit in Luau integers.
+ * Running timers are scheduled in a min-heap by deadline, so `Update` only
+ * touches the timers which expire this frame.
+ */
 class TimerManager {
 public:
+    friend class Timer;
+
+    TimerManager() = default;
+    TimerManager(const TimerManager&) = delete;
+    TimerManager& operator=(const TimerManager&) = delete;
+
     Timer& Create(TimeType interval, TimerEventType event_type, int loop = 0);
 
     void Remove(TimerID);
@@ -159,7 +216,48 @@ public:
 
     [[nodiscard]] Timer* Find(TimerID) const;
 
+    /**
+     * accumulated time of all `Update`s
+     */
+    [[nodiscard]] TimeType GetCurrentTime() const;
+
 private:
-    std::underlying_type_t<TimerID> m_cur_id = 0;
-    std::unordered_map<TimerID, std::unique_ptr<Timer>> m_timers;
+    static constexpr uint32_t IndexBits = 20;
+    static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+    static constexpr uint32_t MaxGeneration = (1u << (31 - IndexBits)) - 1;
+    static constexpr uint32_t TimersInPage = 256;
+
+    // recycle slot only when enough slots freed, so a create/remove loop
+    // won't burn generations of one slot
+    static constexpr size_t MinFreeSlots = 64;
+
+    struct ScheduleItem {
+        TimeType m_deadline{};
+        uint32_t m_index{};
+        uint32_t m_version{};
+
+        bool operator>(const ScheduleItem& o) const {
+            return m_deadline > o.m_deadline;
+        }
+    };
+
+    struct SlotInfo {
+        uint32_t m_generation = 1;
+        bool m_alive = false;
+    };
+
+    TimeType m_now{};
+    std::vector<std::unique_ptr<Timer[]>> m_pages;
+    std::vector<SlotInfo> m_slots;
+    std::deque<uint32_t> m_free_slots;
+    std::vector<ScheduleItem> m_schedule_queue;
+
+    // timers rescheduled while firing, pushed after this frame's firing so a
+    // timer fires at most once per `Update`(same as ticking every frame)
+    std::vector<ScheduleItem> m_deferred_schedule;
+    bool m_is_firing = false;
+
+    Timer& getTimer(uint32_t index) const;
+    bool parseID(TimerID id, uint32_t& out_index) const;
+    void schedule(Timer&);
 };
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "common/event.hpp"
 #include "common/manager.hpp"
 #include "common/physics.hpp"
 #include "schema/physics_schema.hpp"
 
+#include <unordered_map>
+
 class TriggerEnterEvent {
 public:
     explicit TriggerEnterEvent(Entity src_entity, TriggerEventType,
@@ -46,6 +49,34 @@ private:
     OverlapResult m_overlap;
 };
 
+// trigger events are routed by the trigger's owner entity
+template <>
+struct EventRouteKey<TriggerEnterEvent> {
+    static constexpr bool routable = true;
+
+    static EventRouteKeyType Get(const TriggerEnterEvent& event) {
+        return static_cast<EventRouteKeyType>(event.GetSrcEntity());
+    }
+};
+
+template <>
+struct EventRouteKey<TriggerLeaveEvent> {
+    static constexpr bool routable = true;
+
+    static EventRouteKeyType Get(const TriggerLeaveEvent& event) {
+        return static_cast<EventRouteKeyType>(event.GetSrcEntity());
+    }
+};
+
+template <>
+struct EventRouteKey<TriggerTouchEvent> {
+    static constexpr bool routable = true;
+
+    static EventRouteKeyType Get(const TriggerTouchEvent& event) {
+        return static_cast<EventRouteKeyType>(event.GetSrcEntity());
+    }
+};
+
 class Trigger {
 public:
     friend class TriggerComponentManager;
@@ -58,6 +89,10 @@ public:
     Trigger() = default;
     Trigger(Entity, const TriggerDefinition&);
     [[nodiscard]] const std::vector<PhysicsData>& GetPhysicsData() const;
+
+    /**
+     * shapes will be re-synced to owner transform in next update
+     */
     [[nodiscard]] std::vector<PhysicsData>& GetPhysicsData();
 
     const std::vector<PhysicsShape*>& GetTouchingShapes();
@@ -80,7 +115,13 @@ private:
     TriggerEventType m_event_type;
     bool m_trig_every_frame_when_touch = false;
 
+    // owner transform version when shapes were moved last time
+    uint32_t m_transform_version = 0;
+
     std::vector<PhysicsShape*> m_touch_shapes;
+
+    // how many shapes of this trigger are touching the shape
+    std::unordered_map<PhysicsShape*, uint32_t> m_touch_counts;
 };
 
 class TriggerComponentManager : public ComponentManager<Trigger> {
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * fixed size thread pool for background work(asset IO & decode).
+ *
+ * Work runs on worker threads, `finish` callbacks are queued back and run on
+ * main thread inside `Update`, so they can touch engine state(GPU upload,
+ * asset managers, ...) safely.
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+    using RangeTask = std::function<void(size_t begin, size_t end)>;
+
+    /**
+     * @param thread_count 0 means use hardware concurrency - 1(at least 1)
+     */
+    explicit WorkerPool(uint32_t thread_count = 0);
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    /**
+     * run `work` on worker thread, then run `finish` on main thread
+     */
+    void Submit(Task work, Task finish = {});
+
+    /**
+     * run `task` on main thread at next `Update`
+     */
+    void PostToMainThread(Task task);
+
+    /**
+     * split [0, count) into chunks and run `task` on them in parallel. The
+     * calling thread works on chunks too and returns when all are done.
+     * @note `task` must not throw
+     */
+    void ParallelFor(size_t count, size_t chunk_size, const RangeTask& task);
+
+    /**
+     * run finished callbacks, must be called on main thread
+     */
+    void Update();
+
+    [[nodiscard]] uint32_t GetThreadCount() const;
+
+private:
+    struct Job {
+        Task m_work;
+        Task m_finish;
+    };
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_job_mutex;
+    std::condition_variable m_job_cv;
+    std::deque<Job> m_jobs;
+    bool m_stop = false;
+
+    std::mutex m_finish_mutex;
+    std::vector<Task> m_finished;
+
+    void workerLoop();
+};
@@ -1,11 +1,13 @@
 #include "common/animation.hpp"
 
+#include "common/binary_serialize.hpp"
 #include "common/context.hpp"
 #include "common/image.hpp"
 #include "common/serialize.hpp"
 #include "common/storage.hpp"
 #include "rapidxml_print.hpp"
 
+#include <algorithm>
 #include <sstream>
 
 AnimationHandle AnimationManager::Load(const Path& filename, bool force) {
@@ -22,8 +24,202 @@ AnimationHandle AnimationManager::Load(const Path& filename, bool force) {
     return store(&filename, result.m_uuid, std::move(result.m_payload));
 }
 
+void AnimationManager::loadAsync(const Path& filename,
+                                 const UUIDv4& pending_uuid) {
+    loadXMLAssetAsync(filename, pending_uuid);
+}
+
+AnimationClip::AnimationClip(const Animation& animation) {
+    m_binding_tracks.fill(InvalidTrack);
+
+    // compile tracks type by type so tracks of one type are adjacent
+    std::vector<PendingTrack> vec2_tracks, degrees_tracks, color_tracks,
+        image_tracks, flip_tracks;
+    for (auto& [binding, track] : animation.GetTracks()) {
+        uint32_t* index = &m_binding_tracks[static_cast<size_t>(binding)];
+        switch (binding) {
+            case AnimationBindingPoint::TransformPosition:
+            case AnimationBindingPoint::TransformScale:
+            case AnimationBindingPoint::SpriteSize:
+            case AnimationBindingPoint::SpriteAnchor:
+                vec2_tracks.push_back({track.get(), index, true});
+                break;
+            case AnimationBindingPoint::SpriteRegionPosition:
+            case AnimationBindingPoint::SpriteRegionSize:
+                vec2_tracks.push_back({track.get(), index, false});
+                break;
+            case AnimationBindingPoint::TransformRotation:
+                degrees_tracks.push_back({track.get(), index, true});
+                break;
+            case AnimationBindingPoint::SpriteColor:
+                color_tracks.push_back({track.get(), index, true});
+                break;
+            case AnimationBindingPoint::SpriteImage:
+                image_tracks.push_back({track.get(), index, false});
+                break;
+            case AnimationBindingPoint::SpriteFlip:
+                flip_tracks.push_back({track.get(), index, false});
+                break;
+            default:
+                LOGW("animation binding point {} can't be played",
+                     static_cast<int>(binding));
+                break;
+        }
+    }
+
+    // reserved so pending indices stay valid
+    m_bind_point_tracks.reserve(animation.GetBindPointTracks().size());
+    for (auto& [name, track] : animation.GetBindPointTracks()) {
+        auto& bind_point_track =
+            m_bind_point_tracks.emplace_back(BindPointTrack{name});
+        vec2_tracks.push_back({track.get(), &bind_point_track.m_track, true});
+    }
+
+    compileTracks<Vec2>(vec2_tracks);
+    compileTracks<Degrees>(degrees_tracks);
+    compileTracks<Color>(color_tracks);
+    compileTracks<ImageHandle>(image_tracks);
+    compileTracks<Flags<Flip>>(flip_tracks);
+
+    m_bind_point_tracks.erase(
+        std::remove_if(m_bind_point_tracks.begin(), m_bind_point_tracks.end(),
+                       [](const BindPointTrack& track) {
+                           return track.m_track == InvalidTrack;
+                       }),
+        m_bind_point_tracks.end());
+}
+
+template <typename T>
+void AnimationClip::compileTracks(const std::vector<PendingTrack>& tracks) {
+    auto& values = std::get<std::vector<T>>(m_values);
+    auto& type_tracks = m_type_tracks[valueTypeIndex<T>()];
+    type_tracks.m_begin = static_cast<uint32_t>(m_tracks.size());
+
+    for (auto& pending : tracks) {
+        auto& track = *pending.m_track;
+        if (track.IsEmpty() || (track.GetType() == AnimationTrackType::Linear &&
+                                !pending.m_can_linear)) {
+            continue;
+        }
+
+        auto& keyframes =
+            static_cast<const IAnimationTrack<T>&>(track).GetKeyframes();
+
+        Track info;
+        info.m_type = track.GetType();
+        info.m_first = static_cast<uint32_t>(m_times.size());
+        info.m_first_value = static_cast<uint32_t>(values.size());
+        info.m_count = static_cast<uint32_t>(keyframes.size());
+        for (auto& keyframe : keyframes) {
+            m_times.push_back(keyframe.m_time);
+            values.push_back(keyframe.m_value);
+        }
+        m_duration = std::max(m_duration, keyframes.back().m_time);
+
+        *pending.m_index = static_cast<uint32_t>(m_tracks.size());
+        m_tracks.push_back(info);
+    }
+
+    type_tracks.m_end = static_cast<uint32_t>(m_tracks.size());
+}
+
+void AnimationClip::SamplePose(TimeType time, uint32_t* hints,
+                               AnimationPose& pose) const {
+    size_t count = m_tracks.size();
+    pose.m_sampled.resize(count);
+    pose.m_frames.resize(count);
+    pose.m_factors.resize(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto& track = m_tracks[i];
+        int frame = Seek(i, time, hints[i]);
+
+        float factor = 0;
+        if (frame >= 0 && track.m_type == AnimationTrackType::Linear &&
+            frame + 1 < static_cast<int>(track.m_count)) {
+            const TimeType* times = m_times.data() + track.m_first;
+            TimeType duration = times[frame + 1] - times[frame];
+            factor = duration > 0 ? (time - times[frame]) / duration : 1.0f;
+        }
+
+        pose.m_sampled[i] = frame >= 0;
+        pose.m_frames[i] = std::max(frame, 0);
+        pose.m_factors[i] = factor;
+    }
+
+    blendPose<Vec2>(pose);
+    blendPose<Degrees>(pose);
+    blendPose<Color>(pose);
+    blendPose<ImageHandle>(pose);
+    blendPose<Flags<Flip>>(pose);
+}
+
+template <typename T>
+void AnimationClip::blendPose(AnimationPose& pose) const {
+    auto& type_tracks = m_type_tracks[valueTypeIndex<T>()];
+    auto& values = std::get<std::vector<T>>(m_values);
+    auto& out = std::get<std::vector<T>>(pose.m_values);
+    out.resize(type_tracks.m_end - type_tracks.m_begin);
+
+    // discrete tracks have zero factor, so all tracks of one type share the
+    // same branchless loop
+    for (uint32_t i = type_tracks.m_begin; i < type_tracks.m_end; i++) {
+        auto& track = m_tracks[i];
+        uint32_t frame = track.m_first_value + pose.m_frames[i];
+        T& value = out[i - type_tracks.m_begin];
+        if constexpr (canLerp<T>) {
+            uint32_t next = std::min(frame + 1, track.m_first_value +
+                                                    track.m_count - 1);
+            value = Lerp(values[frame], values[next], pose.m_factors[i]);
+        } else {
+            value = values[frame];
+        }
+    }
+}
+
+uint32_t AnimationClip::GetTrackIndex(AnimationBindingPoint binding) const {
+    return m_binding_tracks[static_cast<size_t>(binding)];
+}
+
+const std::vector<AnimationClip::BindPointTrack>&
+AnimationClip::GetBindPointTracks() const {
+    return m_bind_point_tracks;
+}
+
+size_t AnimationClip::GetTrackCount() const {
+    return m_tracks.size();
+}
+
+TimeType AnimationClip::GetDuration() const {
+    return m_duration;
+}
+
+int AnimationClip::Seek(uint32_t track, TimeType time, uint32_t& hint) const {
+    auto& info = m_tracks[track];
+    const TimeType* begin = m_times.data() + info.m_first;
+    const TimeType* end = begin + info.m_count;
+    if (time < *begin) {
+        return -1;
+    }
+
+    // playing forward mostly stays in hinted frame or steps to next one
+    if (hint < info.m_count && begin[hint] <= time) {
+        if (hint + 1 >= info.m_count || time < begin[hint + 1]) {
+            return hint;
+        }
+        if (hint + 2 >= info.m_count || time < begin[hint + 2]) {
+            return ++hint;
+        }
+    }
+
+    auto it = std::upper_bound(begin, end, time);
+    hint = static_cast<uint32_t>(it - begin - 1);
+    return hint;
+}
+
 void Animation::AddTrack(AnimationBindingPoint binding,
                          std::unique_ptr<AnimationTrackBase>&& track) {
+    m_clip.reset();
     if (track && !track->IsEmpty()) {
         m_tracks[binding] = std::move(track);
     }
@@ -31,6 +227,7 @@ void Animation::AddTrack(AnimationBindingPoint binding,
 
 void Animation::AddBindPointTrack(
     const std::string& name, std::unique_ptr<IAnimationTrack<Vec2>>&& track) {
+    m_clip.reset();
     m_bind_point_tracks.emplace(name, std::move(track));
 }
 
@@ -38,6 +235,7 @@ void Animation::AddTracks(const SpriteRowColumnAnimationInfo& info) {
     if (info.m_begin == info.m_end) {
         return;
     }
+    m_clip.reset();
 
     auto region_position_track =
         std::make_unique<AnimationTrack<Vec2, AnimationTrackType::Discrete>>();
@@ -84,8 +282,25 @@ TimeType Animation::GetFinishTime() const {
     return max_time;
 }
 
+void Animation::Compile() const {
+    m_clip = std::make_unique<AnimationClip>(*this);
+}
+
+const AnimationClip& Animation::GetClip() const {
+    if (!m_clip) {
+        Compile();
+    }
+    return *m_clip;
+}
+
 template <>
 AssetLoadResult<Animation> LoadAsset<Animation>(const Path& filename) {
+    if (auto cooked = CookedAssetFile::Open(filename)) {
+        if (auto result = LoadAsset<Animation>(*cooked)) {
+            return result;
+        }
+    }
+
     auto file = IOStream::CreateFromFile(filename, IOMode::Read, true);
     auto content = file->Read();
     content.push_back('\0');
@@ -106,6 +321,15 @@ AssetLoadResult<Animation> LoadAsset<Animation>(const Path& filename) {
     return result;
 }
 
+template <>
+AssetLoadResult<Animation> LoadAsset<Animation>(const CookedAssetFile& file) {
+    auto result = LoadCookedAsset<Animation>(file);
+    if (result) {
+        result.m_payload->Compile();
+    }
+    return result;
+}
+
 template <>
 AssetLoadResult<Animation> LoadAsset<Animation>(
     const rapidxml::xml_node<>& node) {
@@ -121,6 +345,7 @@ AssetLoadResult<Animation> LoadAsset<Animation>(
     Deserialize(COMMON_CONTEXT, *uuid_node, result.m_uuid);
     result.m_payload = std::make_unique<Animation>();
     Deserialize(COMMON_CONTEXT, *value_node, *result.m_payload);
+    result.m_payload->Compile();
     return result;
 }
 
@@ -0,0 +1,112 @@
+#include "common/asset.hpp"
+
+#include "common/asset_manager.hpp"
+#include "common/binary_serialize.hpp"
+#include "common/log.hpp"
+#include "common/storage.hpp"
+#include "common/tilemap.hpp"
+#include "schema/asset_info.hpp"
+
+namespace {
+
+/**
+ * @return true if `on_loaded` will be called
+ */
+bool prefetchAsset(const Path& filename,
+                   const std::function<void()>& on_loaded) {
+    auto& assets_manager = *COMMON_CONTEXT.m_assets_manager;
+    auto extension = filename.extension();
+    if (extension == ".png") {
+        return assets_manager.GetManager<ImageBase>().Prefetch(filename,
+                                                               on_loaded);
+    }
+    if (extension == ".tmx") {
+        return assets_manager.GetManager<Tilemap>().Prefetch(filename,
+                                                             on_loaded);
+    }
+    return AssetInfoManager::PrefetchAsset(filename, COMMON_CONTEXT, on_loaded);
+}
+
+// handles are serialized as path in node value
+void collectAssetPaths(const rapidxml::xml_node<>& node,
+                       std::vector<Path>& out_paths) {
+    for (auto child = node.first_node(); child; child = child->next_sibling()) {
+        TL_CONTINUE_IF_FALSE(child->type() ==
+                             rapidxml::node_type::node_element);
+        if (child->value_size() > 0) {
+            out_paths.emplace_back(child->value());
+        }
+        collectAssetPaths(*child, out_paths);
+    }
+}
+
+}  // namespace
+
+void PrefetchAssetDependencies(const rapidxml::xml_node<>& node,
+                               std::function<void()> on_loaded) {
+    std::vector<Path> paths;
+    collectAssetPaths(node, paths);
+
+    // one extra count is held until all loads started, loads finished
+    // synchronously can't call `on_loaded` early
+    auto remain = std::make_shared<size_t>(1);
+    std::function<void()> finish = [=]() {
+        if (--*remain == 0) {
+            on_loaded();
+        }
+    };
+    for (auto& path : paths) {
+        ++*remain;
+        if (!prefetchAsset(path, finish)) {
+            --*remain;
+        }
+    }
+    finish();
+}
+
+WorkerPool* IAssetManager::s_worker_pool = nullptr;
+
+XMLAssetSource::XMLAssetSource() = default;
+
+XMLAssetSource::~XMLAssetSource() = default;
+
+bool XMLAssetSource::Load(const Path& filename) {
+    m_cooked_file = CookedAssetFile::Open(filename);
+    if (m_cooked_file) {
+        return true;
+    }
+
+    auto file = IOStream::CreateFromFile(filename, IOMode::Read, true);
+    if (!file || !*file) {
+        LOGE("open asset {} failed", filename);
+        return false;
+    }
+
+    m_content = file->Read();
+    m_content.push_back('\0');
+    try {
+        m_doc.parse<rapidxml::parse_default>(m_content.data());
+    } catch (std::exception& e) {
+        LOGE("parse asset {} failed: {}", filename, e.what());
+        return false;
+    }
+
+    m_parsed = true;
+    return true;
+}
+
+const rapidxml::xml_node<>* XMLAssetSource::GetRootNode() const {
+    return m_parsed ? m_doc.first_node() : nullptr;
+}
+
+const CookedAssetFile* XMLAssetSource::GetCookedFile() const {
+    return m_cooked_file.get();
+}
+
+void IAssetManager::SetWorkerPool(WorkerPool* pool) {
+    s_worker_pool = pool;
+}
+
+WorkerPool* IAssetManager::GetWorkerPool() {
+    return s_worker_pool;
+}
@@ -0,0 +1,382 @@
+#include "common/binary_serialize.hpp"
+
+#include "common/collision_group.hpp"
+#include "common/image.hpp"
+#include "schema/serialize/anim.hpp"
+#include "schema/serialize/flip.hpp"
+
+void BinaryWriter::Write(const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
+
+void BinaryWriter::WriteString(std::string_view str) {
+    Write(static_cast<uint32_t>(str.size()));
+    Write(str.data(), str.size());
+}
+
+const std::vector<char>& BinaryWriter::GetBuffer() const {
+    return m_buffer;
+}
+
+bool BinaryWriter::SaveToFile(const Path& filename) const {
+    auto io = IOStream::CreateFromFile(filename, IOMode::Write, true);
+    TL_RETURN_FALSE_IF_FALSE(io && *io);
+    io->Write(m_buffer.data(), m_buffer.size());
+    return true;
+}
+
+BinaryReader::BinaryReader(const char* data, size_t size)
+    : m_data{data}, m_size{size} {}
+
+bool BinaryReader::Read(void* data, size_t size) {
+    if (m_failed || m_size - m_offset < size) {
+        m_failed = true;
+        memset(data, 0, size);
+        return false;
+    }
+
+    memcpy(data, m_data + m_offset, size);
+    m_offset += size;
+    return true;
+}
+
+std::string_view BinaryReader::ReadString() {
+    uint32_t size = ReadCount();
+    if (m_failed) {
+        return {};
+    }
+
+    std::string_view str{m_data + m_offset, size};
+    m_offset += size;
+    return str;
+}
+
+uint32_t BinaryReader::ReadCount() {
+    uint32_t count = 0;
+    Read(count);
+    // every element takes 1 byte at least
+    if (count > m_size - m_offset) {
+        m_failed = true;
+        return 0;
+    }
+    return count;
+}
+
+bool BinaryReader::IsValid() const {
+    return !m_failed;
+}
+
+struct CookedAssetHeader {
+    std::array<char, 4> m_magic;
+    uint32_t m_version;
+    uint64_t m_schema_hash;
+    uint64_t m_source_hash;  // of xml content
+};
+
+namespace {
+
+// FNV-1a, stable across platforms so files cooked on desktop work on android
+uint64_t hashBytes(const char* data, size_t size) {
+    constexpr uint64_t FNVOffsetBasis = 14695981039346656037ull;
+    constexpr uint64_t FNVPrime = 1099511628211ull;
+
+    uint64_t hash = FNVOffsetBasis;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= FNVPrime;
+    }
+    return hash;
+}
+
+}  // namespace
+
+std::optional<uint64_t> CookedAssetFile::HashSource(const Path& filename) {
+    auto file = MappedFile::Open(filename);
+    TL_RETURN_VALUE_IF_NULL(file, std::nullopt);
+    return hashBytes(file->GetData(), file->GetSize());
+}
+
+Path CookedAssetFile::GetCookedPath(const Path& filename) {
+    Path cooked = filename;
+    return cooked.replace_extension(".bin");
+}
+
+std::unique_ptr<CookedAssetFile> CookedAssetFile::Open(const Path& filename) {
+    Path cooked_filename = GetCookedPath(filename);
+
+    auto mapped_file = MappedFile::Open(cooked_filename);
+    if (!mapped_file) {
+        return nullptr;
+    }
+
+    CookedAssetHeader header;
+    if (mapped_file->GetSize() < sizeof(header)) {
+        LOGW("cooked asset {} is corrupted", cooked_filename);
+        return nullptr;
+    }
+    memcpy(&header, mapped_file->GetData(), sizeof(header));
+    if (header.m_magic != Magic || header.m_version != Version ||
+        header.m_schema_hash != SchemaLayoutHash) {
+        LOGW("cooked asset {} is outdated, please re-cook", cooked_filename);
+        return nullptr;
+    }
+
+    // xml changed after cooking(e.g. saved by editor), use xml. Content is
+    // compared instead of mtime, which isn't kept in apk
+    auto source_hash = HashSource(filename);
+    if (source_hash && header.m_source_hash != source_hash.value()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CookedAssetFile> file{new CookedAssetFile};
+    file->m_file = std::move(mapped_file);
+    file->m_filename = cooked_filename;
+    return file;
+}
+
+void CookedAssetFile::WriteHeader(BinaryWriter& writer,
+                                  uint64_t source_hash) {
+    CookedAssetHeader header;
+    header.m_magic = Magic;
+    header.m_version = Version;
+    header.m_schema_hash = SchemaLayoutHash;
+    header.m_source_hash = source_hash;
+    writer.Write(header);
+}
+
+BinaryReader CookedAssetFile::CreateReader() const {
+    constexpr size_t header_size = sizeof(CookedAssetHeader);
+    return BinaryReader{m_file->GetData() + header_size,
+                        m_file->GetSize() - header_size};
+}
+
+const Path& CookedAssetFile::GetFilename() const {
+    return m_filename;
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const Path& payload) {
+    writer.WriteString(payload.string());
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader, Path& payload) {
+    payload = reader.ReadString();
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const std::string& payload) {
+    writer.WriteString(payload);
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       std::string& payload) {
+    payload = reader.ReadString();
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const UUIDv4& payload) {
+    writer.Write(payload);
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       UUIDv4& payload) {
+    reader.Read(payload);
+}
+
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const Region& payload) {
+    SerializeBinary(ctx, writer, payload.m_topleft);
+    SerializeBinary(ctx, writer, payload.m_size);
+}
+
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       Region& payload) {
+    DeserializeBinary(ctx, reader, payload.m_topleft);
+    DeserializeBinary(ctx, reader, payload.m_size);
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const Degrees& payload) {
+    writer.Write(payload.Value());
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       Degrees& payload) {
+    float value{};
+    reader.Read(value);
+    payload = value;
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const Radians& payload) {
+    writer.Write(payload.Value());
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       Radians& payload) {
+    float value{};
+    reader.Read(value);
+    payload = value;
+}
+
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const Transform& payload) {
+    SerializeBinary(ctx, writer, payload.m_position);
+    SerializeBinary(ctx, writer, payload.m_scale);
+    SerializeBinary(ctx, writer, payload.m_rotation);
+}
+
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       Transform& payload) {
+    DeserializeBinary(ctx, reader, payload.m_position);
+    DeserializeBinary(ctx, reader, payload.m_scale);
+    DeserializeBinary(ctx, reader, payload.m_rotation);
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const Color& payload) {
+    writer.Write(payload.r);
+    writer.Write(payload.g);
+    writer.Write(payload.b);
+    writer.Write(payload.a);
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader, Color& payload) {
+    reader.Read(payload.r);
+    reader.Read(payload.g);
+    reader.Read(payload.b);
+    reader.Read(payload.a);
+}
+
+void SerializeBinary(CommonContext&, BinaryWriter& writer,
+                     const CollisionGroup& payload) {
+    writer.Write(payload.GetUnderlying());
+}
+
+void DeserializeBinary(CommonContext&, BinaryReader& reader,
+                       CollisionGroup& payload) {
+    CollisionGroup::underlying_type value{};
+    reader.Read(value);
+    payload.SetUnderlying(value);
+}
+
+template <typename T>
+struct AnimTrackValueTypeTag {
+    using type = T;
+};
+
+/**
+ * call `f` with keyframe value type tag of binding point, same as xml
+ * serialization
+ */
+template <typename F>
+bool visitAnimTrackValueType(AnimationBindingPoint binding_point, F&& f) {
+    switch (binding_point) {
+        case AnimationBindingPoint::TransformPosition:
+        case AnimationBindingPoint::TransformScale:
+        case AnimationBindingPoint::SpriteRegionPosition:
+        case AnimationBindingPoint::SpriteRegionSize:
+        case AnimationBindingPoint::SpriteSize:
+        case AnimationBindingPoint::SpriteAnchor:
+        case AnimationBindingPoint::BindPoint:
+            f(AnimTrackValueTypeTag<Vec2>{});
+            return true;
+        case AnimationBindingPoint::TransformRotation:
+            f(AnimTrackValueTypeTag<Degrees>{});
+            return true;
+        case AnimationBindingPoint::SpriteImage:
+            f(AnimTrackValueTypeTag<ImageHandle>{});
+            return true;
+        case AnimationBindingPoint::SpriteFlip:
+            f(AnimTrackValueTypeTag<Flags<Flip>>{});
+            return true;
+        case AnimationBindingPoint::SpriteColor:
+            f(AnimTrackValueTypeTag<Color>{});
+            return true;
+        case AnimationBindingPoint::Unknown:
+            break;
+    }
+    return false;
+}
+
+void serializeAnimTrack(CommonContext& ctx, BinaryWriter& writer,
+                        AnimationBindingPoint binding_point,
+                        const AnimationTrackBase& payload) {
+    SerializeBinary(ctx, writer, binding_point);
+    SerializeBinary(ctx, writer, payload.GetType());
+    visitAnimTrackValueType(binding_point, [&](auto tag) {
+        using value_type = typename decltype(tag)::type;
+        SerializeBinary(
+            ctx, writer,
+            static_cast<const IAnimationTrack<value_type>&>(payload)
+                .GetKeyframes());
+    });
+}
+
+std::tuple<AnimationBindingPoint, std::unique_ptr<AnimationTrackBase>>
+deserializeAnimTrack(CommonContext& ctx, BinaryReader& reader) {
+    AnimationBindingPoint binding_point = AnimationBindingPoint::Unknown;
+    AnimationTrackType type = AnimationTrackType::Discrete;
+    DeserializeBinary(ctx, reader, binding_point);
+    DeserializeBinary(ctx, reader, type);
+
+    std::unique_ptr<AnimationTrackBase> track;
+    bool is_known = visitAnimTrackValueType(binding_point, [&](auto tag) {
+        using value_type = typename decltype(tag)::type;
+        std::vector<KeyFrame<value_type>> keyframes;
+        DeserializeBinary(ctx, reader, keyframes);
+        if (type == AnimationTrackType::Linear) {
+            auto raw_track = std::make_unique<
+                AnimationTrack<value_type, AnimationTrackType::Linear>>();
+            raw_track->AddKeyframes(std::move(keyframes));
+            track = std::move(raw_track);
+        } else {
+            auto raw_track = std::make_unique<
+                AnimationTrack<value_type, AnimationTrackType::Discrete>>();
+            raw_track->AddKeyframes(std::move(keyframes));
+            track = std::move(raw_track);
+        }
+    });
+    if (!is_known) {
+        LOGE("[DeserializeBinary] unknown animation binding point {}",
+             static_cast<int>(binding_point));
+    }
+
+    return {binding_point, std::move(track)};
+}
+
+void SerializeBinary(CommonContext& ctx, BinaryWriter& writer,
+                     const Animation& payload) {
+    auto& tracks = payload.GetTracks();
+    writer.Write(static_cast<uint32_t>(tracks.size()));
+    for (auto& [binding_point, track] : tracks) {
+        serializeAnimTrack(ctx, writer, binding_point, *track);
+    }
+
+    auto& bind_point_tracks = payload.GetBindPointTracks();
+    writer.Write(static_cast<uint32_t>(bind_point_tracks.size()));
+    for (auto& [name, track] : bind_point_tracks) {
+        writer.WriteString(name);
+        serializeAnimTrack(ctx, writer, AnimationBindingPoint::BindPoint,
+                           *track);
+    }
+}
+
+void DeserializeBinary(CommonContext& ctx, BinaryReader& reader,
+                       Animation& payload) {
+    uint32_t track_count = reader.ReadCount();
+    for (uint32_t i = 0; i < track_count; i++) {
+        auto [binding, track] = deserializeAnimTrack(ctx, reader);
+        payload.AddTrack(binding, std::move(track));
+    }
+
+    uint32_t bind_point_track_count = reader.ReadCount();
+    for (uint32_t i = 0; i < bind_point_track_count; i++) {
+        std::string name{reader.ReadString()};
+        auto [_, track] = deserializeAnimTrack(ctx, reader);
+        payload.AddBindPointTrack(
+            name, std::unique_ptr<IAnimationTrack<Vec2>>(
+                      static_cast<IAnimationTrack<Vec2>*>(track.release())));
+    }
+}
@@ -61,7 +61,8 @@ void CharacterController::MoveAndSlide(const Vec2& dir) {
 
         for (int i = 0; i < hitted; i++) {
             CCT_DEBUG_LOG("hitted {}: position = {}, normal = {},  t = {}", i,
-                          hit.m_shape->GetPosition(), hit.m_normal, hit.m_t);
+                          hit.m_shape ? hit.m_shape->GetPosition() : Vec2{},
+                          hit.m_normal, hit.m_t);
         }
 
         if (!hitted) {
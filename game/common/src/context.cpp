@@ -15,6 +15,7 @@
 #include "common/script/lua_event_listener.hpp"
 #include "common/script/script.hpp"
 #include "common/script/script_binding.hpp"
+#include "common/script/script_coroutine.hpp"
 #include "common/sdl_call.hpp"
 #include "common/serialize.hpp"
 #include "common/static_collision.hpp"
@@ -24,6 +25,7 @@
 #include "common/transform.hpp"
 #include "common/trigger.hpp"
 #include "common/uuid.hpp"
+#include "common/worker_pool.hpp"
 #include "schema/asset_info.hpp"
 #include "schema/config.hpp"
 #include "schema/serialize/input.hpp"
@@ -83,6 +85,9 @@ void CommonContext::Initialize(int argc, char** argv) {
     m_should_exit = false;
     m_is_inited = true;
 
+    m_worker_pool = std::make_unique<WorkerPool>();
+    IAssetManager::SetWorkerPool(m_worker_pool.get());
+
     m_transform_manager = std::make_unique<TransformManager>();
     m_relationship_manager = std::make_unique<RelationshipManager>();
     m_entity_name_manager = std::make_unique<EntityNameManager>();
@@ -106,6 +111,7 @@ void CommonContext::Initialize(int argc, char** argv) {
     m_tilemap_layer_collision_component_manager =
         std::make_unique<TilemapLayerCollisionComponentManager>();
     m_script_component_manager = std::make_unique<ScriptComponentManager>();
+    m_script_coroutine_scheduler = std::make_unique<ScriptCoroutineScheduler>();
     m_replicate_component_manager =
         std::make_unique<ReplicateComponentManager>();
 }
@@ -114,9 +120,15 @@ void CommonContext::Shutdown() {
     m_should_exit = true;
     m_is_inited = false;
 
+    // join workers firstly, unfinished async loads are dropped
+    IAssetManager::SetWorkerPool(nullptr);
+    m_worker_pool.reset();
+
     m_scene_manager.reset();
 
     m_script_component_manager.reset();
+    // coroutines hold luau threads, timers & event listeners
+    m_script_coroutine_scheduler.reset();
     // remove luau event binding firstly, to clear LuaRef & lua_State* depends
     // 1. remove all lua event listener(EventSystem will pending the remove
     // operations)
@@ -197,12 +209,14 @@ void CommonContext::AttachComponentsOnEntity(Entity entity,
 void CommonContext::RemoveAllComponentsOnEntity(Entity entity) {
     m_transform_manager->RemoveEntity(entity);
     m_relationship_manager->RemoveEntity(entity);
+    m_entity_name_manager->RemoveEntity(entity);
     m_tilemap_layer_collision_component_manager->RemoveEntity(entity);
     m_cct_manager->RemoveEntity(entity);
     m_trigger_component_manager->RemoveEntity(entity);
     m_static_collision_manager->RemoveEntity(entity);
     m_bind_point_component_manager->RemoveEntity(entity);
     m_script_component_manager->RemoveEntity(entity);
+    m_script_coroutine_scheduler->StopByOwner(entity);
 }
 
 void CommonContext::InitGlobalScript(const Path& script_path) {
@@ -219,7 +233,18 @@ bool CommonContext::IsRunning() const {
 }
 
 Entity CommonContext::CreateEntity() {
-    return static_cast<Entity>(m_last_entity++);
+    return m_entity_registry.Create();
+}
+
+void CommonContext::DestroyEntity(Entity entity) {
+    TL_RETURN_IF_FALSE(m_entity_registry.IsAlive(entity));
+
+    RemoveAllComponentsOnEntity(entity);
+    m_entity_registry.Destroy(entity);
+}
+
+bool CommonContext::IsEntityAlive(Entity entity) const {
+    return m_entity_registry.IsAlive(entity);
 }
 
 const CommonConfig& CommonContext::GetCommonConfig() const {
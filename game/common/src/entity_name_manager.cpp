@@ -3,55 +3,163 @@
 #include "common/context.hpp"
 #include "common/relationship.hpp"
 
+#include <algorithm>
+
 EntityName::EntityName(const std::string& name): m_name{name} {}
 
+void EntityNameManager::RegisterEntity(Entity entity, const std::string& name) {
+    TL_RETURN_IF_TRUE_WITH_LOG(Has(entity), LOGW,
+                               "[Component]: entity {} already registered",
+                               entity);
+
+    ComponentManager::RegisterEntity(entity, name);
+    auto component = Get(entity);
+    component->m_name_id = internName(name);
+    m_name_index[component->m_name_id].push_back(entity);
+}
+
+void EntityNameManager::RemoveEntity(Entity entity) {
+    auto component = Get(entity);
+    TL_RETURN_IF_NULL(component);
+
+    removeFromIndex(entity, *component);
+    ComponentManager::RemoveEntity(entity);
+}
+
+void EntityNameManager::Rename(Entity entity, const std::string& name) {
+    auto component = Get(entity);
+    TL_RETURN_IF_NULL(component);
+
+    removeFromIndex(entity, *component);
+    component->m_name = name;
+    component->m_name_id = internName(name);
+    m_name_index[component->m_name_id].push_back(entity);
+}
+
 Entity EntityNameManager::FindChildByName(Entity entity,
                                           const std::string& name) {
+    auto entities = findNamedEntities(name);
+    TL_RETURN_VALUE_IF_NULL(entities, null_entity);
+
+    // index keeps registration order, pick the first one in depth-first order.
+    // Paths are only built when more than one descendant matches
     Entity result = null_entity;
-    findChildByName(entity, name, result);
+    std::vector<size_t> result_path, path;
+    for (Entity candidate : *entities) {
+        TL_CONTINUE_IF_FALSE(isDescendant(candidate, entity));
+        if (result == null_entity) {
+            result = candidate;
+            continue;
+        }
+
+        if (result_path.empty()) {
+            getDescendantPath(result, entity, result_path);
+        }
+        getDescendantPath(candidate, entity, path);
+        if (path < result_path) {
+            result = candidate;
+            std::swap(result_path, path);
+        }
+    }
     return result;
 }
 
 std::vector<Entity> EntityNameManager::FindChildrenByName(
     Entity entity, const std::string& name) {
     std::vector<Entity> result;
-    findChildrenByName(entity, name, result);
+    auto entities = findNamedEntities(name);
+    TL_RETURN_VALUE_IF_NULL(entities, result);
+
+    for (Entity candidate : *entities) {
+        if (isDescendant(candidate, entity)) {
+            result.push_back(candidate);
+        }
+    }
+    TL_RETURN_VALUE_IF_TRUE(result.size() <= 1, result);
+
+    std::vector<std::pair<std::vector<size_t>, Entity>> found;
+    found.reserve(result.size());
+    for (Entity candidate : result) {
+        auto& [path, _] = found.emplace_back(std::vector<size_t>{}, candidate);
+        getDescendantPath(candidate, entity, path);
+    }
+    std::sort(found.begin(), found.end());
+
+    for (size_t i = 0; i < found.size(); i++) {
+        result[i] = found[i].second;
+    }
     return result;
 }
 
-void EntityNameManager::findChildByName(Entity entity, const std::string& name,
-                                        Entity& result) {
-    auto relationship = COMMON_CONTEXT.m_relationship_manager->Get(entity);
-    TL_RETURN_IF_FALSE(relationship);
+EntityNameID EntityNameManager::internName(const std::string& name) {
+    auto [it, inserted] = m_name_ids.emplace(name, m_next_name_id);
+    if (inserted) {
+        m_next_name_id++;
+    }
+    return it->second;
+}
+
+const std::vector<Entity>* EntityNameManager::findNamedEntities(
+    const std::string& name) const {
+    auto id_it = m_name_ids.find(name);
+    TL_RETURN_VALUE_IF_TRUE(id_it == m_name_ids.end(), nullptr);
 
-    for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-        Entity child = relationship->Get(i);
+    auto it = m_name_index.find(id_it->second);
+    TL_RETURN_VALUE_IF_TRUE(it == m_name_index.end(), nullptr);
+    return &it->second;
+}
 
-        auto name_component = Get(child);
+void EntityNameManager::removeFromIndex(Entity entity,
+                                        const EntityName& component) {
+    auto it = m_name_index.find(component.m_name_id);
+    TL_RETURN_IF_TRUE(it == m_name_index.end());
 
-        if (name_component && name_component->m_name == name) {
-            result = child;
-            return;
-        }
+    auto& entities = it->second;
+    entities.erase(std::remove(entities.begin(), entities.end(), entity),
+                   entities.end());
+    if (entities.empty()) {
+        m_name_index.erase(it);
+        m_name_ids.erase(component.m_name);
+    }
+}
 
-        findChildByName(child, name, result);
+bool EntityNameManager::isDescendant(Entity entity, Entity ancestor) const {
+    auto& relationship_manager = COMMON_CONTEXT.m_relationship_manager;
+    auto relationship = relationship_manager->Get(entity);
+    while (relationship) {
+        Entity parent = relationship->GetParent();
+        TL_RETURN_FALSE_IF_TRUE(parent == null_entity);
+        TL_RETURN_VALUE_IF_TRUE(parent == ancestor, true);
+        relationship = relationship_manager->Get(parent);
     }
+    return false;
 }
 
-void EntityNameManager::findChildrenByName(Entity entity,
-                                           const std::string& name,
-                                           std::vector<Entity>& result) {
-    auto relationship = COMMON_CONTEXT.m_relationship_manager->Get(entity);
-    TL_RETURN_IF_FALSE(relationship);
+bool EntityNameManager::getDescendantPath(Entity entity, Entity ancestor,
+                                          std::vector<size_t>& out_path) const {
+    out_path.clear();
 
-    for (size_t i = 0; i < relationship->GetChildrenCount(); i++) {
-        Entity child = relationship->Get(i);
+    auto& relationship_manager = COMMON_CONTEXT.m_relationship_manager;
+    auto relationship = relationship_manager->Get(entity);
+    while (relationship) {
+        Entity parent = relationship->GetParent();
+        TL_RETURN_VALUE_IF_TRUE(parent == null_entity, false);
 
-        auto name_component = Get(child);
-        if (name_component && name_component->m_name == name) {
-            result.push_back(child);
+        auto parent_relationship = relationship_manager->Get(parent);
+        TL_RETURN_VALUE_IF_NULL(parent_relationship, false);
+        for (size_t i = 0; i < parent_relationship->GetChildrenCount(); i++) {
+            if (parent_relationship->Get(i) == entity) {
+                out_path.push_back(i);
+                break;
+            }
         }
 
-        findChildrenByName(child, name, result);
+        if (parent == ancestor) {
+            std::reverse(out_path.begin(), out_path.end());
+            return true;
+        }
+        entity = parent;
+        relationship = parent_relationship;
     }
-}
\ No newline at end of file
+    return false;
+}
@@ -0,0 +1,71 @@
+#include "common/entity_registry.hpp"
+
+#include "common/log.hpp"
+#include "common/macros.hpp"
+
+#include <type_traits>
+
+uint32_t EntityRegistry::GetIndex(Entity entity) {
+    return static_cast<std::underlying_type_t<Entity>>(entity) & IndexMask;
+}
+
+uint32_t EntityRegistry::GetGeneration(Entity entity) {
+    return static_cast<std::underlying_type_t<Entity>>(entity) >> IndexBits;
+}
+
+EntityRegistry::EntityRegistry() {
+    m_slots.emplace_back();
+}
+
+Entity EntityRegistry::Create() {
+    uint32_t index;
+    if (m_free_indices.size() >= MinFreeIndices) {
+        index = m_free_indices.front();
+        m_free_indices.pop_front();
+    } else {
+        if (m_slots.size() > IndexMask) {
+            LOGC("[EntityRegistry]: entity count exceeds {}", IndexMask);
+            return null_entity;
+        }
+        index = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    auto& slot = m_slots[index];
+    slot.m_alive = true;
+    m_alive_count++;
+    return static_cast<Entity>((slot.m_generation << IndexBits) | index);
+}
+
+void EntityRegistry::Destroy(Entity entity) {
+    // entity may be destroyed both with its parent and by itself
+    TL_RETURN_IF_FALSE(IsAlive(entity));
+
+    uint32_t index = GetIndex(entity);
+    auto& slot = m_slots[index];
+    slot.m_alive = false;
+    m_alive_count--;
+
+    // retire index, wrapped generation would make stale entities alive
+    TL_RETURN_IF_TRUE(slot.m_generation == MaxGeneration);
+
+    slot.m_generation++;
+    m_free_indices.push_back(index);
+}
+
+bool EntityRegistry::IsAlive(Entity entity) const {
+    uint32_t index = GetIndex(entity);
+    if (index >= m_slots.size()) {
+        return false;
+    }
+    auto& slot = m_slots[index];
+    return slot.m_alive && slot.m_generation == GetGeneration(entity);
+}
+
+uint32_t EntityRegistry::GetIndexRange() const {
+    return static_cast<uint32_t>(m_slots.size());
+}
+
+uint32_t EntityRegistry::GetAliveCount() const {
+    return m_alive_count;
+}
@@ -173,6 +173,21 @@ Vec2 GetPosition(const Mat33& m) {
     return Vec2{m.Get(2, 0), m.Get(2, 1)};
 }
 
+bool Mat33::operator==(const Mat33& o) const {
+    for (size_t x = 0; x < 3; x++) {
+        for (size_t y = 0; y < 3; y++) {
+            if (m_data[x][y] != o.m_data[x][y]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Mat33::operator!=(const Mat33& o) const {
+    return !(*this == o);
+}
+
 float Mat33::Get(size_t x, size_t y) const {
     return m_data[x][y];
 }
@@ -305,13 +320,17 @@ const Mat33& Transform::GetGlobalMat() const {
 void Transform::UpdateMat(const Transform* parent) {
     m_mat = Mat33::CreateTranslation(m_position) *
             Mat33::CreateRotation(m_rotation) * Mat33::CreateScale(m_scale);
-    if (parent) {
-        m_global_mat = parent->GetGlobalMat() * m_mat;
-    } else {
-        m_global_mat = m_mat;
+    Mat33 global_mat = parent ? parent->GetGlobalMat() * m_mat : m_mat;
+    if (global_mat != m_global_mat) {
+        m_global_mat = global_mat;
+        m_version++;
     }
 }
 
+uint32_t Transform::GetVersion() const {
+    return m_version;
+}
+
 Radians GetAngle(const Vec2& norm_a, const Vec2& norm_b) {
     float c = norm_a.Dot(norm_b);
     float s = norm_a.Cross(norm_b);
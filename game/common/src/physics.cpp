@@ -2,11 +2,15 @@
 
 #include "common/context.hpp"
 #include "common/debug_drawer.hpp"
+#include "common/log.hpp"
 #include "common/macros.hpp"
 #include "common/math.hpp"
+#include "imgui.h"
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include <limits>
 
 #include "common/profile.hpp"
@@ -352,10 +356,9 @@ bool PhysicsShape::IsQueryEnabled() const {
     return m_enable_query;
 }
 
-void PhysicsScene::Chunks::getOverlapChunkRange(const Rect &bounding_box,
-                                                const Vec2 &topleft,
-                                                Range2D<int> &out_chunk_range,
-                                                Range2D<int> &out_tile_range) {
+void PhysicsScene::Chunks::getOverlapChunkRange(
+    const Rect &bounding_box, const Vec2 &topleft,
+    Range2D<int> &out_chunk_range) {
     const float ceil_constant = 0.5;
 
     Vec2 offset_center = bounding_box.m_center - topleft;
@@ -374,30 +377,6 @@ void PhysicsScene::Chunks::getOverlapChunkRange(const Rect &bounding_box,
     out_chunk_range.m_y.m_begin = std::floor(min_y / (float)m_chunk_extent.h);
     out_chunk_range.m_y.m_end =
         std::ceil(max_y / (float)m_chunk_extent.h + ceil_constant);
-
-    auto positive_mod = [](int a, int b) {
-        int r = a % b;
-        return r < 0 ? r + b : r;
-    };
-    out_tile_range.m_x.m_begin = positive_mod(min_x, m_chunk_extent.w);
-    out_tile_range.m_y.m_begin = positive_mod(min_y, m_chunk_extent.h);
-    out_tile_range.m_x.m_end = positive_mod(max_x, m_chunk_extent.w);
-    out_tile_range.m_y.m_end = positive_mod(max_y, m_chunk_extent.h);
-}
-
-void PhysicsScene::Chunks::getTileRangeInCurrentChunk(
-    const Range2D<int> &chunk_range, const Range2D<int> &tile_range, int x,
-    int y, Range2D<int> &out_tile_range) {
-    out_tile_range.m_x.m_begin =
-        x == chunk_range.m_x.m_begin ? tile_range.m_x.m_begin : 0;
-    out_tile_range.m_x.m_end = x == chunk_range.m_x.m_end - 1
-                                   ? tile_range.m_x.m_end
-                                   : (int)m_chunk_extent.w;
-    out_tile_range.m_y.m_begin =
-        y == chunk_range.m_y.m_begin ? tile_range.m_y.m_begin : 0;
-    out_tile_range.m_y.m_end = y == chunk_range.m_y.m_end - 1
-                                   ? tile_range.m_y.m_end
-                                   : (int)m_chunk_extent.h;
 }
 
 void PhysicsScene::TilemapCollision::DeletorForProxy::operator()(
@@ -461,9 +440,9 @@ PhysicsShape *PhysicsScene::CreateShapeInChunk(
     auto bounding = computeShapeBoundingBox(definition);
 
     auto &chunks = tilemap_collision->m_chunks;
-    Range2D<int> chunk_range, tile_range;
+    Range2D<int> chunk_range;
     chunks.getOverlapChunkRange(bounding, tilemap_collision->GetTopLeft(),
-                                chunk_range, tile_range);
+                                chunk_range);
 
     if (chunk_range.m_x.m_begin < 0 || chunk_range.m_y.m_begin < 0) {
         LOGE("chunk range begin is negative! ({}, {})", chunk_range.m_x.m_begin,
@@ -482,23 +461,7 @@ PhysicsShape *PhysicsScene::CreateShapeInChunk(
 
     for (int y = chunk_range.m_y.m_begin; y < chunk_range.m_y.m_end; y++) {
         for (int x = chunk_range.m_x.m_begin; x < chunk_range.m_x.m_end; x++) {
-            auto &chunk = chunks.m_chunks.Get(x, y);
-            if (chunk.GetSize() == 0) {
-                chunk.ExpandTo(chunks.m_tile_extent.w, chunks.m_tile_extent.h);
-            }
-            Range2D<int> cur_tile_range;
-            chunks.getTileRangeInCurrentChunk(chunk_range, tile_range, x, y,
-                                              cur_tile_range);
-
-            for (int sy = cur_tile_range.m_y.m_begin;
-                 sy < cur_tile_range.m_y.m_end; sy++) {
-                for (int sx = cur_tile_range.m_x.m_begin;
-                     sx < cur_tile_range.m_x.m_end; sx++) {
-                    TL_CONTINUE_IF_FALSE(chunk.InRange(sx, sy));
-                    auto &actors = chunk.Get(sx, sy);
-                    actors.push_back(actor.get());
-                }
-            }
+            chunks.m_chunks.Get(x, y).push_back(actor.get());
         }
     }
 
@@ -513,8 +476,75 @@ PhysicsScene::TilemapCollision *PhysicsScene::CreateTilemapCollision(
         .get();
 }
 
+const Rect *PhysicsScene::TileGrid::GetTileRect(const Vec2UI &chunk_extent,
+                                                int x, int y) const {
+    if (x < 0 || y < 0) {
+        return nullptr;
+    }
+
+    size_t chunk_x = x / chunk_extent.w;
+    size_t chunk_y = y / chunk_extent.h;
+    if (chunk_x >= m_chunks.GetWidth() || chunk_y >= m_chunks.GetHeight()) {
+        return nullptr;
+    }
+
+    auto &chunk = m_chunks.Get(chunk_x, chunk_y);
+    TL_RETURN_VALUE_IF_TRUE(chunk.m_occupancy.empty(), nullptr);
+
+    size_t idx = (y % chunk_extent.h) * chunk_extent.w + x % chunk_extent.w;
+    if (!(chunk.m_occupancy[idx / 64] & (uint64_t{1} << (idx % 64)))) {
+        return nullptr;
+    }
+    return &m_tile_rects[chunk.m_rect_indices[idx]];
+}
+
+void PhysicsScene::AddGridTile(TilemapCollision *tilemap_collision,
+                               const Vec2UI &tile, const Rect &rect) {
+    TL_RETURN_IF_NULL(tilemap_collision);
+
+    auto &grid = tilemap_collision->m_grid;
+    auto &chunk_extent = tilemap_collision->m_chunks.m_chunk_extent;
+
+    auto it = std::find_if(grid.m_tile_rects.begin(), grid.m_tile_rects.end(),
+                           [&](const Rect &r) {
+                               return r.m_center == rect.m_center &&
+                                      r.m_half_size == rect.m_half_size;
+                           });
+    size_t rect_index = it - grid.m_tile_rects.begin();
+    if (it == grid.m_tile_rects.end()) {
+        TL_RETURN_IF_FALSE_WITH_LOG(
+            rect_index <= std::numeric_limits<uint16_t>::max(), LOGE,
+            "too many kinds of tile rect in tile grid");
+        grid.m_tile_rects.push_back(rect);
+    }
+
+    size_t chunk_x = tile.x / chunk_extent.w;
+    size_t chunk_y = tile.y / chunk_extent.h;
+    if (!grid.m_chunks.InRange(chunk_x, chunk_y)) {
+        grid.m_chunks.ExpandTo(chunk_x + 1, chunk_y + 1);
+    }
+
+    auto &chunk = grid.m_chunks.Get(chunk_x, chunk_y);
+    size_t tile_count = chunk_extent.w * chunk_extent.h;
+    if (chunk.m_occupancy.empty()) {
+        chunk.m_occupancy.resize((tile_count + 63) / 64);
+        chunk.m_rect_indices.resize(tile_count);
+    }
+
+    size_t idx =
+        (tile.y % chunk_extent.h) * chunk_extent.w + tile.x % chunk_extent.w;
+    chunk.m_occupancy[idx / 64] |= uint64_t{1} << (idx % 64);
+    chunk.m_rect_indices[idx] = static_cast<uint16_t>(rect_index);
+}
+
 void PhysicsScene::RemoveTilemapCollision(TilemapCollision *collision) {
     TL_RETURN_IF_NULL(collision);
+
+    // shapes die with the collision, don't leave dangling contacts behind
+    for (auto &shape : collision->m_physics_shapes) {
+        removeContacts(shape.get());
+    }
+
     m_tilemap_collisions.erase(
         std::remove_if(m_tilemap_collisions.begin(), m_tilemap_collisions.end(),
                        [=](auto &value) { return value.get() == collision; }),
@@ -524,6 +554,8 @@ void PhysicsScene::RemoveTilemapCollision(TilemapCollision *collision) {
 void PhysicsScene::RemoveShape(PhysicsShape *shape) {
     TL_RETURN_IF_NULL(shape);
 
+    removeContacts(shape);
+
     if (shape->GetStorageType() == PhysicsStorageType::Normal) {
         m_shapes.erase(
             std::remove_if(m_shapes.begin(), m_shapes.end(),
@@ -538,6 +570,19 @@ void PhysicsScene::RemoveShape(PhysicsShape *shape) {
     }
 }
 
+void PhysicsScene::beginQuery() {
+    // 0 is the stamp of never tested shapes
+    if (++m_query_id == 0) {
+        ++m_query_id;
+    }
+}
+
+bool PhysicsScene::markQueried(PhysicsShape &shape) {
+    TL_RETURN_FALSE_IF_TRUE(shape.m_query_id == m_query_id);
+    shape.m_query_id = m_query_id;
+    return true;
+}
+
 void PhysicsScene::removeShapeInChunk(TilemapCollision *tilemap_collision,
                                       PhysicsShape *actor) {
     if (!tilemap_collision || !actor) {
@@ -547,29 +592,17 @@ void PhysicsScene::removeShapeInChunk(TilemapCollision *tilemap_collision,
     auto &chunks = tilemap_collision->m_chunks;
 
     auto bounding = computeShapeBoundingBox(*actor);
-    Range2D<int> chunk_range, tile_range;
+    Range2D<int> chunk_range;
     chunks.getOverlapChunkRange(bounding, tilemap_collision->GetTopLeft(),
-                                chunk_range, tile_range);
+                                chunk_range);
     for (int y = chunk_range.m_y.m_begin; y < chunk_range.m_y.m_end; y++) {
         for (int x = chunk_range.m_x.m_begin; x < chunk_range.m_x.m_end; x++) {
             if (!chunks.m_chunks.InRange(x, y)) {
                 continue;
             }
-            auto &chunk = chunks.m_chunks.Get(x, y);
-            Range2D<int> cur_tile_range;
-            chunks.getTileRangeInCurrentChunk(chunk_range, tile_range, x, y,
-                                              cur_tile_range);
-
-            for (int sy = cur_tile_range.m_y.m_begin;
-                 sy < cur_tile_range.m_y.m_end; sy++) {
-                for (int sx = cur_tile_range.m_x.m_begin;
-                     sx < cur_tile_range.m_x.m_end; sx++) {
-                    auto &actors = chunk.Get(sx, sy);
-                    actors.erase(
-                        std::remove(actors.begin(), actors.end(), actor),
-                        actors.end());
-                }
-            }
+            auto &actors = chunks.m_chunks.Get(x, y);
+            actors.erase(std::remove(actors.begin(), actors.end(), actor),
+                         actors.end());
         }
     }
 
@@ -582,12 +615,15 @@ void PhysicsScene::removeShapeInChunk(TilemapCollision *tilemap_collision,
 
 uint32_t PhysicsScene::Sweep(const PhysicsShape &shape, const Vec2 &dir,
                              float dist, SweepResult *out_result,
-                             size_t out_size) {
+                             size_t out_size, Entity ignore_entity) {
     if (!out_result || out_size == 0) {
         return 0;
     }
 
+    PHYSICS_STAT_QUERY(m_stats.m_sweep);
+
     m_cached_sweep_results.clear();
+    beginQuery();
 
     Rect sweep_rect = computeSweepBoundingBox(shape, dir, dist);
 
@@ -596,10 +632,12 @@ uint32_t PhysicsScene::Sweep(const PhysicsShape &shape, const Vec2 &dir,
 
     // sweep normal actor
     for (auto &target_shape : m_shapes) {
-        TL_CONTINUE_IF_FALSE(checkNeedQuery(shape, *target_shape));
+        TL_CONTINUE_IF_FALSE(
+            checkNeedQuery(shape, *target_shape, ignore_entity));
         Rect bounding_rect = computeShapeBoundingBox(*target_shape);
 
         TL_CONTINUE_IF_FALSE(IsRectsIntersect(bounding_rect, sweep_rect));
+        PHYSICS_STAT_ADD(m_stats.m_sweep, m_candidate_count, 1);
         auto result = sweepShape(shape, *target_shape, dir);
         TL_CONTINUE_IF_FALSE(result && result->m_t <= dist);
 
@@ -615,6 +653,9 @@ uint32_t PhysicsScene::Sweep(const PhysicsShape &shape, const Vec2 &dir,
 
     // sweep chunk actor
     for (auto &tilemap_collision : m_tilemap_collisions) {
+        sweepTileGrid(shape, *tilemap_collision, dir, dist, out_size,
+                      ignore_entity);
+
         auto &chunks = tilemap_collision->m_chunks;
         Rect tilemap_rect;
         Vec2UI chunk_size =
@@ -629,49 +670,43 @@ uint32_t PhysicsScene::Sweep(const PhysicsShape &shape, const Vec2 &dir,
 
         TL_CONTINUE_IF_FALSE(IsRectsIntersect(tilemap_rect, sweep_rect));
 
-        Range2D<int> chunk_range, tile_range;
+        Range2D<int> chunk_range;
         chunks.getOverlapChunkRange(sweep_rect, tilemap_collision->GetTopLeft(),
-                                    chunk_range, tile_range);
+                                    chunk_range);
 
         for (int y = chunk_range.m_y.m_begin; y < chunk_range.m_y.m_end; y++) {
             for (int x = chunk_range.m_x.m_begin; x < chunk_range.m_x.m_end;
                  x++) {
                 TL_CONTINUE_IF_FALSE(chunks.m_chunks.InRange(x, y));
 
-                auto &chunk = chunks.m_chunks.Get(x, y);
-                Range2D<int> cur_tile_range;
-                chunks.getTileRangeInCurrentChunk(chunk_range, tile_range, x, y,
-                                                  cur_tile_range);
-
-                for (int sy = cur_tile_range.m_y.m_begin;
-                     sy < cur_tile_range.m_y.m_end; sy++) {
-                    for (int sx = cur_tile_range.m_x.m_begin;
-                         sx < cur_tile_range.m_x.m_end; sx++) {
-                        TL_CONTINUE_IF_FALSE(chunk.InRange(sx, sy));
-
-                        auto &shapes = chunk.Get(sx, sy);
-                        for (auto &target_shape : shapes) {
-                            TL_CONTINUE_IF_FALSE(
-                                checkNeedQuery(shape, *target_shape));
-                            std::optional<HitResult> result =
-                                sweepShape(shape, *target_shape, dir);
-                            TL_CONTINUE_IF_FALSE(result && result->m_t <= dist);
-                            SweepResult sweep_result;
-                            sweep_result.m_t = result->m_t;
-                            sweep_result.m_normal = result->m_normal;
-                            sweep_result.m_flags = result->m_flags;
-                            sweep_result.m_entity = target_shape->GetOwner();
-                            sweep_result.m_is_initial_overlap =
-                                result->m_is_initial_overlap;
-                            sweep_result.m_shape = target_shape;
-                            m_cached_sweep_results.push_back(sweep_result);
-                        }
-                    }
+                PHYSICS_STAT_ADD(m_stats.m_sweep, m_cell_count, 1);
+                for (auto target_shape : chunks.m_chunks.Get(x, y)) {
+                    TL_CONTINUE_IF_FALSE(markQueried(*target_shape));
+                    TL_CONTINUE_IF_FALSE(checkNeedQuery(shape, *target_shape,
+                                                        ignore_entity));
+                    TL_CONTINUE_IF_FALSE(IsRectsIntersect(
+                        computeShapeBoundingBox(*target_shape), sweep_rect));
+                    PHYSICS_STAT_ADD(m_stats.m_sweep, m_candidate_count, 1);
+                    std::optional<HitResult> result =
+                        sweepShape(shape, *target_shape, dir);
+                    TL_CONTINUE_IF_FALSE(result && result->m_t <= dist);
+                    SweepResult sweep_result;
+                    sweep_result.m_t = result->m_t;
+                    sweep_result.m_normal = result->m_normal;
+                    sweep_result.m_flags = result->m_flags;
+                    sweep_result.m_entity = target_shape->GetOwner();
+                    sweep_result.m_is_initial_overlap =
+                        result->m_is_initial_overlap;
+                    sweep_result.m_shape = target_shape;
+                    m_cached_sweep_results.push_back(sweep_result);
                 }
             }
         }
     }
 
+    PHYSICS_STAT_ADD(m_stats.m_sweep, m_hit_count,
+                     m_cached_sweep_results.size());
+
     if (m_cached_sweep_results.empty()) {
         return 0;
     }
@@ -688,13 +723,64 @@ uint32_t PhysicsScene::Sweep(const PhysicsShape &shape, const Vec2 &dir,
     return count;
 }
 
-uint32_t PhysicsScene::Overlap(const PhysicsShape &shape,
-                               OverlapResult *out_result, size_t out_size) {
-    if (!out_result || out_size == 0) {
-        return 0;
+std::optional<SweepResult> PhysicsScene::Raycast(const RaycastInfo &ray) {
+    SweepResult result;
+    TL_RETURN_VALUE_IF_FALSE(RaycastAll(ray, &result, 1) > 0, std::nullopt);
+    return result;
+}
+
+uint32_t PhysicsScene::RaycastAll(const RaycastInfo &ray,
+                                  SweepResult *out_result, size_t out_size) {
+    // a ray is sweeping a point, so rect kernels degenerate to
+    // RaycastRect/RaycastCircle while reusing chunk & tile grid culling
+    PhysicsShapeDefinition definition;
+    definition.m_is_rect = true;
+    definition.m_rect.m_center = ray.m_origin;
+    definition.m_collision_mask = ray.m_collision_mask;
+    PhysicsShape point{null_entity, definition, PhysicsStorageType::Normal};
+    return Sweep(point, ray.m_dir, ray.m_dist, out_result, out_size,
+                 ray.m_ignore_entity);
+}
+
+uint32_t PhysicsScene::RaycastBatch(const RaycastInfo *rays, size_t count,
+                                    std::optional<SweepResult> *out_results) {
+    PROFILE_SECTION();
+
+    uint32_t hit_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        out_results[i] = Raycast(rays[i]);
+        if (out_results[i]) {
+            hit_count++;
+        }
     }
+    return hit_count;
+}
+
+uint32_t PhysicsScene::ShapeCastBatch(const ShapeCastInfo *casts,
+                                      size_t count,
+                                      std::optional<SweepResult> *out_results) {
+    PROFILE_SECTION();
+
+    uint32_t hit_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto &cast = casts[i];
+        out_results[i] = std::nullopt;
+        TL_CONTINUE_IF_NULL(cast.m_shape);
+
+        SweepResult result;
+        TL_CONTINUE_IF_FALSE(
+            Sweep(*cast.m_shape, cast.m_dir, cast.m_dist, &result, 1) > 0);
+        out_results[i] = result;
+        hit_count++;
+    }
+    return hit_count;
+}
+
+void PhysicsScene::overlap(const PhysicsShape &shape) {
+    PHYSICS_STAT_QUERY(m_stats.m_overlap);
 
     m_cached_overlaps_results.clear();
+    beginQuery();
 
     auto bounding_box = computeShapeBoundingBox(shape);
 
@@ -702,8 +788,9 @@ uint32_t PhysicsScene::Overlap(const PhysicsShape &shape,
         TL_CONTINUE_IF_FALSE(checkNeedQuery(shape, *target_shape));
         Rect bounding_rect = computeShapeBoundingBox(*target_shape);
 
-        TL_CONTINUE_IF_FALSE(IsRectsIntersect(bounding_rect, bounding_box) &&
-                             Overlap(shape, *target_shape));
+        TL_CONTINUE_IF_FALSE(IsRectsIntersect(bounding_rect, bounding_box));
+        PHYSICS_STAT_ADD(m_stats.m_overlap, m_candidate_count, 1);
+        TL_CONTINUE_IF_FALSE(Overlap(shape, *target_shape));
         OverlapResult result;
         result.m_dst_entity = target_shape->GetOwner();
         result.m_dst_shape = target_shape.get();
@@ -711,6 +798,8 @@ uint32_t PhysicsScene::Overlap(const PhysicsShape &shape,
     }
 
     for (auto &tilemap_collision : m_tilemap_collisions) {
+        overlapTileGrid(shape, *tilemap_collision);
+
         Rect tilemap_rect;
         auto &chunks = tilemap_collision->m_chunks;
         Vec2UI chunk_size =
@@ -725,43 +814,43 @@ uint32_t PhysicsScene::Overlap(const PhysicsShape &shape,
 
         TL_CONTINUE_IF_FALSE(IsRectsIntersect(tilemap_rect, bounding_box));
 
-        Range2D<int> chunk_range, tile_range;
+        Range2D<int> chunk_range;
         chunks.getOverlapChunkRange(bounding_box, tilemap_collision->GetTopLeft(),
-                                    chunk_range, tile_range);
+                                    chunk_range);
 
         for (int y = chunk_range.m_y.m_begin; y < chunk_range.m_y.m_end; y++) {
             for (int x = chunk_range.m_x.m_begin; x < chunk_range.m_x.m_end;
                  x++) {
                 TL_CONTINUE_IF_FALSE(chunks.m_chunks.InRange(x, y));
 
-                auto &chunk = chunks.m_chunks.Get(x, y);
-                Range2D<int> cur_tile_range;
-                chunks.getTileRangeInCurrentChunk(chunk_range, tile_range, x, y,
-                                                  cur_tile_range);
-
-                for (int sy = cur_tile_range.m_y.m_begin;
-                     sy < cur_tile_range.m_y.m_end; sy++) {
-                    for (int sx = cur_tile_range.m_x.m_begin;
-                         sx < cur_tile_range.m_x.m_end; sx++) {
-                        TL_CONTINUE_IF_FALSE(chunk.InRange(sx, sy));
-
-                        auto &target_shapes = chunk.Get(sx, sy);
-                        for (auto &target_shape : target_shapes) {
-                            TL_CONTINUE_IF_FALSE(
-                                checkNeedQuery(shape, *target_shape) &&
-                                Overlap(shape, *target_shape));
-
-                            OverlapResult result;
-                            result.m_dst_entity = target_shape->GetOwner();
-                            result.m_dst_shape = target_shape;
-                            m_cached_overlaps_results.push_back(result);
-                        }
-                    }
+                PHYSICS_STAT_ADD(m_stats.m_overlap, m_cell_count, 1);
+                for (auto target_shape : chunks.m_chunks.Get(x, y)) {
+                    TL_CONTINUE_IF_FALSE(markQueried(*target_shape));
+                    TL_CONTINUE_IF_FALSE(checkNeedQuery(shape, *target_shape));
+                    PHYSICS_STAT_ADD(m_stats.m_overlap, m_candidate_count, 1);
+                    TL_CONTINUE_IF_FALSE(Overlap(shape, *target_shape));
+
+                    OverlapResult result;
+                    result.m_dst_entity = target_shape->GetOwner();
+                    result.m_dst_shape = target_shape;
+                    m_cached_overlaps_results.push_back(result);
                 }
             }
         }
     }
 
+    PHYSICS_STAT_ADD(m_stats.m_overlap, m_hit_count,
+                     m_cached_overlaps_results.size());
+}
+
+uint32_t PhysicsScene::Overlap(const PhysicsShape &shape,
+                               OverlapResult *out_result, size_t out_size) {
+    if (!out_result || out_size == 0) {
+        return 0;
+    }
+
+    overlap(shape);
+
     if (m_cached_overlaps_results.empty()) {
         return 0;
     }
@@ -774,6 +863,277 @@ uint32_t PhysicsScene::Overlap(const PhysicsShape &shape,
     return count;
 }
 
+namespace {
+
+bool contactSrcLess(const Contact &c1, const Contact &c2) {
+    return std::less<const PhysicsShape *>{}(c1.m_src_shape, c2.m_src_shape);
+}
+
+bool contactLess(const Contact &c1, const Contact &c2) {
+    if (c1.m_src_shape != c2.m_src_shape) {
+        return contactSrcLess(c1, c2);
+    }
+    return std::less<const PhysicsShape *>{}(c1.m_dst_shape, c2.m_dst_shape);
+}
+
+bool contactEqual(const Contact &c1, const Contact &c2) {
+    return c1.m_src_shape == c2.m_src_shape &&
+           c1.m_dst_shape == c2.m_dst_shape;
+}
+
+}  // namespace
+
+void PhysicsScene::EnableContactTracking(PhysicsShape *shape) {
+    TL_RETURN_IF_NULL(shape);
+    TL_RETURN_IF_TRUE(std::find(m_contact_tracked_shapes.begin(),
+                                m_contact_tracked_shapes.end(),
+                                shape) != m_contact_tracked_shapes.end());
+    m_contact_tracked_shapes.push_back(shape);
+}
+
+void PhysicsScene::UpdateContacts() {
+    PROFILE_SECTION();
+    PHYSICS_STAT_QUERY(m_stats.m_contact);
+    PHYSICS_STAT_ADD(m_stats.m_contact, m_candidate_count,
+                     m_contact_tracked_shapes.size());
+
+    m_begin_contacts.clear();
+    m_persist_contacts.clear();
+    m_end_contacts.swap(m_removed_contacts);
+    m_removed_contacts.clear();
+
+    auto &new_contacts = m_cached_new_contacts;
+    new_contacts.clear();
+    for (auto shape : m_contact_tracked_shapes) {
+        if (!shape->IsQueryEnabled()) {
+            Contact key;
+            key.m_src_shape = shape;
+            auto [begin, end] = std::equal_range(
+                m_contacts.begin(), m_contacts.end(), key, contactSrcLess);
+            new_contacts.insert(new_contacts.end(), begin, end);
+            continue;
+        }
+
+        overlap(*shape);
+        for (auto &result : m_cached_overlaps_results) {
+            // tile grid has no shape to track
+            TL_CONTINUE_IF_NULL(result.m_dst_shape);
+
+            Contact contact;
+            contact.m_src_shape = shape;
+            contact.m_dst_shape = result.m_dst_shape;
+            contact.m_dst_entity = result.m_dst_entity;
+            new_contacts.push_back(contact);
+        }
+    }
+
+    // shape in chunk may be reported once per covered tile
+    std::sort(new_contacts.begin(), new_contacts.end(), contactLess);
+    new_contacts.erase(
+        std::unique(new_contacts.begin(), new_contacts.end(), contactEqual),
+        new_contacts.end());
+
+    auto old_it = m_contacts.begin();
+    auto new_it = new_contacts.begin();
+    while (old_it != m_contacts.end() || new_it != new_contacts.end()) {
+        if (new_it == new_contacts.end() ||
+            (old_it != m_contacts.end() && contactLess(*old_it, *new_it))) {
+            m_end_contacts.push_back(*old_it++);
+        } else if (old_it == m_contacts.end() ||
+                   contactLess(*new_it, *old_it)) {
+            m_begin_contacts.push_back(*new_it++);
+        } else {
+            m_persist_contacts.push_back(*new_it++);
+            old_it++;
+        }
+    }
+    std::sort(m_end_contacts.begin(), m_end_contacts.end(), contactLess);
+    PHYSICS_STAT_ADD(m_stats.m_contact, m_hit_count, new_contacts.size());
+
+    m_contacts.swap(new_contacts);
+}
+
+PhysicsScene::ContactRange PhysicsScene::GetContacts(const PhysicsShape &shape,
+                                                     ContactState state) const {
+    const std::vector<Contact> *contacts = &m_persist_contacts;
+    if (state == ContactState::Begin) {
+        contacts = &m_begin_contacts;
+    } else if (state == ContactState::End) {
+        contacts = &m_end_contacts;
+    }
+
+    Contact key;
+    key.m_src_shape = const_cast<PhysicsShape *>(&shape);
+    auto [begin, end] = std::equal_range(contacts->begin(), contacts->end(),
+                                         key, contactSrcLess);
+
+    ContactRange range;
+    range.m_begin = contacts->data() + (begin - contacts->begin());
+    range.m_end = contacts->data() + (end - contacts->begin());
+    return range;
+}
+
+void PhysicsScene::removeContacts(PhysicsShape *shape) {
+    m_contact_tracked_shapes.erase(
+        std::remove(m_contact_tracked_shapes.begin(),
+                    m_contact_tracked_shapes.end(), shape),
+        m_contact_tracked_shapes.end());
+
+    auto is_related = [=](const Contact &contact) {
+        return contact.m_src_shape == shape || contact.m_dst_shape == shape;
+    };
+
+    for (auto &contact : m_contacts) {
+        if (contact.m_dst_shape == shape && contact.m_src_shape != shape) {
+            Contact removed = contact;
+            removed.m_is_dst_removed = true;
+            m_removed_contacts.push_back(removed);
+        }
+    }
+    m_contacts.erase(
+        std::remove_if(m_contacts.begin(), m_contacts.end(), is_related),
+        m_contacts.end());
+
+    for (auto contacts :
+         {&m_begin_contacts, &m_persist_contacts, &m_end_contacts}) {
+        contacts->erase(
+            std::remove_if(contacts->begin(), contacts->end(), is_related),
+            contacts->end());
+    }
+}
+
+uint64_t PhysicsScene::ComputeStateHash() const {
+    constexpr uint64_t FNVOffsetBasis = 14695981039346656037ull;
+    constexpr uint64_t FNVPrime = 1099511628211ull;
+
+    uint64_t hash = FNVOffsetBasis;
+    auto hash_float = [&](float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 4; i++) {
+            hash ^= (bits >> (i * 8)) & 0xFF;
+            hash *= FNVPrime;
+        }
+    };
+
+    auto hash_shape = [&](const PhysicsShape &shape) {
+        if (auto rect = shape.AsRect()) {
+            hash_float(rect->m_center.x);
+            hash_float(rect->m_center.y);
+            hash_float(rect->m_half_size.w);
+            hash_float(rect->m_half_size.h);
+        } else if (auto circle = shape.AsCircle()) {
+            hash_float(circle->m_center.x);
+            hash_float(circle->m_center.y);
+            hash_float(circle->m_radius);
+        }
+    };
+
+    for (auto &shape : m_shapes) {
+        hash_shape(*shape);
+    }
+    for (auto &tilemap_collision : m_tilemap_collisions) {
+        hash_float(tilemap_collision->GetTopLeft().x);
+        hash_float(tilemap_collision->GetTopLeft().y);
+        for (auto &shape : tilemap_collision->m_physics_shapes) {
+            hash_shape(*shape);
+        }
+    }
+    return hash;
+}
+
+void PhysicsScene::UpdateStats(TimeType elapse) {
+#ifdef TL_ENABLE_PHYSICS_STATS
+    PROFILE_PLOT("physics/sweep",
+                 static_cast<int64_t>(m_stats.m_sweep.m_query_count));
+    PROFILE_PLOT("physics/sweep_candidates",
+                 static_cast<int64_t>(m_stats.m_sweep.m_candidate_count));
+    PROFILE_PLOT("physics/sweep_cells",
+                 static_cast<int64_t>(m_stats.m_sweep.m_cell_count));
+    PROFILE_PLOT("physics/sweep_ms", m_stats.m_sweep.m_time * 1000.0);
+    PROFILE_PLOT("physics/overlap",
+                 static_cast<int64_t>(m_stats.m_overlap.m_query_count));
+    PROFILE_PLOT("physics/overlap_candidates",
+                 static_cast<int64_t>(m_stats.m_overlap.m_candidate_count));
+    PROFILE_PLOT("physics/overlap_cells",
+                 static_cast<int64_t>(m_stats.m_overlap.m_cell_count));
+    PROFILE_PLOT("physics/overlap_ms", m_stats.m_overlap.m_time * 1000.0);
+    PROFILE_PLOT("physics/contacts",
+                 static_cast<int64_t>(m_stats.m_contact.m_hit_count));
+    PROFILE_PLOT("physics/contact_ms", m_stats.m_contact.m_time * 1000.0);
+
+    m_last_frame_stats = m_stats;
+    m_stats = {};
+
+    TL_RETURN_IF_FALSE(m_stats_log_interval > 0);
+
+    m_log_stats += m_last_frame_stats;
+    m_log_frame_count++;
+    m_log_elapse += elapse;
+    TL_RETURN_IF_TRUE(m_log_elapse < m_stats_log_interval);
+
+    auto log_query = [&](const char *name, const PhysicsQueryStats &stats) {
+        float frames = m_log_frame_count;
+        LOGI("[Physics]: {} per frame: {:.1f} queries, {:.1f} candidates, "
+             "{:.1f} hits, {:.1f} cells, {:.3f}ms",
+             name, stats.m_query_count / frames,
+             stats.m_candidate_count / frames, stats.m_hit_count / frames,
+             stats.m_cell_count / frames, stats.m_time * 1000.0 / frames);
+    };
+    log_query("sweep", m_log_stats.m_sweep);
+    log_query("overlap", m_log_stats.m_overlap);
+    log_query("contact", m_log_stats.m_contact);
+
+    m_log_stats = {};
+    m_log_frame_count = 0;
+    m_log_elapse = 0;
+#endif
+}
+
+void PhysicsScene::SetStatsLogInterval(TimeType interval) {
+    m_stats_log_interval = interval;
+}
+
+const PhysicsStats &PhysicsScene::GetLastFrameStats() const {
+    return m_last_frame_stats;
+}
+
+void PhysicsScene::RenderStatsPanel() const {
+#ifdef TL_ENABLE_PHYSICS_STATS
+    if (!ImGui::Begin("Physics Stats")) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::BeginTable("physics_stats", 6)) {
+        for (auto name : {"", "queries", "candidates", "hits", "cells", "ms"}) {
+            ImGui::TableSetupColumn(name);
+        }
+        ImGui::TableHeadersRow();
+
+        auto show_query = [](const char *name,
+                             const PhysicsQueryStats &stats) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            for (uint32_t value :
+                 {stats.m_query_count, stats.m_candidate_count,
+                  stats.m_hit_count, stats.m_cell_count}) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", value);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.m_time * 1000.0);
+        };
+        show_query("sweep", m_last_frame_stats.m_sweep);
+        show_query("overlap", m_last_frame_stats.m_overlap);
+        show_query("contact", m_last_frame_stats.m_contact);
+        ImGui::EndTable();
+    }
+    ImGui::End();
+#endif
+}
+
 bool PhysicsScene::IsEnableDebugDraw() const {
     return m_should_debug_draw;
 }
@@ -810,38 +1170,45 @@ void PhysicsScene::RenderDebug() const {
 
     // draw tiles
     for (auto &tilemap : m_tilemap_collisions) {
-        auto &chunks = tilemap->m_chunks;
-        for (int x = 0; x < chunks.m_chunks.GetWidth(); x++) {
-            for (int y = 0; y < chunks.m_chunks.GetHeight(); y++) {
-                auto &chunk = chunks.m_chunks.Get(x, y);
-                for (int sx = 0; sx < chunk.GetWidth(); sx++) {
-                    for (int sy = 0; sy < chunk.GetHeight(); sy++) {
-                        for (auto &shape : chunk.Get(sx, sy)) {
-                            TL_CONTINUE_IF_NULL(shape);
-
-                            switch (shape->GetType()) {
-                                case PhysicsShape::Type::Rect:
-                                    debug_drawer->DrawRect(
-                                        *shape->AsRect(),
-
-                                        shape->IsQueryEnabled()
-                                            ? EnableQueryColor
-                                            : DisableQueryColor,
-                                        IDebugDrawer::kOneFrame, true);
-                                    break;
-                                case PhysicsShape::Type::Circle:
-                                    debug_drawer->DrawCircle(
-                                        *shape->AsCircle(),
-                                        shape->IsQueryEnabled()
-                                            ? EnableQueryColor
-                                            : DisableQueryColor,
-                                        IDebugDrawer::kOneFrame, true);
-                                    break;
-                                default:;
-                            }
-                        }
-                    }
-                }
+        for (auto &shape : tilemap->m_physics_shapes) {
+            switch (shape->GetType()) {
+                case PhysicsShape::Type::Rect:
+                    debug_drawer->DrawRect(*shape->AsRect(),
+                                           shape->IsQueryEnabled()
+                                               ? EnableQueryColor
+                                               : DisableQueryColor,
+                                           IDebugDrawer::kOneFrame, true);
+                    break;
+                case PhysicsShape::Type::Circle:
+                    debug_drawer->DrawCircle(*shape->AsCircle(),
+                                             shape->IsQueryEnabled()
+                                                 ? EnableQueryColor
+                                                 : DisableQueryColor,
+                                             IDebugDrawer::kOneFrame, true);
+                    break;
+                default:;
+            }
+        }
+    }
+
+    // draw tile grid
+    for (auto &tilemap_collision : m_tilemap_collisions) {
+        auto &grid = tilemap_collision->m_grid;
+        auto &chunks = tilemap_collision->m_chunks;
+        int width = grid.m_chunks.GetWidth() * chunks.m_chunk_extent.w;
+        int height = grid.m_chunks.GetHeight() * chunks.m_chunk_extent.h;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                auto rect = grid.GetTileRect(chunks.m_chunk_extent, x, y);
+                TL_CONTINUE_IF_NULL(rect);
+
+                Rect world_rect = *rect;
+                world_rect.m_center +=
+                    tilemap_collision->GetTopLeft() +
+                    Vec2(x, y) * Vec2(chunks.m_tile_extent.w,
+                                      chunks.m_tile_extent.h);
+                debug_drawer->DrawRect(world_rect, EnableQueryColor,
+                                       IDebugDrawer::kOneFrame, true);
             }
         }
     }
@@ -983,10 +1350,207 @@ bool PhysicsScene::Overlap(const PhysicsShape &shape1,
 }
 
 bool PhysicsScene::checkNeedQuery(const PhysicsShape &src,
-                                  const PhysicsShape &target) const {
+                                  const PhysicsShape &target,
+                                  Entity ignore_entity) const {
     TL_RETURN_VALUE_IF_FALSE(&src != &target && target.IsQueryEnabled(), false);
+    TL_RETURN_VALUE_IF_TRUE(
+        ignore_entity != null_entity && target.GetOwner() == ignore_entity,
+        false);
 
     auto layer = target.GetCollisionLayer();
 
     return src.GetCollisionMask().CanCollision(layer);
 }
+
+std::optional<HitResult> PhysicsScene::sweepShape(const PhysicsShape &shape,
+                                                  const Rect &rect,
+                                                  const Vec2 &dir) const {
+    if (shape.GetType() == PhysicsShape::Type::Circle) {
+        return SweepCircleRect(*shape.AsCircle(), rect, dir);
+    }
+    if (shape.GetType() == PhysicsShape::Type::Rect) {
+        return SweepRects(*shape.AsRect(), rect, dir);
+    }
+    return std::nullopt;
+}
+
+void PhysicsScene::sweepTileGrid(const PhysicsShape &shape,
+                                 const TilemapCollision &tilemap_collision,
+                                 const Vec2 &dir, float dist,
+                                 size_t out_size, Entity ignore_entity) {
+    auto &grid = tilemap_collision.m_grid;
+    TL_RETURN_IF_TRUE(out_size == 0 || grid.m_chunks.GetSize() == 0);
+    TL_RETURN_IF_TRUE(ignore_entity != null_entity &&
+                      grid.m_owner == ignore_entity);
+    TL_RETURN_IF_FALSE(
+        shape.GetCollisionMask().CanCollision(grid.m_collision_layer));
+
+    auto &chunk_extent = tilemap_collision.m_chunks.m_chunk_extent;
+    Vec2 tile_size(tilemap_collision.m_chunks.m_tile_extent.w,
+                   tilemap_collision.m_chunks.m_tile_extent.h);
+    int grid_width = grid.m_chunks.GetWidth() * chunk_extent.w;
+    int grid_height = grid.m_chunks.GetHeight() * chunk_extent.h;
+
+    // add a little skin for tolerance, same as normal shapes
+    Rect bounding = computeShapeBoundingBox(shape);
+    bounding.m_half_size += {1, 1};
+    Vec2 min = bounding.m_center - bounding.m_half_size -
+               tilemap_collision.GetTopLeft();
+    Vec2 max = bounding.m_center + bounding.m_half_size -
+               tilemap_collision.GetTopLeft();
+
+    // t of hits sorted, only the nearest `out_size` hits are kept
+    auto &nearest_hits = m_cached_nearest_hits;
+    nearest_hits.clear();
+    float stop_t = dist;
+
+    auto visit_tiles = [&](const Range2D<int> &range) {
+        int x_begin = std::max(range.m_x.m_begin, 0);
+        int x_end = std::min(range.m_x.m_end, grid_width - 1);
+        int y_begin = std::max(range.m_y.m_begin, 0);
+        int y_end = std::min(range.m_y.m_end, grid_height - 1);
+        for (int y = y_begin; y <= y_end; y++) {
+            for (int x = x_begin; x <= x_end; x++) {
+                PHYSICS_STAT_ADD(m_stats.m_sweep, m_cell_count, 1);
+                auto rect = grid.GetTileRect(chunk_extent, x, y);
+                TL_CONTINUE_IF_NULL(rect);
+                PHYSICS_STAT_ADD(m_stats.m_sweep, m_candidate_count, 1);
+
+                Rect world_rect = *rect;
+                world_rect.m_center +=
+                    tilemap_collision.GetTopLeft() + Vec2(x, y) * tile_size;
+                auto result = sweepShape(shape, world_rect, dir);
+                TL_CONTINUE_IF_FALSE(result && result->m_t <= dist);
+
+                SweepResult sweep_result;
+                sweep_result.m_t = result->m_t;
+                sweep_result.m_normal = result->m_normal;
+                sweep_result.m_flags = result->m_flags;
+                sweep_result.m_entity = grid.m_owner;
+                sweep_result.m_is_initial_overlap =
+                    result->m_is_initial_overlap;
+                m_cached_sweep_results.push_back(sweep_result);
+
+                nearest_hits.insert(std::upper_bound(nearest_hits.begin(),
+                                                     nearest_hits.end(),
+                                                     result->m_t),
+                                    result->m_t);
+                if (nearest_hits.size() >= out_size) {
+                    nearest_hits.resize(out_size);
+                    stop_t = std::min(stop_t, nearest_hits.back());
+                }
+            }
+        }
+    };
+
+    // tile range covered by shape after moving `t`
+    auto covered_range = [&](float t) {
+        Vec2 offset = dir * t;
+        Range2D<int> range;
+        range.m_x.m_begin = std::floor((min.x + offset.x) / tile_size.w);
+        range.m_x.m_end = std::floor((max.x + offset.x) / tile_size.w);
+        range.m_y.m_begin = std::floor((min.y + offset.y) / tile_size.h);
+        range.m_y.m_end = std::floor((max.y + offset.y) / tile_size.h);
+        return range;
+    };
+
+    Range2D<int> range = covered_range(0);
+    visit_tiles(range);
+
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    int step_x = dir.x > 0 ? 1 : (dir.x < 0 ? -1 : 0);
+    int step_y = dir.y > 0 ? 1 : (dir.y < 0 ? -1 : 0);
+
+    // leading edge of shape, and t when it crosses next tile boundary
+    int lead_x = step_x > 0 ? range.m_x.m_end : range.m_x.m_begin;
+    int lead_y = step_y > 0 ? range.m_y.m_end : range.m_y.m_begin;
+    float t_delta_x = step_x ? tile_size.w / std::abs(dir.x) : inf;
+    float t_delta_y = step_y ? tile_size.h / std::abs(dir.y) : inf;
+    float t_next_x =
+        step_x ? ((lead_x + (step_x > 0)) * tile_size.w -
+                  (step_x > 0 ? max.x : min.x)) /
+                     dir.x
+               : inf;
+    float t_next_y =
+        step_y ? ((lead_y + (step_y > 0)) * tile_size.h -
+                  (step_y > 0 ? max.y : min.y)) /
+                     dir.y
+               : inf;
+
+    while (true) {
+        // leading edge leaves the grid, no more tiles on this axis
+        if ((step_x > 0 && lead_x >= grid_width - 1) ||
+            (step_x < 0 && lead_x <= 0)) {
+            t_next_x = inf;
+        }
+        if ((step_y > 0 && lead_y >= grid_height - 1) ||
+            (step_y < 0 && lead_y <= 0)) {
+            t_next_y = inf;
+        }
+
+        float t = std::min(t_next_x, t_next_y);
+        TL_BREAK_IF_TRUE(t > stop_t);
+
+        // only tiles in new column/row are newly covered, tiles covered by
+        // both are visited by the later one
+        range = covered_range(t);
+        if (t_next_x <= t_next_y) {
+            lead_x += step_x;
+            range.m_x.m_begin = range.m_x.m_end = lead_x;
+            t_next_x += t_delta_x;
+        } else {
+            lead_y += step_y;
+            range.m_y.m_begin = range.m_y.m_end = lead_y;
+            t_next_y += t_delta_y;
+        }
+        visit_tiles(range);
+    }
+}
+
+void PhysicsScene::overlapTileGrid(const PhysicsShape &shape,
+                                   const TilemapCollision &tilemap_collision) {
+    auto &grid = tilemap_collision.m_grid;
+    TL_RETURN_IF_TRUE(grid.m_chunks.GetSize() == 0);
+    TL_RETURN_IF_FALSE(
+        shape.GetCollisionMask().CanCollision(grid.m_collision_layer));
+
+    auto &chunk_extent = tilemap_collision.m_chunks.m_chunk_extent;
+    Vec2 tile_size(tilemap_collision.m_chunks.m_tile_extent.w,
+                   tilemap_collision.m_chunks.m_tile_extent.h);
+
+    Rect bounding = computeShapeBoundingBox(shape);
+    Vec2 min = bounding.m_center - bounding.m_half_size -
+               tilemap_collision.GetTopLeft();
+    Vec2 max = bounding.m_center + bounding.m_half_size -
+               tilemap_collision.GetTopLeft();
+
+    int x_begin = std::max<int>(std::floor(min.x / tile_size.w), 0);
+    int x_end = std::floor(max.x / tile_size.w);
+    int y_begin = std::max<int>(std::floor(min.y / tile_size.h), 0);
+    int y_end = std::floor(max.y / tile_size.h);
+
+    for (int y = y_begin; y <= y_end; y++) {
+        for (int x = x_begin; x <= x_end; x++) {
+            PHYSICS_STAT_ADD(m_stats.m_overlap, m_cell_count, 1);
+            auto rect = grid.GetTileRect(chunk_extent, x, y);
+            TL_CONTINUE_IF_NULL(rect);
+            PHYSICS_STAT_ADD(m_stats.m_overlap, m_candidate_count, 1);
+
+            Rect world_rect = *rect;
+            world_rect.m_center +=
+                tilemap_collision.GetTopLeft() + Vec2(x, y) * tile_size;
+
+            bool is_overlap =
+                shape.GetType() == PhysicsShape::Type::Rect
+                    ? IsRectsIntersect(*shape.AsRect(), world_rect)
+                    : IsCircleRectIntersect(*shape.AsCircle(), world_rect);
+            TL_CONTINUE_IF_FALSE(is_overlap);
+
+            // tiles have no shape, report whole grid once
+            OverlapResult result;
+            result.m_dst_entity = grid.m_owner;
+            m_cached_overlaps_results.push_back(result);
+            return;
+        }
+    }
+}
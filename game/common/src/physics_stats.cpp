@@ -0,0 +1,30 @@
+#include "common/physics_stats.hpp"
+
+PhysicsQueryStats& PhysicsQueryStats::operator+=(const PhysicsQueryStats& o) {
+    m_query_count += o.m_query_count;
+    m_candidate_count += o.m_candidate_count;
+    m_hit_count += o.m_hit_count;
+    m_cell_count += o.m_cell_count;
+    m_time += o.m_time;
+    return *this;
+}
+
+PhysicsStats& PhysicsStats::operator+=(const PhysicsStats& o) {
+    m_sweep += o.m_sweep;
+    m_overlap += o.m_overlap;
+    m_contact += o.m_contact;
+    return *this;
+}
+
+#ifdef TL_ENABLE_PHYSICS_STATS
+
+PhysicsQueryTimer::PhysicsQueryTimer(PhysicsQueryStats& stats)
+    : m_stats{stats}, m_begin{std::chrono::steady_clock::now()} {}
+
+PhysicsQueryTimer::~PhysicsQueryTimer() {
+    std::chrono::duration<TimeType> duration =
+        std::chrono::steady_clock::now() - m_begin;
+    m_stats.m_time += duration.count();
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "common/radix_sort.hpp"
+
+#include <array>
+#include <cstring>
+#include <numeric>
+
+uint32_t FloatToSortableKey(float value) {
+    // -0 equals to +0
+    if (value == 0) {
+        value = 0;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+void RadixSortIndices(const std::vector<uint64_t>& keys,
+                      std::vector<uint32_t>& indices,
+                      std::vector<uint32_t>& buffer) {
+    constexpr int PassCount = sizeof(uint64_t);
+    const size_t count = keys.size();
+
+    indices.resize(count);
+    std::iota(indices.begin(), indices.end(), 0);
+    buffer.resize(count);
+
+    // histograms of all passes in one read
+    std::array<std::array<uint32_t, 256>, PassCount> histograms{};
+    for (uint64_t key : keys) {
+        for (int pass = 0; pass < PassCount; pass++) {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    for (int pass = 0; pass < PassCount; pass++) {
+        auto& histogram = histograms[pass];
+        uint64_t first_byte = count ? (keys[0] >> (pass * 8)) & 0xFF : 0;
+        if (histogram[first_byte] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (auto& bucket : histogram) {
+            uint32_t n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+
+        for (uint32_t index : indices) {
+            buffer[histogram[(keys[index] >> (pass * 8)) & 0xFF]++] = index;
+        }
+        indices.swap(buffer);
+    }
+}
@@ -27,6 +27,7 @@ void Relationship::AddChild(Entity entity) {
 
     m_children.push_back(entity);
     relationship->m_parent = m_owner;
+    m_version++;
 }
 
 bool Relationship::HasChildren() const {
@@ -40,6 +41,7 @@ void Relationship::RemoveChild(Entity entity) {
         relationship->m_parent = null_entity;
     }
     m_children.erase(it);
+    m_version++;
 }
 
 void Relationship::RemoveFromParent() {
@@ -53,6 +55,24 @@ void Relationship::RemoveFromParent() {
     }
 }
 
+uint32_t Relationship::GetVersion() const {
+    return m_version;
+}
+
+void RelationshipManager::RegisterEntity(Entity entity, Entity owner) {
+    ComponentManager::RegisterEntity(entity, owner);
+    m_version++;
+}
+
+void RelationshipManager::RemoveEntity(Entity entity) {
+    ComponentManager::RemoveEntity(entity);
+    m_version++;
+}
+
+uint32_t RelationshipManager::GetVersion() const {
+    return m_version;
+}
+
 void RelationshipManager::Update() {
     PROFILE_SECTION();
 
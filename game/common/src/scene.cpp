@@ -116,12 +116,15 @@ void Scene::doRemoveEntityWithChildren(Entity entity) {
         }
     }
 
-    COMMON_CONTEXT.RemoveAllComponentsOnEntity(entity);
+    COMMON_CONTEXT.DestroyEntity(entity);
     
     m_entities.erase(entity);
 }
 
 void SceneManager::Switch(SceneHandle level) {
+    // drop pending `SwitchAsync`, it would replace this scene when finished
+    m_switch_version++;
+
     if (m_level) {
         m_level->OnQuit();
     }
@@ -132,6 +135,29 @@ void SceneManager::Switch(SceneHandle level) {
     }
 }
 
+void SceneManager::SwitchAsync(const Path& filename,
+                               SwitchedCallback on_switched) {
+    uint32_t version = ++m_switch_version;
+    COMMON_CONTEXT.m_assets_manager->GetManager<SceneDefinition>().LoadAsync(
+        filename, [this, filename, version, on_switched = std::move(
+                                                 on_switched)](
+                      SceneDefinitionHandle definition) {
+            TL_RETURN_IF_FALSE(version == m_switch_version);
+
+            SceneHandle scene;
+            if (definition) {
+                scene = Create(definition);
+                Switch(scene);
+            } else {
+                LOGE("switch to scene {} failed", filename);
+            }
+
+            if (on_switched) {
+                on_switched(scene);
+            }
+        });
+}
+
 void SceneManager::PoseUpdate() {
     if (!m_level) {
         return;
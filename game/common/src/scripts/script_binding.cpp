@@ -20,6 +20,7 @@
 #include "common/relationship.hpp"
 #include "common/scene.hpp"
 #include "common/script/script.hpp"
+#include "common/script/script_coroutine.hpp"
 #include "common/script/script_flags_binding.hpp"
 #include "common/script/script_handle_binding.hpp"
 #include "common/script/script_imgui_binding.hpp"
@@ -36,9 +37,11 @@
 #include "schema/proto/proto_binding.hpp"
 #include "schema/proto/proto_event_binding.hpp"
 
+#include <optional>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "common/font.hpp"
 #include "common/script/lua_event_listener.hpp"
@@ -117,6 +120,154 @@ static int ScriptComponentManager_GetTable(lua_State* L) {
     return 1;
 }
 
+// read an optional entity, nil means null_entity
+static Entity toOptionalEntity(lua_State* L, int index) {
+    TL_RETURN_VALUE_IF_TRUE(lua_isnoneornil(L, index), null_entity);
+    auto entity = luabridge::Stack<Entity>::get(L, index);
+    return entity ? entity.value() : null_entity;
+}
+
+// scene:Raycast(origin, dir, dist, mask, ignore_entity?)
+//   -> t, entity, normal | nil
+static int PhysicsScene_Raycast(lua_State* L) {
+    auto scene = luabridge::Stack<PhysicsScene*>::get(L, 1);
+    auto origin = luabridge::Stack<Vec2>::get(L, 2);
+    auto dir = luabridge::Stack<Vec2>::get(L, 3);
+    auto mask = luabridge::Stack<CollisionGroup>::get(L, 5);
+    if (!scene || !scene.value() || !origin || !dir || !mask) {
+        luaL_error(L, "Raycast: invalid arguments");
+        return 0;
+    }
+
+    PhysicsScene::RaycastInfo ray;
+    ray.m_origin = origin.value();
+    ray.m_dir = dir.value().Normalize();
+    ray.m_dist = static_cast<float>(luaL_checknumber(L, 4));
+    ray.m_collision_mask = mask.value();
+    ray.m_ignore_entity = toOptionalEntity(L, 6);
+
+    auto hit = scene.value()->Raycast(ray);
+    if (!hit) {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_pushnumber(L, hit->m_t);
+    [[maybe_unused]] auto result = luabridge::push(L, hit->m_entity);
+    result = luabridge::push(L, hit->m_normal);
+    return 3;
+}
+
+// push {t, entity, nx, ny, ...}, t is -1 if nothing hit. Entity is pushed the
+// same way as `Stack<Entity>`, so it can be passed back to other bindings
+static void pushBatchHits(lua_State* L,
+                          const std::vector<std::optional<SweepResult>>& hits) {
+    constexpr int HitStride = 4;
+
+    lua_createtable(L, static_cast<int>(hits.size()) * HitStride, 0);
+    for (size_t i = 0; i < hits.size(); i++) {
+        auto& hit = hits[i];
+        int base = static_cast<int>(i) * HitStride;
+        lua_pushnumber(L, hit ? hit->m_t : -1);
+        lua_rawseti(L, -2, base + 1);
+        [[maybe_unused]] auto result =
+            luabridge::push(L, hit ? hit->m_entity : null_entity);
+        lua_rawseti(L, -2, base + 2);
+        lua_pushnumber(L, hit ? hit->m_normal.x : 0);
+        lua_rawseti(L, -2, base + 3);
+        lua_pushnumber(L, hit ? hit->m_normal.y : 0);
+        lua_rawseti(L, -2, base + 4);
+    }
+}
+
+// scene:RaycastBatch({ox, oy, dx, dy, dist, ignore_entity, ...}, mask)
+//   -> {t, entity, nx, ny, ...}, t is -1 if ray hits nothing
+static int PhysicsScene_RaycastBatch(lua_State* L) {
+    constexpr int RayStride = 6;
+
+    auto scene = luabridge::Stack<PhysicsScene*>::get(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    auto mask = luabridge::Stack<CollisionGroup>::get(L, 3);
+    if (!scene || !scene.value() || !mask) {
+        luaL_error(L, "RaycastBatch: invalid arguments");
+        return 0;
+    }
+
+    // lua runs in main thread only
+    static std::vector<PhysicsScene::RaycastInfo> rays;
+    static std::vector<std::optional<SweepResult>> hits;
+
+    int ray_count = lua_objlen(L, 2) / RayStride;
+    rays.resize(ray_count);
+    hits.resize(ray_count);
+    for (int i = 0; i < ray_count; i++) {
+        int base = i * RayStride;
+
+        float values[RayStride - 1];
+        for (int j = 0; j < RayStride - 1; j++) {
+            lua_rawgeti(L, 2, base + j + 1);
+            values[j] = static_cast<float>(lua_tonumber(L, -1));
+            lua_pop(L, 1);
+        }
+
+        auto& ray = rays[i];
+        ray.m_origin = Vec2{values[0], values[1]};
+        ray.m_dir = Vec2{values[2], values[3]}.Normalize();
+        ray.m_dist = values[4];
+        ray.m_collision_mask = mask.value();
+
+        lua_rawgeti(L, 2, base + RayStride);
+        ray.m_ignore_entity = toOptionalEntity(L, -1);
+        lua_pop(L, 1);
+    }
+
+    scene.value()->RaycastBatch(rays.data(), rays.size(), hits.data());
+    pushBatchHits(L, hits);
+    return 1;
+}
+
+// scene:ShapeCastBatch({shape, dx, dy, dist, ...})
+//   -> {t, entity, nx, ny, ...}, t is -1 if shape hits nothing
+static int PhysicsScene_ShapeCastBatch(lua_State* L) {
+    constexpr int CastStride = 4;
+
+    auto scene = luabridge::Stack<PhysicsScene*>::get(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    if (!scene || !scene.value()) {
+        luaL_error(L, "ShapeCastBatch: invalid arguments");
+        return 0;
+    }
+
+    // lua runs in main thread only
+    static std::vector<PhysicsScene::ShapeCastInfo> casts;
+    static std::vector<std::optional<SweepResult>> hits;
+
+    int cast_count = lua_objlen(L, 2) / CastStride;
+    casts.resize(cast_count);
+    hits.resize(cast_count);
+    for (int i = 0; i < cast_count; i++) {
+        auto& cast = casts[i];
+        int base = i * CastStride;
+
+        lua_rawgeti(L, 2, base + 1);
+        auto shape = luabridge::Stack<PhysicsShape*>::get(L, -1);
+        cast.m_shape = shape ? shape.value() : nullptr;
+        lua_pop(L, 1);
+
+        float values[CastStride - 1];
+        for (int j = 0; j < CastStride - 1; j++) {
+            lua_rawgeti(L, 2, base + j + 2);
+            values[j] = static_cast<float>(lua_tonumber(L, -1));
+            lua_pop(L, 1);
+        }
+        cast.m_dir = Vec2{values[0], values[1]}.Normalize();
+        cast.m_dist = values[2];
+    }
+
+    scene.value()->ShapeCastBatch(casts.data(), casts.size(), hits.data());
+    pushBatchHits(L, hits);
+    return 1;
+}
+
 void registerLuaScriptEventBindigns(lua_State* L) {
     luabridge::getGlobalNamespace(L)
         .beginClass<EventSystem>("EventSystem")
@@ -126,6 +277,11 @@ void registerLuaScriptEventBindigns(lua_State* L) {
             TL_BIND_LUA_EVENT_LISTENER(TriggerLeaveEvent, "TriggerLeaveEvent")
             TL_BIND_LUA_EVENT_LISTENER(TriggerTouchEvent, "TriggerTouchEvent")
             TL_BIND_LUA_EVENT_LISTENER(EventDebugger::DebugEvent, "DebugEvent")
+            TL_BIND_LUA_ROUTED_EVENT_LISTENER(TimerEvent, "TimerEvent", TimerID)
+            TL_BIND_LUA_ROUTED_EVENT_LISTENER(TimerStopEvent, "TimerStopEvent", TimerID)
+            TL_BIND_LUA_ROUTED_EVENT_LISTENER(TriggerEnterEvent, "TriggerEnterEvent", Entity)
+            TL_BIND_LUA_ROUTED_EVENT_LISTENER(TriggerLeaveEvent, "TriggerLeaveEvent", Entity)
+            TL_BIND_LUA_ROUTED_EVENT_LISTENER(TriggerTouchEvent, "TriggerTouchEvent", Entity)
             .addFunction("Remove", +[](EventSystem*, EventListenerID id) {
                 LuaEventListenerRegistry::Remove(id);
             })
@@ -544,10 +700,15 @@ void bindContext(lua_State* L) {
                                  return &ctx->GetCommonConfig();
                              })
                 .addFunction("Log", TL_Log)
+                .addFunction("IsEntityAlive", &CommonContext::IsEntityAlive)
                 .addFunction("GetEventSystem",
                              +[](CommonContext* ctx) -> EventSystem* {
                                  return ctx->m_event_system.get();
                              })
+                .addFunction("GetCoroutineScheduler",
+                             +[](CommonContext* ctx) -> ScriptCoroutineScheduler* {
+                                 return ctx->m_script_coroutine_scheduler.get();
+                             })
             .endClass()
             .addFunction("GetContext", +[]() -> CommonContext* {
                 return &CommonContext::GetInst();
@@ -680,6 +841,14 @@ void bindPhysics(lua_State* L) {
                              static_cast<bool (PhysicsScene::*)(
                                  const PhysicsShape&, const PhysicsShape&) const>(
                                  &PhysicsScene::Overlap))
+                .addFunction("Raycast", PhysicsScene_Raycast)
+                .addFunction("RaycastBatch", PhysicsScene_RaycastBatch)
+                .addFunction("ShapeCastBatch", PhysicsScene_ShapeCastBatch)
+                .addFunction("ComputeStateHash", +[](const PhysicsScene* scene) {
+                    // luau numbers can't hold 64 bits
+                    uint64_t hash = scene->ComputeStateHash();
+                    return static_cast<uint32_t>(hash ^ (hash >> 32));
+                })
             .endClass()
             .beginClass<OverlapResult>("OverlapResult")
                 .addProperty("m_dst_entity", &OverlapResult::m_dst_entity)
@@ -720,6 +889,25 @@ void bindPhysics(lua_State* L) {
         .endNamespace();
 }
 
+void bindCoroutine(lua_State* L) {
+    luabridge::getGlobalNamespace(L)
+        .beginNamespace("TL_Common")
+            .addProperty("null_coroutine_id", +[]() -> CoroutineID { return null_coroutine_id; })
+            .beginClass<ScriptCoroutineScheduler>("CoroutineScheduler")
+                .addFunction("Start",
+                             +[](ScriptCoroutineScheduler* s, luabridge::LuaRef fn) {
+                                 return s->Start(fn, null_entity);
+                             },
+                             +[](ScriptCoroutineScheduler* s, luabridge::LuaRef fn,
+                                 Entity owner) { return s->Start(fn, owner); })
+                .addFunction("Stop", &ScriptCoroutineScheduler::Stop)
+                .addFunction("IsAlive", &ScriptCoroutineScheduler::IsAlive)
+            .endClass()
+        .endNamespace();
+
+    ScriptCoroutineScheduler::BindWaitFunctions(L);
+}
+
 void bindEvent(lua_State* L) {
      luabridge::getGlobalNamespace(L)
         .beginNamespace("TL_Common")
@@ -803,10 +991,11 @@ void bindTilemap(lua_State* L) {
                 .addProperty("m_tile_size", &Tile::m_tile_size, true)
             .endClass()
             .beginClass<TilemapTileLayer::Tile>("TilemapLayerTile")
-                .addProperty("m_gid", &TilemapTileLayer::Tile::m_gid, true)
+                .addProperty("m_gid",
+                             +[](const TilemapTileLayer::Tile* t) { return t->GetGID(); })
                 .addFunction(
                     "GetFlipValue",
-                    +[](const TilemapTileLayer::Tile* t) { return t->m_flip.Value(); })
+                    +[](const TilemapTileLayer::Tile* t) { return t->GetFlip().Value(); })
             .endClass()
             .beginClass<Tileset>("Tileset")
                 .addFunction("GetTile",
@@ -987,7 +1176,8 @@ void bindEntityName(lua_State* L) {
     luabridge::getGlobalNamespace(L)
         .beginNamespace("TL_Common")
             .beginClass<EntityName>("EntityName")
-                .addProperty("m_name", &EntityName::m_name, true)
+                // rename through EntityNameManager to keep name index in sync
+                .addProperty("m_name", &EntityName::m_name, false)
             .endClass()
             .beginClass<EntityNameManager>("EntityNameManager")
                 .addFunction("Get", +[](EntityNameManager* m, Entity e) {
@@ -996,6 +1186,7 @@ void bindEntityName(lua_State* L) {
                 .addFunction("Has", +[](EntityNameManager* m, Entity e) {
                     return m->Has(e);
                 })
+                .addFunction("Rename", &EntityNameManager::Rename)
                 .addFunction("FindChildByName", &EntityNameManager::FindChildByName)
                 .addFunction("FindChildrenByName", &EntityNameManager::FindChildrenByName)
             .endClass()
@@ -1123,6 +1314,20 @@ void bindSceneManager(lua_State* L) {
                 })
                 .addFunction("GetCurrentScene", &SceneManager::GetCurrentScene)
                 .addFunction("Switch", &SceneManager::Switch)
+                .addFunction("SwitchAsync",
+                             +[](SceneManager* m, const Path& path) {
+                                 m->SwitchAsync(path);
+                             },
+                             +[](SceneManager* m, const Path& path,
+                                 luabridge::LuaRef on_switched) {
+                                 m->SwitchAsync(path, [on_switched](SceneHandle scene) {
+                                     auto result = on_switched(scene);
+                                     if (result.errorCode()) {
+                                         LOGE("[Lua] SwitchAsync callback error: {}",
+                                              result.errorMessage());
+                                     }
+                                 });
+                             })
                 .addFunction("Create", static_cast<SceneHandle (SceneManager::*)(SceneDefinitionHandle)>(&SceneManager::Create))
                 .addFunction("Unload", &SceneManager::Unload)
             .endClass()
@@ -1247,6 +1452,7 @@ void bindAllTypes(lua_State* L) {
     bindCollisionGroup(L);
     bindBindPoint(L);
     bindEvent(L);
+    bindCoroutine(L);
     bindUDP(L);
 }
 
@@ -0,0 +1,334 @@
+#include "common/script/script_coroutine.hpp"
+
+#include "common/context.hpp"
+#include "common/log.hpp"
+#include "common/macros.hpp"
+#include "common/profile.hpp"
+#include "common/trigger.hpp"
+
+#include <algorithm>
+
+ScriptCoroutineScheduler::~ScriptCoroutineScheduler() {
+    Clear();
+}
+
+CoroutineID ScriptCoroutineScheduler::Start(luabridge::LuaRef fn,
+                                            Entity owner) {
+    lua_State* L = fn.state();
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(L && fn.isCallable(), null_coroutine_id,
+                                      LOGE,
+                                      "[Coroutine]: start with invalid function");
+
+    lua_State* thread = lua_newthread(L);
+    Coroutine coroutine;
+    coroutine.m_thread = thread;
+    coroutine.m_thread_ref = lua_ref(L, -1);
+    coroutine.m_owner = owner;
+    lua_pop(L, 1);
+
+    auto id = static_cast<CoroutineID>(++m_cur_id);
+    m_thread_to_coroutine.emplace(thread, id);
+    m_coroutines.emplace(id, coroutine);
+    if (owner != null_entity) {
+        m_owner_coroutines[owner].push_back(id);
+    }
+
+    fn.push(thread);
+    resume(id, 0);
+    return id;
+}
+
+void ScriptCoroutineScheduler::Stop(CoroutineID id) {
+    destroy(id);
+}
+
+void ScriptCoroutineScheduler::StopByOwner(Entity owner) {
+    TL_RETURN_IF_TRUE(owner == null_entity);
+
+    auto it = m_owner_coroutines.find(owner);
+    TL_RETURN_IF_TRUE(it == m_owner_coroutines.end());
+
+    // destroy erases from the index
+    std::vector<CoroutineID> ids = it->second;
+    for (auto id : ids) {
+        destroy(id);
+    }
+}
+
+void ScriptCoroutineScheduler::Clear() {
+    std::vector<CoroutineID> ids;
+    for (auto& [id, _] : m_coroutines) {
+        ids.push_back(id);
+    }
+    for (auto id : ids) {
+        destroy(id);
+    }
+    m_frame_waiting.clear();
+}
+
+bool ScriptCoroutineScheduler::IsAlive(CoroutineID id) const {
+    return m_coroutines.find(id) != m_coroutines.end();
+}
+
+void ScriptCoroutineScheduler::Update() {
+    PROFILE_SECTION();
+
+    // items scheduled this frame(by scripts updated before or coroutines
+    // resumed below) are keyed after m_frame, so they wait for next Update
+    std::vector<FrameWaitItem> ready;
+    auto end = m_frame_waiting.upper_bound(m_frame);
+    for (auto it = m_frame_waiting.begin(); it != end; ++it) {
+        ready.push_back(it->second);
+    }
+    m_frame_waiting.erase(m_frame_waiting.begin(), end);
+
+    for (auto& item : ready) {
+        Coroutine* coroutine = find(item.m_id);
+        TL_CONTINUE_IF_FALSE(coroutine &&
+                             coroutine->m_wait_type == WaitType::Frames &&
+                             coroutine->m_wait_version == item.m_wait_version);
+        resume(item.m_id, 0);
+    }
+
+    m_frame++;
+}
+
+ScriptCoroutineScheduler::Coroutine* ScriptCoroutineScheduler::find(
+    CoroutineID id) {
+    if (auto it = m_coroutines.find(id); it != m_coroutines.end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+ScriptCoroutineScheduler::Coroutine* ScriptCoroutineScheduler::findByThread(
+    lua_State* thread, CoroutineID& out_id) {
+    auto it = m_thread_to_coroutine.find(thread);
+    TL_RETURN_VALUE_IF_TRUE(it == m_thread_to_coroutine.end(), nullptr);
+    out_id = it->second;
+    return find(it->second);
+}
+
+void ScriptCoroutineScheduler::resume(CoroutineID id, int nargs) {
+    Coroutine* coroutine = find(id);
+    TL_RETURN_IF_NULL(coroutine);
+
+    clearWait(*coroutine);
+
+    lua_State* thread = coroutine->m_thread;
+    coroutine->m_is_running = true;
+    int status = lua_resume(thread, nullptr, nargs);
+
+    // map may rehash when new coroutine started inside
+    coroutine = find(id);
+    TL_RETURN_IF_NULL(coroutine);
+    coroutine->m_is_running = false;
+
+    if (coroutine->m_pending_stop) {
+        destroy(id);
+        return;
+    }
+
+    if (status == LUA_YIELD) {
+        // plain `coroutine.yield()` without Wait*: resume at next frame
+        if (coroutine->m_wait_type == WaitType::None) {
+            waitFrames(id, *coroutine, 1);
+        }
+        return;
+    }
+
+    if (status != LUA_OK) {
+        const char* err = lua_tostring(thread, -1);
+        LOGE("[Coroutine]: coroutine error: {}", err ? err : "unknown");
+    }
+    destroy(id);
+}
+
+void ScriptCoroutineScheduler::clearWait(Coroutine& coroutine) {
+    if (coroutine.m_listener != null_event_listener_id &&
+        coroutine.m_listener_remover) {
+        coroutine.m_listener_remover(coroutine.m_listener);
+    }
+    if (coroutine.m_timer != null_timer_id) {
+        COMMON_CONTEXT.m_timer_manager->Remove(coroutine.m_timer);
+    }
+
+    coroutine.m_listener = null_event_listener_id;
+    coroutine.m_listener_remover = nullptr;
+    coroutine.m_timer = null_timer_id;
+    coroutine.m_wait_type = WaitType::None;
+    coroutine.m_wait_version++;
+}
+
+void ScriptCoroutineScheduler::destroy(CoroutineID id) {
+    auto it = m_coroutines.find(id);
+    TL_RETURN_IF_TRUE(it == m_coroutines.end());
+
+    // a running thread must keep referenced, destroy it when it's suspended
+    if (it->second.m_is_running) {
+        it->second.m_pending_stop = true;
+        clearWait(it->second);
+        return;
+    }
+
+    // erase firstly, so lua_unref below can't reenter this coroutine
+    Coroutine coroutine = it->second;
+    m_coroutines.erase(it);
+    m_thread_to_coroutine.erase(coroutine.m_thread);
+    if (auto owner_it = m_owner_coroutines.find(coroutine.m_owner);
+        owner_it != m_owner_coroutines.end()) {
+        auto& ids = owner_it->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        if (ids.empty()) {
+            m_owner_coroutines.erase(owner_it);
+        }
+    }
+
+    clearWait(coroutine);
+    if (coroutine.m_thread_ref != LUA_NOREF) {
+        lua_unref(coroutine.m_thread, coroutine.m_thread_ref);
+    }
+}
+
+void ScriptCoroutineScheduler::waitTime(CoroutineID id, Coroutine& coroutine,
+                                        TimeType seconds) {
+    if (seconds <= 0) {
+        waitFrames(id, coroutine, 1);
+        return;
+    }
+
+    Timer& timer = COMMON_CONTEXT.m_timer_manager->Create(
+        seconds, TimerEventType::CoroutineWait);
+    timer.Start();
+    coroutine.m_timer = timer.GetID();
+    listenEvent<TimerEvent>(id, coroutine,
+                            static_cast<EventRouteKeyType>(timer.GetID()),
+                            false);
+    coroutine.m_wait_type = WaitType::Time;
+}
+
+void ScriptCoroutineScheduler::waitFrames(CoroutineID id, Coroutine& coroutine,
+                                          int frames) {
+    coroutine.m_wait_type = WaitType::Frames;
+    m_frame_waiting.emplace(m_frame + std::max(frames, 1),
+                            FrameWaitItem{id, coroutine.m_wait_version});
+}
+
+bool ScriptCoroutineScheduler::waitEvent(CoroutineID id, Coroutine& coroutine,
+                                         std::string_view event_type,
+                                         EventRouteKeyType key) {
+    if (event_type == "TriggerEnterEvent") {
+        listenEvent<TriggerEnterEvent>(id, coroutine, key, true);
+    } else if (event_type == "TriggerLeaveEvent") {
+        listenEvent<TriggerLeaveEvent>(id, coroutine, key, true);
+    } else if (event_type == "TriggerTouchEvent") {
+        listenEvent<TriggerTouchEvent>(id, coroutine, key, true);
+    } else if (event_type == "TimerEvent") {
+        listenEvent<TimerEvent>(id, coroutine, key, true);
+    } else if (event_type == "TimerStopEvent") {
+        listenEvent<TimerStopEvent>(id, coroutine, key, true);
+    } else {
+        return false;
+    }
+
+    coroutine.m_wait_type = WaitType::Event;
+    return true;
+}
+
+template <typename T>
+void ScriptCoroutineScheduler::listenEvent(CoroutineID id,
+                                           Coroutine& coroutine,
+                                           EventRouteKeyType key,
+                                           bool pass_event) {
+    uint32_t version = coroutine.m_wait_version;
+    coroutine.m_listener = COMMON_CONTEXT.m_event_system->AddListener<T>(
+        key, [this, id, version, pass_event](EventListenerID, const T& event) {
+            // listener removal is pending, so it may be called again after
+            // coroutine resumed
+            Coroutine* coroutine = find(id);
+            TL_RETURN_IF_FALSE(coroutine &&
+                               coroutine->m_wait_version == version);
+
+            int nargs = 0;
+            if (pass_event) {
+                auto result = luabridge::push(coroutine->m_thread, event);
+                if (!result) {
+                    LOGE("[Coroutine]: push event failed: {}",
+                         result.message());
+                    lua_pushnil(coroutine->m_thread);
+                }
+                nargs = 1;
+            }
+            resume(id, nargs);
+        });
+    coroutine.m_listener_remover = +[](EventListenerID listener) {
+        COMMON_CONTEXT.m_event_system->RemoveListener<T>(listener);
+    };
+}
+
+int ScriptCoroutineScheduler::luaWait(lua_State* L) {
+    auto& scheduler = *COMMON_CONTEXT.m_script_coroutine_scheduler;
+    CoroutineID id{};
+    Coroutine* coroutine = scheduler.findByThread(L, id);
+    if (!coroutine) {
+        luaL_error(L, "Wait must be called in coroutine started by "
+                      "CoroutineScheduler");
+        return 0;
+    }
+
+    scheduler.waitTime(id, *coroutine, luaL_checknumber(L, 1));
+    return lua_yield(L, 0);
+}
+
+int ScriptCoroutineScheduler::luaWaitFrames(lua_State* L) {
+    auto& scheduler = *COMMON_CONTEXT.m_script_coroutine_scheduler;
+    CoroutineID id{};
+    Coroutine* coroutine = scheduler.findByThread(L, id);
+    if (!coroutine) {
+        luaL_error(L, "WaitFrames must be called in coroutine started by "
+                      "CoroutineScheduler");
+        return 0;
+    }
+
+    scheduler.waitFrames(id, *coroutine, luaL_optinteger(L, 1, 1));
+    return lua_yield(L, 0);
+}
+
+int ScriptCoroutineScheduler::luaWaitForEvent(lua_State* L) {
+    auto& scheduler = *COMMON_CONTEXT.m_script_coroutine_scheduler;
+    CoroutineID id{};
+    Coroutine* coroutine = scheduler.findByThread(L, id);
+    if (!coroutine) {
+        luaL_error(L, "WaitForEvent must be called in coroutine started by "
+                      "CoroutineScheduler");
+        return 0;
+    }
+
+    const char* event_type = luaL_checkstring(L, 1);
+    // key is entity or timer id, both are bound as `Enum`
+    auto key = luabridge::Stack<Entity>::get(L, 2);
+    if (!key) {
+        luaL_error(L, "WaitForEvent: invalid key");
+        return 0;
+    }
+    if (!scheduler.waitEvent(id, *coroutine, event_type,
+                             static_cast<EventRouteKeyType>(*key))) {
+        luaL_error(L, "WaitForEvent: unsupported event type %s", event_type);
+        return 0;
+    }
+    return lua_yield(L, 0);
+}
+
+void ScriptCoroutineScheduler::BindWaitFunctions(lua_State* L) {
+    lua_getglobal(L, "TL_Common");
+    TL_RETURN_IF_FALSE_WITH_LOG(lua_istable(L, -1), LOGE,
+                                "[Coroutine]: TL_Common not bind");
+
+    lua_pushcfunction(L, luaWait, "Wait");
+    lua_setfield(L, -2, "Wait");
+    lua_pushcfunction(L, luaWaitFrames, "WaitFrames");
+    lua_setfield(L, -2, "WaitFrames");
+    lua_pushcfunction(L, luaWaitForEvent, "WaitForEvent");
+    lua_setfield(L, -2, "WaitForEvent");
+    lua_pop(L, 1);
+}
@@ -30,7 +30,12 @@ void StaticCollisionManager::Update() {
             COMMON_CONTEXT.m_transform_manager->Get(component.first);
         TL_CONTINUE_IF_FALSE(transform);
 
-        for (auto& info : component.second.m_component->m_shapes) {
+        auto& collision = *component.second.m_component;
+        TL_CONTINUE_IF_TRUE(collision.m_transform_version ==
+                            transform->GetVersion());
+        collision.m_transform_version = transform->GetVersion();
+
+        for (auto& info : collision.m_shapes) {
             Mat33 result = transform->GetGlobalMat() *
                            Mat33::CreateTranslation(info.m_local_position);
             Vec2 final_position = GetPosition(result);
@@ -4,6 +4,17 @@
 #include "common/path.hpp"
 #include "common/sdl_call.hpp"
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif !defined(TL_ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 std::string IOMode2Mode(IOMode mode, bool binary, bool advance) {
     std::string result;
     switch (mode) {
@@ -82,4 +93,89 @@ std::shared_ptr<IOStream> IOStream::CreateFromFile(const Path& filename,
                                                    bool advance_mode) {
     return std::shared_ptr<IOStream>(
         new IOStream{filename, mode, binary, advance_mode});
-}
\ No newline at end of file
+}
+
+std::unique_ptr<MappedFile> MappedFile::Open(const Path& filename) {
+    std::unique_ptr<MappedFile> file{new MappedFile};
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileW(filename.wstring().c_str(), GENERIC_READ,
+                                FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    file->m_file = handle;
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart > 0) {
+        HANDLE mapping =
+            CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            file->m_mapping = mapping;
+            file->m_data = static_cast<const char*>(
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            file->m_size = static_cast<size_t>(size.QuadPart);
+            file->m_is_mapped = file->m_data != nullptr;
+        }
+    }
+#elif !defined(TL_ANDROID)
+    int fd = open(filename.string().c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file->m_data = static_cast<const char*>(data);
+            file->m_size = st.st_size;
+            file->m_is_mapped = true;
+        }
+    }
+    // mapping is still valid after close
+    close(fd);
+#endif
+
+    if (!file->m_is_mapped) {
+        size_t size = 0;
+        void* data = SDL_LoadFile(filename.string().c_str(), &size);
+        if (!data) {
+            return nullptr;
+        }
+        file->m_data = static_cast<const char*>(data);
+        file->m_size = size;
+    }
+
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (!m_is_mapped) {
+        SDL_free(const_cast<char*>(m_data));
+    }
+#if defined(_WIN32)
+    if (m_is_mapped) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file) {
+        CloseHandle(m_file);
+    }
+#elif !defined(TL_ANDROID)
+    if (m_is_mapped) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+}
+
+const char* MappedFile::GetData() const {
+    return m_data;
+}
+
+size_t MappedFile::GetSize() const {
+    return m_size;
+}
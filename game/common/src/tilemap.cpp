@@ -9,6 +9,9 @@
 #include "tmxlite/ObjectGroup.hpp"
 #include "tmxlite/Property.hpp"
 #include "tmxlite/TileLayer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <optional>
 #include <variant>
 
 // Bits on the far end of the 32-bit global tile ID are used for tile flags
@@ -45,6 +48,18 @@ TilemapTileLayer::TilemapTileLayer(const std::string& name,
     parse(layer);
 }
 
+TilemapTileLayer::Tile::Tile(uint32_t gid, Flags<Flip> flip)
+    : m_data{static_cast<uint16_t>((gid & GIDMask) |
+                                   (flip.Value() << FlipShift))} {}
+
+uint32_t TilemapTileLayer::Tile::GetGID() const {
+    return m_data & GIDMask;
+}
+
+Flags<Flip> TilemapTileLayer::Tile::GetFlip() const {
+    return static_cast<std::underlying_type_t<Flip>>(m_data >> FlipShift);
+}
+
 const TilemapTileLayer::Tile& TilemapTileLayer::GetTile(int x, int y) const {
     size_t idx = y * m_size.x + x;
     return m_tiles[idx];
@@ -76,15 +91,20 @@ void TilemapTileLayer::parse(const tmx::TileLayer& layer) {
         for (int x = 0; x < size.x; x++) {
             const auto idx = y * size.x + x;
             auto& tmx_tile = layer.getTiles()[idx];
-            Tile tile;
+            Flags<Flip> flip = Flip::None;
             if (tmx_tile.flipFlags & FLIPPED_VERTICALLY_FLAG) {
-                tile.m_flip |= Flip::Vertical;
+                flip |= Flip::Vertical;
             }
             if (tmx_tile.flipFlags & FLIPPED_HORIZONTALLY_FLAG) {
-                tile.m_flip |= Flip::Horizontal;
+                flip |= Flip::Horizontal;
+            }
+            if (tmx_tile.ID > Tile::MaxGID) {
+                LOGE("[Tilemap]: tile gid {} in layer {} exceeds {}",
+                     tmx_tile.ID, GetName(), Tile::MaxGID);
+                m_tiles.emplace_back();
+                continue;
             }
-            tile.m_gid = tmx_tile.ID;
-            m_tiles.push_back(tile);
+            m_tiles.emplace_back(tmx_tile.ID, flip);
         }
     }
 }
@@ -432,50 +452,9 @@ Tilemap::Tilemap(const Path& filename) : m_filename{filename} {
     parse(filename);
 }
 
-Tilemap::Tilemap(const Tilemap& o)
-    : m_tile_size{o.m_tile_size},
-      m_tilesets{o.m_tilesets},
-      m_filename{o.m_filename} {
-    for (auto& layer : o.m_layers) {
-        switch (layer->GetType()) {
-            case TilemapLayer::Type::Tiled:
-                m_layers.emplace_back(
-                    std::make_unique<TilemapTileLayer>(*layer->AsTiledLayer()));
-                break;
-            case TilemapLayer::Type::Object:
-                m_layers.emplace_back(std::make_unique<TilemapObjectLayer>(
-                    *layer->AsObjectLayer()));
-            case TilemapLayer::Type::Image:
-                m_layers.emplace_back(std::make_unique<TilemapImageLayer>(
-                    *layer->AsImageLayer()));
-                break;
-        }
-    }
-}
-
-Tilemap& Tilemap::operator=(const Tilemap& o) {
-    TL_RETURN_VALUE_IF_FALSE(&o != this, *this);
-
-    m_tile_size = o.m_tile_size;
-    m_tilesets = o.m_tilesets;
-    m_filename = o.m_filename;
-    for (auto& layer : m_layers) {
-        switch (layer->GetType()) {
-            case TilemapLayer::Type::Tiled:
-                m_layers.emplace_back(
-                    std::make_unique<TilemapTileLayer>(*layer->AsTiledLayer()));
-                break;
-            case TilemapLayer::Type::Object:
-                m_layers.emplace_back(std::make_unique<TilemapObjectLayer>(
-                    *layer->AsObjectLayer()));
-            case TilemapLayer::Type::Image:
-                m_layers.emplace_back(std::make_unique<TilemapImageLayer>(
-                    *layer->AsImageLayer()));
-                break;
-        }
-    }
-
-    return *this;
+Tilemap::Tilemap(const Path& filename, const tmx::Map& map)
+    : m_filename{filename} {
+    parse(map, filename);
 }
 
 const Tile* Tilemap::GetTile(uint32_t gid) const {
@@ -495,6 +474,127 @@ const Path& Tilemap::GetFilename() const {
     return m_filename;
 }
 
+std::optional<Rect> Tilemap::GetLayerTileCollisionRect(
+    const TilemapTileLayer& layer, int x, int y) const {
+    auto& layer_tile = layer.GetTile(x, y);
+    auto tile = GetTile(layer_tile.GetGID());
+    if (!tile || tile->m_collision_rect.m_half_size == Vec2::ZERO) {
+        return std::nullopt;
+    }
+
+    Rect rect = tile->m_collision_rect;
+
+    auto flip = layer_tile.GetFlip();
+    if (flip & Flip::Vertical) {
+        float offset_y = tile->m_tile_size.h * 0.5 - rect.m_center.y;
+        rect.m_center.y += offset_y * 2.0;
+    }
+    if (flip & Flip::Horizontal) {
+        float offset_x = tile->m_tile_size.w * 0.5 - rect.m_center.x;
+        rect.m_center.x += offset_x * 2.0;
+    }
+
+    rect.m_center +=
+        Vec2(x, y + 1) * m_tile_size + Vec2(0, -tile->m_tile_size.h);
+    return rect;
+}
+
+const std::vector<Rect>& Tilemap::GetLayerCollisionRects(
+    const TilemapTileLayer& layer) const {
+    std::string name{layer.GetName()};
+    auto it = m_layer_collision_rects.find(name);
+    if (it == m_layer_collision_rects.end()) {
+        it = m_layer_collision_rects
+                 .emplace(std::move(name), bakeLayerCollisionRects(layer))
+                 .first;
+    }
+    return it->second;
+}
+
+std::vector<Rect> Tilemap::bakeLayerCollisionRects(
+    const TilemapTileLayer& layer) const {
+    PROFILE_SECTION();
+
+    struct AABB {
+        Vec2 m_min;
+        Vec2 m_max;
+    };
+
+    // tile position is computed from integer tile size, so edges of adjacent
+    // tiles are equal in practice, epsilon only protects from float error
+    constexpr float epsilon = 0.001f;
+    auto is_equal = [=](float a, float b) { return std::abs(a - b) < epsilon; };
+
+    // 1. merge horizontal runs of rects which have same top & bottom
+    std::vector<AABB> runs;
+    auto& size = layer.GetSize();
+    for (size_t y = 0; y < size.y; y++) {
+        std::optional<AABB> run;
+        for (size_t x = 0; x < size.x; x++) {
+            auto rect = GetLayerTileCollisionRect(layer, x, y);
+            if (!rect) {
+                if (run) {
+                    runs.push_back(*run);
+                    run.reset();
+                }
+                continue;
+            }
+
+            AABB aabb{rect->m_center - rect->m_half_size,
+                      rect->m_center + rect->m_half_size};
+            if (run && is_equal(run->m_max.x, aabb.m_min.x) &&
+                is_equal(run->m_min.y, aabb.m_min.y) &&
+                is_equal(run->m_max.y, aabb.m_max.y)) {
+                run->m_max.x = aabb.m_max.x;
+                continue;
+            }
+
+            if (run) {
+                runs.push_back(*run);
+            }
+            run = aabb;
+        }
+
+        if (run) {
+            runs.push_back(*run);
+        }
+    }
+
+    // 2. merge vertical adjacent runs which have same left & right
+    std::sort(runs.begin(), runs.end(), [](const AABB& a, const AABB& b) {
+        if (a.m_min.x != b.m_min.x) {
+            return a.m_min.x < b.m_min.x;
+        }
+        if (a.m_max.x != b.m_max.x) {
+            return a.m_max.x < b.m_max.x;
+        }
+        return a.m_min.y < b.m_min.y;
+    });
+
+    std::vector<Rect> rects;
+    std::optional<AABB> merged;
+    auto flush = [&]() {
+        if (merged) {
+            Rect& rect = rects.emplace_back();
+            rect.m_half_size = (merged->m_max - merged->m_min) * 0.5;
+            rect.m_center = merged->m_min + rect.m_half_size;
+        }
+    };
+    for (auto& run : runs) {
+        if (merged && is_equal(merged->m_min.x, run.m_min.x) &&
+            is_equal(merged->m_max.x, run.m_max.x) &&
+            is_equal(merged->m_max.y, run.m_min.y)) {
+            merged->m_max.y = run.m_max.y;
+            continue;
+        }
+        flush();
+        merged = run;
+    }
+    flush();
+
+    return rects;
+}
+
 void Tilemap::parse(const Path& filename) {
     tmx::Map map;
     if (!map.load(filename.string())) {
@@ -502,6 +602,10 @@ void Tilemap::parse(const Path& filename) {
         return;
     }
 
+    parse(map, filename);
+}
+
+void Tilemap::parse(const tmx::Map& map, const Path& filename) {
     m_tile_size.w = map.getTileSize().x;
     m_tile_size.h = map.getTileSize().y;
 
@@ -509,17 +613,17 @@ void Tilemap::parse(const Path& filename) {
     for (auto& layer : layers) {
         if (layer->getType() == tmx::Layer::Type::Tile) {
             const auto& tile_layer = layer->getLayerAs<tmx::TileLayer>();
-            m_layers.emplace_back(std::make_unique<TilemapTileLayer>(
+            m_layers.emplace_back(std::make_shared<TilemapTileLayer>(
                 tile_layer.getName(), tile_layer));
         }
         if (layer->getType() == tmx::Layer::Type::Object) {
             const auto& object_layer = layer->getLayerAs<tmx::ObjectGroup>();
-            m_layers.emplace_back(std::make_unique<TilemapObjectLayer>(
+            m_layers.emplace_back(std::make_shared<TilemapObjectLayer>(
                 object_layer.getName(), object_layer));
         }
         if (layer->getType() == tmx::Layer::Type::Image) {
             const auto& image_layer = layer->getLayerAs<tmx::ImageLayer>();
-            m_layers.emplace_back(std::make_unique<TilemapImageLayer>(
+            m_layers.emplace_back(std::make_shared<TilemapImageLayer>(
                 image_layer.getName(), image_layer, filename.parent_path()));
         }
     }
@@ -537,3 +641,55 @@ TilemapHandle TilemapManager::Load(const Path& filename, bool force) {
     return store(&filename, UUIDv4::CreateV4(),
                  std::make_unique<Tilemap>(filename));
 }
+
+void TilemapManager::loadAsync(const Path& filename,
+                               const UUIDv4& pending_uuid) {
+    auto map = std::make_shared<tmx::Map>();
+    auto loaded = std::make_shared<bool>(false);
+
+    auto build = [=]() {
+        AssetLoadResult<Tilemap> result;
+        if (*loaded) {
+            result.m_uuid = UUIDv4::CreateV4();
+            result.m_payload = std::make_unique<Tilemap>(filename, *map);
+        }
+        finishAsyncLoad(filename, pending_uuid, std::move(result));
+    };
+
+    GetWorkerPool()->Submit(
+        [=]() { *loaded = map->load(filename.string()); },
+        [=]() {
+            if (!*loaded) {
+                build();
+                return;
+            }
+
+            std::vector<Path> images;
+            for (auto& tileset : map->getTilesets()) {
+                images.push_back(tileset.getImagePath());
+            }
+            for (auto& layer : map->getLayers()) {
+                if (layer->getType() == tmx::Layer::Type::Image) {
+                    images.push_back(
+                        layer->getLayerAs<tmx::ImageLayer>().getImagePath());
+                }
+            }
+
+            if (images.empty()) {
+                build();
+                return;
+            }
+
+            // build tilemap after all dependent images loaded
+            auto remain = std::make_shared<size_t>(images.size());
+            auto& image_manager =
+                COMMON_CONTEXT.m_assets_manager->GetManager<ImageBase>();
+            for (auto& image : images) {
+                image_manager.LoadAsync(image, [=](ImageHandle) {
+                    if (--*remain == 0) {
+                        build();
+                    }
+                });
+            }
+        });
+}
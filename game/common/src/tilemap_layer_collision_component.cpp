@@ -9,20 +9,8 @@ TilemapLayerCollisionComponent::TilemapLayerCollisionComponent(
 
     for (auto& layer : create_info.m_tilemap->GetLayers()) {
         if (layer->GetName() == create_info.m_layer_name) {
-            switch (layer->GetType()) {
-                case TilemapLayer::Type::Tiled:
-                    m_tilemap_layer = std::make_unique<TilemapTileLayer>(
-                        *layer->AsTiledLayer());
-                    break;
-                case TilemapLayer::Type::Object:
-                    m_tilemap_layer = std::make_unique<TilemapObjectLayer>(
-                        *layer->AsObjectLayer());
-                    break;
-                case TilemapLayer::Type::Image:
-                    m_tilemap_layer = std::make_unique<TilemapImageLayer>(
-                        *layer->AsImageLayer());
-                    break;
-            }
+            m_tilemap_layer = layer;
+            break;
         }
     }
 
@@ -42,44 +30,65 @@ TilemapLayerCollisionComponent::TilemapLayerCollisionComponent(
                                               Vec2UI(tile_size.w, tile_size.h),
                                               tile_in_chunk_size)};
 
-    if (m_tilemap_layer->GetType() == TilemapLayer::Type::Tiled) {
-        auto tiled_layer = m_tilemap_layer->AsTiledLayer();
-        auto& size = tiled_layer->GetSize();
-        for (size_t y = 0; y < size.y; y++) {
-            for (size_t x = 0; x < size.x; x++) {
-                auto& layer_tile = tiled_layer->GetTile(x, y);
-                auto tile = tilemap->GetTile(layer_tile.m_gid);
-                if (!tile || tile->m_collision_rect.m_half_size == Vec2::ZERO) {
-                    continue;
-                }
-
-                Rect rect = tile->m_collision_rect;
-
-                auto flip = layer_tile.m_flip;
-                if (flip & Flip::Vertical) {
-                    float offset_y =
-                        tile->m_tile_size.h * 0.5 - rect.m_center.y;
-                    rect.m_center.y += offset_y * 2.0;
-                }
-                if (flip & Flip::Horizontal) {
-                    float offset_x =
-                        tile->m_tile_size.w * 0.5 - rect.m_center.x;
-                    rect.m_center.x += offset_x * 2.0;
-                }
-
-                rect.m_center += create_info.m_position +
-                                 Vec2(x, y + 1) * tilemap->GetTileSize() +
-                                 Vec2(0, -tile->m_tile_size.h);
-
-                PhysicsShapeDefinition definition;
-                definition.m_is_rect = true;
-                definition.m_rect = rect;
-                definition.m_collision_layer.Add(CollisionGroupType::Obstacle);
-                definition.m_collision_mask.Add(CollisionGroupType::CCT);
-
-                physics_scene->CreateShapeInChunk(
-                    entity, m_tilemap_collision.get(), definition);
+    if (m_tilemap_layer->GetType() == TilemapLayer::Type::Tiled &&
+        create_info.m_grid_collision.value_or(false)) {
+        createGridCollision(entity, create_info);
+    } else if (m_tilemap_layer->GetType() == TilemapLayer::Type::Tiled) {
+        auto& rects =
+            tilemap->GetLayerCollisionRects(*m_tilemap_layer->AsTiledLayer());
+        for (auto& rect : rects) {
+            PhysicsShapeDefinition definition;
+            definition.m_is_rect = true;
+            definition.m_rect = rect;
+            definition.m_rect.m_center += create_info.m_position;
+            definition.m_collision_layer.Add(CollisionGroupType::Obstacle);
+            definition.m_collision_mask.Add(CollisionGroupType::CCT);
+
+            physics_scene->CreateShapeInChunk(
+                entity, m_tilemap_collision.get(), definition);
+        }
+    }
+}
+
+void TilemapLayerCollisionComponent::createGridCollision(
+    Entity entity, const TilemapLayerDefinition& create_info) {
+    auto& physics_scene = COMMON_CONTEXT.m_physics_scene;
+    auto& tilemap = *create_info.m_tilemap;
+    auto tiled_layer = m_tilemap_layer->AsTiledLayer();
+
+    auto& grid = m_tilemap_collision->m_grid;
+    grid.m_owner = entity;
+    grid.m_collision_layer.Add(CollisionGroupType::Obstacle);
+    grid.m_collision_mask.Add(CollisionGroupType::CCT);
+
+    auto& tile_size = tilemap.GetTileSize();
+    auto& size = tiled_layer->GetSize();
+    for (size_t y = 0; y < size.y; y++) {
+        for (size_t x = 0; x < size.x; x++) {
+            auto rect = tilemap.GetLayerTileCollisionRect(*tiled_layer, x, y);
+            TL_CONTINUE_IF_FALSE(rect);
+
+            Vec2 tile_topleft = Vec2(x, y) * tile_size;
+            Vec2 rect_min = rect->m_center - rect->m_half_size - tile_topleft;
+            Vec2 rect_max = rect->m_center + rect->m_half_size - tile_topleft;
+            if (rect_min.x >= 0 && rect_min.y >= 0 &&
+                rect_max.x <= tile_size.w && rect_max.y <= tile_size.h) {
+                Rect tile_rect = *rect;
+                tile_rect.m_center -= tile_topleft;
+                physics_scene->AddGridTile(m_tilemap_collision.get(),
+                                           Vec2UI(x, y), tile_rect);
+                continue;
             }
+
+            // tile bigger than grid, fallback to shape
+            PhysicsShapeDefinition definition;
+            definition.m_is_rect = true;
+            definition.m_rect = *rect;
+            definition.m_rect.m_center += create_info.m_position;
+            definition.m_collision_layer = grid.m_collision_layer;
+            definition.m_collision_mask = grid.m_collision_mask;
+            physics_scene->CreateShapeInChunk(
+                entity, m_tilemap_collision.get(), definition);
         }
     }
 }
@@ -2,8 +2,12 @@
 
 #include "common/context.hpp"
 #include "common/event.hpp"
+#include "common/macros.hpp"
 #include "common/profile.hpp"
 
+#include <algorithm>
+#include <functional>
+
 Time::Time() {
     m_cur_time = std::chrono::steady_clock::now();
 }
@@ -95,38 +99,17 @@ Timer::Timer(TimerID id, TimeType time, TimerEventType event_type, int loop)
 }
 
 void Timer::SetInterval(TimeType interval) {
+    syncTime();
     m_interval = interval;
-}
-
-void Timer::Update(TimeType time) {
-    if (!m_is_running || m_interval == 0) {
-        return;
-    }
-
-    m_cur_time += time;
-
-    if (m_cur_loop == 0) {
-        if (m_cur_time >= m_interval) {
-            COMMON_CONTEXT.m_event_system->EnqueueEvent<TimerEvent>(
-                TimerEvent{m_event_type, m_id});
-            Stop();
-            COMMON_CONTEXT.m_event_system->EnqueueEvent<TimerStopEvent>(
-                TimerStopEvent{m_event_type, m_id});
-        }
-    } else {
-        while (m_cur_loop != 0 && m_cur_time >= m_interval) {
-            m_cur_time -= m_interval;
-            if (m_cur_loop > 0) {
-                m_cur_loop--;
-            }
-            COMMON_CONTEXT.m_event_system->EnqueueEvent<TimerEvent>(
-                TimerEvent{m_event_type, m_id});
-        }
-    }
+    reschedule();
 }
 
 void Timer::Start() {
+    TL_RETURN_IF_TRUE(m_is_running);
+
+    m_resume_time = getNow();
     m_is_running = true;
+    reschedule();
 }
 
 void Timer::Stop() {
@@ -136,11 +119,15 @@ void Timer::Stop() {
 
 void Timer::Rewind() {
     m_cur_time = 0;
+    m_resume_time = getNow();
     m_cur_loop = m_loop;
+    reschedule();
 }
 
 void Timer::Pause() {
+    syncTime();
     m_is_running = false;
+    reschedule();
 }
 
 void Timer::SetLoop(int loop) {
@@ -168,17 +155,94 @@ bool Timer::IsRunning() const {
     return m_is_running;
 }
 
+TimeType Timer::getNow() const {
+    return m_manager ? m_manager->GetCurrentTime() : 0;
+}
+
+void Timer::syncTime() {
+    TL_RETURN_IF_FALSE(m_is_running);
+
+    TimeType now = getNow();
+    m_cur_time += now - m_resume_time;
+    m_resume_time = now;
+}
+
+void Timer::reschedule() {
+    m_schedule_version++;
+    TL_RETURN_IF_FALSE(m_manager && m_is_running && m_interval != 0);
+    m_manager->schedule(*this);
+}
+
+void Timer::fire() {
+    syncTime();
+
+    if (m_cur_loop == 0) {
+        if (m_cur_time >= m_interval) {
+            COMMON_CONTEXT.m_event_system->EnqueueEvent<TimerEvent>(
+                TimerEvent{m_event_type, m_id});
+            Stop();
+            COMMON_CONTEXT.m_event_system->EnqueueEvent<TimerStopEvent>(
+                TimerStopEvent{m_event_type, m_id});
+            return;
+        }
+    } else {
+        while (m_cur_loop != 0 && m_cur_time >= m_interval) {
+            m_cur_time -= m_interval;
+            if (m_cur_loop > 0) {
+                m_cur_loop--;
+            }
+            COMMON_CONTEXT.m_event_system->EnqueueEvent<TimerEvent>(
+                TimerEvent{m_event_type, m_id});
+        }
+    }
+    reschedule();
+}
+
 Timer& TimerManager::Create(TimeType interval, TimerEventType event_type,
                             int loop) {
-    auto id = static_cast<TimerID>(++m_cur_id);
-    return *m_timers
-                .emplace(
-                    id, std::make_unique<Timer>(id, interval, event_type, loop))
-                .first->second;
+    uint32_t index = 0;
+    if (m_free_slots.size() >= MinFreeSlots) {
+        index = m_free_slots.front();
+        m_free_slots.pop_front();
+    } else {
+        index = static_cast<uint32_t>(m_slots.size());
+        TL_ASSERT(index <= IndexMask);
+        if (index % TimersInPage == 0) {
+            m_pages.push_back(std::make_unique<Timer[]>(TimersInPage));
+        }
+        m_slots.emplace_back();
+    }
+
+    auto& slot = m_slots[index];
+    slot.m_alive = true;
+    auto id = static_cast<TimerID>((slot.m_generation << IndexBits) | index);
+
+    Timer& timer = getTimer(index);
+    uint32_t version = timer.m_schedule_version;
+    timer = Timer{id, interval, event_type, loop};
+    // keep version increasing so queued items of old timer are still stale
+    timer.m_schedule_version = version + 1;
+    timer.m_manager = this;
+    return timer;
 }
 
-void TimerManager::Remove(TimerID timer) {
-    m_timers.erase(timer);
+void TimerManager::Remove(TimerID id) {
+    uint32_t index = 0;
+    TL_RETURN_IF_FALSE(parseID(id, index));
+
+    auto& slot = m_slots[index];
+    slot.m_alive = false;
+
+    Timer& timer = getTimer(index);
+    timer.m_is_running = false;
+    timer.m_manager = nullptr;
+    timer.m_schedule_version++;
+
+    // retire slot, wrapped generation would make stale ids valid again
+    TL_RETURN_IF_TRUE(slot.m_generation == MaxGeneration);
+
+    slot.m_generation++;
+    m_free_slots.push_back(index);
 }
 
 void TimerManager::Remove(const Timer& timer) {
@@ -186,20 +250,83 @@ void TimerManager::Remove(const Timer& timer) {
 }
 
 void TimerManager::Clear() {
-    m_timers.clear();
+    for (uint32_t i = 0; i < m_slots.size(); i++) {
+        if (m_slots[i].m_alive) {
+            Remove(getTimer(i).GetID());
+        }
+    }
+    m_schedule_queue.clear();
+    m_deferred_schedule.clear();
 }
 
 void TimerManager::Update(TimeType duration) {
     PROFILE_SECTION();
 
-    for (auto& [_, timer] : m_timers) {
-        timer->Update(duration);
+    m_now += duration;
+
+    m_is_firing = true;
+    auto greater = std::greater<ScheduleItem>{};
+    while (!m_schedule_queue.empty() &&
+           m_schedule_queue.front().m_deadline <= m_now) {
+        std::pop_heap(m_schedule_queue.begin(), m_schedule_queue.end(),
+                      greater);
+        ScheduleItem item = m_schedule_queue.back();
+        m_schedule_queue.pop_back();
+
+        TL_CONTINUE_IF_FALSE(m_slots[item.m_index].m_alive);
+        Timer& timer = getTimer(item.m_index);
+        TL_CONTINUE_IF_FALSE(timer.m_schedule_version == item.m_version);
+        timer.fire();
     }
+    m_is_firing = false;
+
+    for (auto& item : m_deferred_schedule) {
+        m_schedule_queue.push_back(item);
+        std::push_heap(m_schedule_queue.begin(), m_schedule_queue.end(),
+                       greater);
+    }
+    m_deferred_schedule.clear();
 }
 
-Timer* TimerManager::Find(TimerID timer) const {
-    if (auto it = m_timers.find(timer); it != m_timers.end()) {
-        return it->second.get();
+Timer* TimerManager::Find(TimerID id) const {
+    uint32_t index = 0;
+    TL_RETURN_VALUE_IF_FALSE(parseID(id, index), nullptr);
+    return &getTimer(index);
+}
+
+TimeType TimerManager::GetCurrentTime() const {
+    return m_now;
+}
+
+Timer& TimerManager::getTimer(uint32_t index) const {
+    return m_pages[index / TimersInPage][index % TimersInPage];
+}
+
+bool TimerManager::parseID(TimerID id, uint32_t& out_index) const {
+    auto value = static_cast<std::underlying_type_t<TimerID>>(id);
+    uint32_t index = value & IndexMask;
+    uint32_t generation = value >> IndexBits;
+    TL_RETURN_FALSE_IF_FALSE(index < m_slots.size());
+
+    auto& slot = m_slots[index];
+    TL_RETURN_FALSE_IF_FALSE(slot.m_alive && slot.m_generation == generation);
+    out_index = index;
+    return true;
+}
+
+void TimerManager::schedule(Timer& timer) {
+    ScheduleItem item;
+    item.m_deadline =
+        timer.m_resume_time + timer.m_interval - timer.m_cur_time;
+    item.m_index = static_cast<uint32_t>(timer.m_id) & IndexMask;
+    item.m_version = timer.m_schedule_version;
+
+    if (m_is_firing) {
+        m_deferred_schedule.push_back(item);
+        return;
     }
-    return nullptr;
+
+    m_schedule_queue.push_back(item);
+    std::push_heap(m_schedule_queue.begin(), m_schedule_queue.end(),
+                   std::greater<ScheduleItem>{});
 }
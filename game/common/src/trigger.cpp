@@ -7,6 +7,8 @@
 #include "common/math.hpp"
 #include "common/profile.hpp"
 
+#include <algorithm>
+
 TriggerEnterEvent::TriggerEnterEvent(Entity src_entity, TriggerEventType type,
                                      OverlapResult overlap)
     : m_src_entity{src_entity}, m_type{type}, m_overlap{overlap} {}
@@ -65,6 +67,8 @@ Trigger::Trigger(Entity entity, const TriggerDefinition& definition)
         data.m_shape =
             PhysicsShape::Proxy{COMMON_CONTEXT.m_physics_scene->CreateShape(
                 entity, shape_definition)};
+        COMMON_CONTEXT.m_physics_scene->EnableContactTracking(
+            data.m_shape.get());
         if (shape_definition->m_is_rect) {
             data.m_local_position = shape_definition->m_rect.m_center;
         } else {
@@ -79,6 +83,7 @@ const std::vector<Trigger::PhysicsData>& Trigger::GetPhysicsData() const {
 }
 
 std::vector<Trigger::PhysicsData>& Trigger::GetPhysicsData() {
+    m_transform_version = 0;
     return m_physics_data;
 }
 
@@ -117,25 +122,28 @@ Entity Trigger::GetOwner() const {
 void Trigger::Update() {
     TL_RETURN_IF_TRUE(m_physics_data.empty());
 
+    auto& physics_scene = COMMON_CONTEXT.m_physics_scene;
+
     // Leave when a tracked shape no longer overlaps any of this trigger's
     // shapes.
-    for (int i = static_cast<int>(m_touch_shapes.size()) - 1; i >= 0; --i) {
-        PhysicsShape* target_shape = m_touch_shapes[static_cast<size_t>(i)];
-        bool still_overlaps = false;
-        for (auto& data : m_physics_data) {
-            if (data.m_shape && COMMON_CONTEXT.m_physics_scene->Overlap(
-                                    *data.m_shape, *target_shape)) {
-                still_overlaps = true;
-                break;
-            }
-        }
-        if (!still_overlaps) {
+    for (auto& data : m_physics_data) {
+        TL_CONTINUE_IF_FALSE(data.m_shape);
+        for (auto& contact :
+             physics_scene->GetContacts(*data.m_shape, ContactState::End)) {
+            auto it = m_touch_counts.find(contact.m_dst_shape);
+            TL_CONTINUE_IF_TRUE(it == m_touch_counts.end());
+            TL_CONTINUE_IF_TRUE(--it->second > 0);
+            m_touch_counts.erase(it);
+            m_touch_shapes.erase(std::find(m_touch_shapes.begin(),
+                                           m_touch_shapes.end(),
+                                           contact.m_dst_shape));
+
             OverlapResult result;
-            result.m_dst_entity = target_shape->GetOwner();
-            result.m_dst_shape = target_shape;
+            result.m_dst_entity = contact.m_dst_entity;
+            result.m_dst_shape =
+                contact.m_is_dst_removed ? nullptr : contact.m_dst_shape;
             TriggerLeaveEvent event{m_entity, GetEventType(), result};
             COMMON_CONTEXT.m_event_system->EnqueueEvent(event);
-            m_touch_shapes.erase(m_touch_shapes.begin() + i);
         }
     }
 
@@ -152,22 +160,18 @@ void Trigger::Update() {
 
     // check entered shapes
     for (auto& data : m_physics_data) {
-        OverlapResult results[16];
-        uint32_t count = COMMON_CONTEXT.m_physics_scene->Overlap(
-            *data.m_shape, results, std::size(results));
-        for (size_t i = 0; i < count; i++) {
-            auto& result = results[i];
-
-            TL_CONTINUE_IF_FALSE(result.m_dst_entity != null_entity &&
-                                 result.m_dst_shape)
-
-            auto it = std::find(m_touch_shapes.begin(), m_touch_shapes.end(),
-                                result.m_dst_shape);
-            if (it == m_touch_shapes.end()) {
-                m_touch_shapes.push_back(result.m_dst_shape);
-                TriggerEnterEvent event{m_entity, GetEventType(), result};
-                COMMON_CONTEXT.m_event_system->EnqueueEvent(event);
-            }
+        TL_CONTINUE_IF_FALSE(data.m_shape);
+        for (auto& contact :
+             physics_scene->GetContacts(*data.m_shape, ContactState::Begin)) {
+            TL_CONTINUE_IF_TRUE(contact.m_dst_entity == null_entity);
+            TL_CONTINUE_IF_TRUE(m_touch_counts[contact.m_dst_shape]++ > 0);
+            m_touch_shapes.push_back(contact.m_dst_shape);
+
+            OverlapResult result;
+            result.m_dst_entity = contact.m_dst_entity;
+            result.m_dst_shape = contact.m_dst_shape;
+            TriggerEnterEvent event{m_entity, GetEventType(), result};
+            COMMON_CONTEXT.m_event_system->EnqueueEvent(event);
         }
     }
 }
@@ -182,11 +186,18 @@ void TriggerComponentManager::Update() {
         auto transform = COMMON_CONTEXT.m_transform_manager->Get(entity);
         TL_CONTINUE_IF_FALSE(transform);
 
-        for (auto& data : trigger.m_component->m_physics_data) {
+        auto& component = *trigger.m_component;
+        TL_CONTINUE_IF_TRUE(component.m_transform_version ==
+                            transform->GetVersion());
+        component.m_transform_version = transform->GetVersion();
+
+        for (auto& data : component.m_physics_data) {
             updatePhysicsShapePosition(*transform, data);
         }
     }
 
+    COMMON_CONTEXT.m_physics_scene->UpdateContacts();
+
     for (auto& [entity, trigger] : m_components) {
         TL_CONTINUE_IF_FALSE(trigger.m_enable &&
                              !trigger.m_component->m_physics_data.empty());
@@ -0,0 +1,146 @@
+#include "common/worker_pool.hpp"
+
+#include "common/log.hpp"
+#include "common/profile.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+WorkerPool::WorkerPool(uint32_t thread_count) {
+    if (thread_count == 0) {
+        uint32_t hardware_count = std::thread::hardware_concurrency();
+        thread_count = hardware_count > 1 ? hardware_count - 1 : 1;
+    }
+
+    for (uint32_t i = 0; i < thread_count; i++) {
+        m_threads.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock{m_job_mutex};
+        m_stop = true;
+        m_jobs.clear();
+    }
+    m_job_cv.notify_all();
+
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void WorkerPool::Submit(Task work, Task finish) {
+    {
+        std::lock_guard lock{m_job_mutex};
+        m_jobs.push_back(Job{std::move(work), std::move(finish)});
+    }
+    m_job_cv.notify_one();
+}
+
+void WorkerPool::PostToMainThread(Task task) {
+    std::lock_guard lock{m_finish_mutex};
+    m_finished.push_back(std::move(task));
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t chunk_size,
+                             const RangeTask& task) {
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    if (chunk_count <= 1 || m_threads.empty()) {
+        if (count > 0) {
+            task(0, count);
+        }
+        return;
+    }
+
+    // shared with jobs, which may start after all chunks are done
+    struct State {
+        RangeTask m_task;
+        size_t m_count{};
+        size_t m_chunk_size{};
+        size_t m_chunk_count{};
+        std::atomic<size_t> m_next_chunk{0};
+        std::atomic<size_t> m_done_chunk{0};
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+    };
+
+    auto state = std::make_shared<State>();
+    state->m_task = task;
+    state->m_count = count;
+    state->m_chunk_size = chunk_size;
+    state->m_chunk_count = chunk_count;
+
+    auto run = [state]() {
+        size_t chunk;
+        while ((chunk = state->m_next_chunk++) < state->m_chunk_count) {
+            size_t begin = chunk * state->m_chunk_size;
+            size_t end = std::min(begin + state->m_chunk_size, state->m_count);
+            state->m_task(begin, end);
+            if (++state->m_done_chunk == state->m_chunk_count) {
+                std::lock_guard lock{state->m_mutex};
+                state->m_cv.notify_one();
+            }
+        }
+    };
+
+    size_t helper_count = std::min(m_threads.size(), chunk_count - 1);
+    for (size_t i = 0; i < helper_count; i++) {
+        Submit(run);
+    }
+    run();
+
+    std::unique_lock lock{state->m_mutex};
+    state->m_cv.wait(lock, [&state]() {
+        return state->m_done_chunk == state->m_chunk_count;
+    });
+}
+
+void WorkerPool::Update() {
+    PROFILE_SECTION();
+
+    std::vector<Task> finished;
+    {
+        std::lock_guard lock{m_finish_mutex};
+        finished.swap(m_finished);
+    }
+
+    // callbacks may post new tasks, they run at next Update
+    for (auto& task : finished) {
+        task();
+    }
+}
+
+uint32_t WorkerPool::GetThreadCount() const {
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock{m_job_mutex};
+            m_job_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        if (job.m_work) {
+            try {
+                job.m_work();
+            } catch (std::exception& e) {
+                LOGE("[WorkerPool]: job throw exception: {}", e.what());
+            }
+        }
+
+        if (job.m_finish) {
+            PostToMainThread(std::move(job.m_finish));
+        }
+    }
+}
@@ -1058,6 +1058,41 @@ std::string GenerateProtoConvertImplCode(const SchemaInfoManager& mgr) {
     return mustache.render(datas);
 }
 
+/**
+ * FNV-1a hash of all class & enum layouts, to detect outdated cooked assets
+ */
+uint64_t calcSchemaLayoutHash(const SchemaInfoManager& manager) {
+    uint64_t hash = 14695981039346656037ull;
+    auto hash_string = [&hash](const std::string& str) {
+        for (char c : str) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        // separator, so "ab" + "c" differs from "a" + "bc"
+        hash ^= 0xFF;
+        hash *= 1099511628211ull;
+    };
+
+    for (auto& info : manager.m_infos) {
+        for (auto& clazz : info.m_classes) {
+            hash_string(clazz.m_name);
+            for (auto& prop : clazz.m_properties) {
+                hash_string(prop.m_type);
+                hash_string(prop.m_name);
+            }
+        }
+        for (auto& enum_info : info.m_enums) {
+            hash_string(enum_info.m_name);
+            hash_string(enum_info.m_type);
+            for (auto& item : enum_info.m_items) {
+                hash_string(item.m_name);
+                hash_string(item.m_value);
+            }
+        }
+    }
+    return hash;
+}
+
 std::string GenerateAssetInfoHeaderCode(const SchemaInfoManager& manager) {
     kainjow::mustache::data data;
     kainjow::mustache::data includes_data{kainjow::mustache::data::type::list};
@@ -1137,6 +1172,7 @@ std::string GenerateAssetInfoHeaderCode(const SchemaInfoManager& manager) {
     data.set("asset_names", names_data);
     data.set("type_check", type_checks_data);
     data.set("asset_num", std::to_string(asset_num));
+    data.set("schema_hash", std::to_string(calcSchemaLayoutHash(manager)));
 
     auto& mustache = MustacheManager::GetInst().m_asset_info_header_mustache;
     return mustache.render(data);
@@ -1572,6 +1608,9 @@ std::string GenerateSchemaTypesLuauDefinitionCode(
                     types += "\tLoad: (self: " + mgr +
                              ", path: Path, force: boolean?) -> " + handle +
                              ",\n";
+                    types += "\tLoadAsync: (self: " + mgr +
+                             ", path: Path, on_loaded: (" + handle +
+                             ") -> ()) -> (),\n";
                     types += "\tFind: (self: " + mgr + ", path: Path) -> " +
                              handle + ",\n";
                     types += "\tUnload: (self: " + mgr + ", handle: " + handle +
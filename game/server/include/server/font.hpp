@@ -9,6 +9,10 @@ public:
     SDL_Surface* GenerateText(const std::string& text,
                               const Color& color) const override;
 
+    TextLayout LayoutText(const UTF8String& text, int pt) override;
+
+    const ImageBase* GetGlyphImage(char32_t cp, int pt) override;
+
     int GetHeight() const override;
 
     void SetFontSize(int) override;
@@ -12,6 +12,7 @@
 #include "common/scene.hpp"
 #include "common/script/script.hpp"
 #include "common/script/script_binding.hpp"
+#include "common/script/script_coroutine.hpp"
 #include "common/sdl_call.hpp"
 #include "common/serialize.hpp"
 #include "common/static_collision.hpp"
@@ -20,6 +21,7 @@
 #include "common/transform.hpp"
 #include "common/trigger.hpp"
 #include "common/uuid.hpp"
+#include "common/worker_pool.hpp"
 #include "imgui.h"
 #include "imgui_internal.h"
 #include "schema/asset_info.hpp"
@@ -82,6 +84,9 @@ void ServerContext::Initialize(int argc, char** argv) {
 
     m_debug_drawer = std::unique_ptr<IDebugDrawer>(new TrivialDebugDrawer{});
 
+    // no imgui on server, report physics stats by log
+    m_physics_scene->SetStatsLogInterval(10);
+
     m_script_binary_data_manager->BindModule([](lua_State* L) {
         BindTLModule(L);
         BindServerModule(L);
@@ -90,9 +95,7 @@ void ServerContext::Initialize(int argc, char** argv) {
     InitGlobalScript(m_config.m_global_script);
 
 
-    SceneHandle level =
-        m_assets_manager->GetManager<Scene>().Load(GetCommonConfig().m_entry_scene);
-    m_scene_manager->Switch(level);
+    m_scene_manager->SwitchAsync(GetCommonConfig().m_entry_scene);
 
     m_time->SetFPS(24);
 }
@@ -121,15 +124,19 @@ void ServerContext::Update() {
 
     m_time->Update();
 
+    m_worker_pool->Update();
+
     if (m_global_script) {
         m_global_script->Update();
     }
     m_script_component_manager->Update();
+    m_script_coroutine_scheduler->Update();
 
     m_relationship_manager->Update();
     m_bind_point_component_manager->Update();
     m_static_collision_manager->Update();
     m_trigger_component_manager->Update();
+    m_physics_scene->UpdateStats(elapse_time);
 
     if (m_net_host) {
         m_net_host->Flush();
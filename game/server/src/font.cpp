@@ -9,6 +9,14 @@ SDL_Surface* TrivialFont::GenerateText(const std::string& text,
     return nullptr;
 }
 
+TextLayout TrivialFont::LayoutText(const UTF8String& text, int pt) {
+    return {};
+}
+
+const ImageBase* TrivialFont::GetGlyphImage(char32_t cp, int pt) {
+    return nullptr;
+}
+
 int TrivialFont::GetHeight() const {
     return 0;
 }
@@ -0,0 +1,117 @@
+#include "context.hpp"
+#include "common/asset_manager.hpp"
+#include "common/binary_serialize.hpp"
+#include "common/log.hpp"
+#include "common/script/script.hpp"
+#include "schema/asset_info.hpp"
+#include "schema/serialize/serialize.hpp"
+#include "server/font.hpp"
+#include "server/image.hpp"
+#include "server/scene.hpp"
+
+#include <filesystem>
+#include <variant>
+
+// keep image/font path only, so handles are cooked as external reference
+class CookerImageManager : public ImageManagerBase {
+public:
+    ImageHandle Load(const Path& filename, bool force) override {
+        if (auto handle = Find(filename); handle && !force) {
+            return handle;
+        }
+        return store(&filename, UUIDv4::CreateV4(),
+                     std::make_unique<ServerImage>());
+    }
+};
+
+class CookerFontManager : public FontManagerBase {
+public:
+    FontHandle Load(const Path& filename, bool force) override {
+        if (auto handle = Find(filename); handle && !force) {
+            return handle;
+        }
+        return store(&filename, UUIDv4::CreateV4(),
+                     std::make_unique<TrivialFont>());
+    }
+};
+
+class CookerAssetsManager : public IAssetsManager {
+protected:
+    ImageManagerBase& getImageManager(TypeIndex type_index) override {
+        return ensureManager<CookerImageManager>(type_index);
+    }
+
+    FontManagerBase& getFontManager(TypeIndex type_index) override {
+        return ensureManager<CookerFontManager>(type_index);
+    }
+};
+
+std::unique_ptr<AssetCookerContext> AssetCookerContext::instance;
+
+void AssetCookerContext::Init() {
+    if (!instance) {
+        instance = std::unique_ptr<AssetCookerContext>(new AssetCookerContext());
+    } else {
+        LOGW("inited context singleton twice!");
+    }
+}
+
+void AssetCookerContext::Destroy() {
+    instance.reset();
+}
+
+AssetCookerContext& AssetCookerContext::GetInst() {
+    return *instance;
+}
+
+void AssetCookerContext::Initialize(int argc, char** argv) {
+    CommonContext::Initialize(argc, argv);
+    m_assets_manager = std::make_unique<CookerAssetsManager>();
+    m_scene_manager = std::make_unique<ServerSceneManager>();
+    m_script_binary_data_manager = std::make_unique<ScriptBinaryDataManager>();
+}
+
+void AssetCookerContext::Update() {}
+
+int AssetCookerContext::CookDirectory(const Path& dir) {
+    int count = 0;
+    std::error_code err;
+    for (auto& entry :
+         std::filesystem::recursive_directory_iterator(dir, err)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".xml") {
+            continue;
+        }
+        if (CookAsset(entry.path().generic_string())) {
+            count++;
+        }
+    }
+
+    if (err) {
+        LOGE("iterate directory {} failed: {}", dir, err.message());
+    }
+    return count;
+}
+
+bool AssetCookerContext::CookAsset(const Path& filename) {
+    VariantAsset asset = AssetInfoManager::LoadAsset(filename, *this);
+    return std::visit(
+        [&](auto& handle) {
+            using type = std::decay_t<decltype(handle)>;
+            if constexpr (std::is_same_v<type, std::monostate>) {
+                LOGW("{} is not an asset, skip", filename);
+                return false;
+            } else {
+                if (!handle) {
+                    LOGE("load asset {} failed", filename);
+                    return false;
+                }
+                if (!SaveCookedAsset(handle.GetUUID(), *handle, filename)) {
+                    LOGE("cook asset {} failed", filename);
+                    return false;
+                }
+                LOGI("cooked {}", filename);
+                return true;
+            }
+        },
+        asset);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common/context.hpp"
+
+/**
+ * headless context which only loads assets, used to cook xml assets into
+ * binary files
+ */
+class AssetCookerContext : public CommonContext {
+public:
+    static void Init();
+    static void Destroy();
+    static AssetCookerContext& GetInst();
+
+    void Initialize(int argc, char** argv) override;
+    void Update() override;
+
+    /**
+     * cook all xml assets under directory
+     * @return cooked asset count
+     */
+    int CookDirectory(const Path& dir);
+
+    bool CookAsset(const Path& filename);
+
+private:
+    using CommonContext::CommonContext;
+
+    static std::unique_ptr<AssetCookerContext> instance;
+};
+
+#define ASSET_COOKER_CONTEXT ::AssetCookerContext::GetInst()
@@ -0,0 +1,20 @@
+#include "context.hpp"
+#include "common/log.hpp"
+
+int main(int argc, char** argv) {
+    Path dir = "assets/gpa";
+    if (argc > 1) {
+        dir = argv[1];
+    }
+
+    AssetCookerContext::Init();
+    CommonContext::ChangeContext(ASSET_COOKER_CONTEXT);
+    ASSET_COOKER_CONTEXT.Initialize(argc, argv);
+
+    int count = ASSET_COOKER_CONTEXT.CookDirectory(dir);
+    LOGI("cooked {} assets under {}", count, dir);
+
+    ASSET_COOKER_CONTEXT.Shutdown();
+    AssetCookerContext::Destroy();
+    return 0;
+}
@@ -298,6 +298,21 @@ void InstanceDisplay(const char* name, const Radians& value) {
     ImGui::PopID();
 }
 
+// image may be a region of atlas page, so show its region only
+void displayImage(const ImageBase& image) {
+    SDL_Texture* texture = image.GetTexture();
+    float page_w = 0, page_h = 0;
+    TL_RETURN_IF_FALSE(texture && SDL_GetTextureSize(texture, &page_w, &page_h));
+    TL_RETURN_IF_TRUE(page_w <= 0 || page_h <= 0);
+
+    Region region = image.GetTextureRegion();
+    ImVec2 size{image.GetSize().x, image.GetSize().y};
+    ImVec2 uv0{region.m_topleft.x / page_w, region.m_topleft.y / page_h};
+    ImVec2 uv1{(region.m_topleft.x + region.m_size.x) / page_w,
+               (region.m_topleft.y + region.m_size.y) / page_h};
+    ImGui::Image(texture, size, uv0, uv1);
+}
+
 template <typename T>
 void displayAssetName(Handle<T> handle) {
     std::string text = "none";
@@ -324,10 +339,7 @@ void InstanceDisplay(const char* name, ImageHandle& value) {
     });
 
     if (value) {
-        ImVec2 size;
-        size.x = value->GetSize().x;
-        size.y = value->GetSize().y;
-        ImGui::Image(value->GetTexture(), size);
+        displayImage(*value);
     }
 }
 
@@ -336,10 +348,7 @@ void InstanceDisplay(const char* name, const Handle<Image>& value) {
     displayAssetName(value);
 
     if (value) {
-        ImVec2 size;
-        size.x = value->GetSize().x;
-        size.y = value->GetSize().y;
-        ImGui::Image(value->GetTexture(), size);
+        displayImage(*value);
     }
 }
 
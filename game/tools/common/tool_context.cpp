@@ -55,6 +55,10 @@ void ToolContext::Update() {
     beginImGui();
 
     update();
+    m_renderer->ApplyDrawcall();
+
+    // scene must be drawn before ImGui renders on top of it
+    m_renderer->Execute();
 
     endImGui();
     m_renderer->Present();
@@ -0,0 +1,293 @@
+#include "common/binary_serialize.hpp"
+#include "common/cct.hpp"
+#include "common/context.hpp"
+#include "common/log.hpp"
+#include "common/macros.hpp"
+#include "common/physics.hpp"
+#include "common/storage.hpp"
+#include "lyra/lyra.hpp"
+
+#include <array>
+#include <iostream>
+#include <random>
+
+// replays a recorded physics input stream twice in fresh headless scenes and
+// compares per-frame `PhysicsScene::ComputeStateHash`. Hashes can be saved
+// and compared across machines, e.g. x86 server and arm64 client
+
+namespace {
+
+constexpr std::array<char, 4> Magic = {'T', 'L', 'P', 'R'};
+constexpr uint32_t Version = 1;
+
+struct CharacterInfo {
+    Vec2 m_position;
+    Vec2 m_half_size;  // rect if y > 0, otherwise circle with radius x
+};
+
+/**
+ * scene layout and per-frame displacement of every character
+ */
+struct InputStream {
+    std::vector<Rect> m_obstacles;
+    std::vector<CharacterInfo> m_characters;
+    std::vector<Vec2> m_moves;  // frame major, one per character
+
+    [[nodiscard]] size_t GetFrameCount() const {
+        return m_characters.empty() ? 0
+                                    : m_moves.size() / m_characters.size();
+    }
+};
+
+/**
+ * only physics scene is created, so cct can run without client or server
+ */
+class ReplayContext : public CommonContext {
+public:
+    ReplayContext() {
+        ChangeContext(*this);
+        m_physics_scene = std::make_unique<PhysicsScene>();
+    }
+
+    void Update() override {}
+};
+
+InputStream Generate(uint32_t seed, uint32_t frame_count,
+                     uint32_t character_count) {
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<float> position_dist(-500, 500);
+    std::uniform_real_distribution<float> size_dist(4, 40);
+    std::uniform_real_distribution<float> move_dist(-6, 6);
+    std::bernoulli_distribution rect_dist(0.5);
+
+    InputStream stream;
+
+    // arena walls and random blocks
+    stream.m_obstacles.push_back(Rect{{0, -560}, {600, 20}});
+    stream.m_obstacles.push_back(Rect{{0, 560}, {600, 20}});
+    stream.m_obstacles.push_back(Rect{{-560, 0}, {20, 600}});
+    stream.m_obstacles.push_back(Rect{{560, 0}, {20, 600}});
+    for (int i = 0; i < 64; i++) {
+        stream.m_obstacles.push_back(
+            Rect{{position_dist(rng), position_dist(rng)},
+                 {size_dist(rng), size_dist(rng)}});
+    }
+
+    for (uint32_t i = 0; i < character_count; i++) {
+        CharacterInfo info;
+        info.m_position = Vec2{position_dist(rng), position_dist(rng)};
+        info.m_half_size = rect_dist(rng) ? Vec2{8, 12} : Vec2{10, 0};
+        stream.m_characters.push_back(info);
+    }
+
+    // keep walking one direction for a while, like player input
+    std::vector<Vec2> directions(character_count);
+    stream.m_moves.reserve(frame_count * character_count);
+    for (uint32_t frame = 0; frame < frame_count; frame++) {
+        for (uint32_t i = 0; i < character_count; i++) {
+            if (frame % 30 == 0) {
+                directions[i] = Vec2{move_dist(rng), move_dist(rng)};
+            }
+            stream.m_moves.push_back(directions[i]);
+        }
+    }
+    return stream;
+}
+
+bool Save(const InputStream& stream, const Path& filename) {
+    BinaryWriter writer;
+    writer.Write(Magic);
+    writer.Write(Version);
+    writer.Write(static_cast<uint32_t>(stream.m_obstacles.size()));
+    writer.Write(stream.m_obstacles.data(),
+                 stream.m_obstacles.size() * sizeof(Rect));
+    writer.Write(static_cast<uint32_t>(stream.m_characters.size()));
+    writer.Write(stream.m_characters.data(),
+                 stream.m_characters.size() * sizeof(CharacterInfo));
+    writer.Write(static_cast<uint32_t>(stream.m_moves.size()));
+    writer.Write(stream.m_moves.data(), stream.m_moves.size() * sizeof(Vec2));
+    return writer.SaveToFile(filename);
+}
+
+template <typename T>
+bool ReadArray(BinaryReader& reader, std::vector<T>& out) {
+    out.resize(reader.ReadCount());
+    return reader.Read(out.data(), out.size() * sizeof(T));
+}
+
+std::optional<InputStream> Load(const Path& filename) {
+    auto file = MappedFile::Open(filename);
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(file, std::nullopt, LOGE,
+                                      "open input stream {} failed", filename);
+    BinaryReader reader{file->GetData(), file->GetSize()};
+
+    std::array<char, 4> magic{};
+    uint32_t version = 0;
+    reader.Read(magic);
+    reader.Read(version);
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(
+        magic == Magic && version == Version, std::nullopt, LOGE,
+        "{} is not a physics input stream of version {}", filename, Version);
+
+    InputStream stream;
+    ReadArray(reader, stream.m_obstacles);
+    ReadArray(reader, stream.m_characters);
+    ReadArray(reader, stream.m_moves);
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(reader.IsValid(), std::nullopt, LOGE,
+                                      "input stream {} is broken", filename);
+    return stream;
+}
+
+std::vector<uint64_t> Replay(const InputStream& stream) {
+    ReplayContext context;
+    auto& scene = *context.m_physics_scene;
+
+    std::vector<PhysicsShapeDefinition> definitions;
+    definitions.reserve(stream.m_obstacles.size() +
+                        stream.m_characters.size());
+    auto create_handle = [&](PhysicsShapeDefinition definition) {
+        auto& stored = definitions.emplace_back(definition);
+        return PhysicsShapeDefinitionHandle{UUIDv4{}, &stored, nullptr};
+    };
+
+    for (auto& obstacle : stream.m_obstacles) {
+        PhysicsShapeDefinition definition{};
+        definition.m_is_rect = true;
+        definition.m_rect = obstacle;
+        definition.m_collision_layer = {CollisionGroupType::Obstacle};
+        scene.CreateShape(context.CreateEntity(), create_handle(definition));
+    }
+
+    std::vector<std::unique_ptr<CharacterController>> characters;
+    for (auto& info : stream.m_characters) {
+        PhysicsShapeDefinition definition{};
+        definition.m_is_rect = info.m_half_size.y > 0;
+        if (definition.m_is_rect) {
+            definition.m_rect = Rect{info.m_position, info.m_half_size};
+        } else {
+            definition.m_circle.m_center = info.m_position;
+            definition.m_circle.m_radius = info.m_half_size.x;
+        }
+        definition.m_collision_layer = {CollisionGroupType::CCT};
+        definition.m_collision_mask = {CollisionGroupType::Obstacle,
+                                       CollisionGroupType::CCT};
+
+        CCTDefinition cct_definition;
+        cct_definition.m_physics_shape = create_handle(definition);
+        characters.push_back(std::make_unique<CharacterController>(
+            context.CreateEntity(), cct_definition));
+    }
+
+    std::vector<uint64_t> hashes;
+    hashes.reserve(stream.GetFrameCount());
+    const Vec2* moves = stream.m_moves.data();
+    for (size_t frame = 0; frame < stream.GetFrameCount(); frame++) {
+        for (auto& character : characters) {
+            character->MoveAndSlide(*moves++);
+        }
+        hashes.push_back(scene.ComputeStateHash());
+    }
+
+    // cct removes its shape from current context's physics scene
+    characters.clear();
+    return hashes;
+}
+
+/**
+ * @return index of first different frame, or -1 if all frames are same
+ */
+int64_t FindMismatch(const std::vector<uint64_t>& a,
+                     const std::vector<uint64_t>& b) {
+    for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+        if (a[i] != b[i]) {
+            return static_cast<int64_t>(i);
+        }
+    }
+    return a.size() == b.size() ? -1 : static_cast<int64_t>(
+                                           std::min(a.size(), b.size()));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input, record, hashes_output, expect;
+    uint32_t seed = 0, frame_count = 600, character_count = 32;
+    bool show_help = false;
+    auto cli =
+        lyra::cli() | lyra::help(show_help) |
+        lyra::opt(record, "file")["--record"](
+            "save generated input stream for replaying on other machines") |
+        lyra::opt(hashes_output, "file")["--save-hashes"](
+            "save per-frame state hashes") |
+        lyra::opt(expect, "file")["--expect"](
+            "compare with hashes saved by --save-hashes") |
+        lyra::opt(seed, "seed")["--seed"]("random seed of generated stream") |
+        lyra::opt(frame_count, "count")["--frames"](
+            "frame count of generated stream") |
+        lyra::opt(character_count, "count")["--characters"](
+            "character count of generated stream") |
+        // after options, or it takes them as input
+        lyra::arg(input, "input")(
+            "recorded input stream, generated by seed if not given");
+    lyra::parse_result result = cli.parse({argc, argv});
+    if (!result || show_help) {
+        std::cout << cli << std::endl;
+        return result ? 0 : 1;
+    }
+
+    std::optional<InputStream> stream;
+    if (input.empty()) {
+        stream = Generate(seed, frame_count, character_count);
+    } else {
+        stream = Load(input);
+    }
+    TL_RETURN_VALUE_IF_FALSE(stream, 1);
+
+    if (!record.empty()) {
+        TL_RETURN_VALUE_IF_FALSE_WITH_LOG(Save(*stream, record), 1, LOGE,
+                                          "save input stream {} failed",
+                                          record);
+        LOGI("input stream saved to {}", record);
+    }
+
+    auto first = Replay(*stream);
+    auto second = Replay(*stream);
+    LOGI("replayed {} frames of {} characters twice", first.size(),
+         stream->m_characters.size());
+
+    int exit_code = 0;
+    if (int64_t frame = FindMismatch(first, second); frame >= 0) {
+        LOGE("replays diverge at frame {}", frame);
+        exit_code = 1;
+    } else if (!first.empty()) {
+        LOGI("replays match, final hash {:016x}", first.back());
+    }
+
+    if (!hashes_output.empty()) {
+        BinaryWriter writer;
+        writer.Write(static_cast<uint32_t>(first.size()));
+        writer.Write(first.data(), first.size() * sizeof(uint64_t));
+        if (!writer.SaveToFile(hashes_output)) {
+            LOGE("save hashes {} failed", hashes_output);
+            exit_code = 1;
+        }
+    }
+
+    if (!expect.empty()) {
+        std::vector<uint64_t> expected;
+        auto file = MappedFile::Open(expect);
+        BinaryReader reader{file ? file->GetData() : nullptr,
+                            file ? file->GetSize() : 0};
+        if (!file || !ReadArray(reader, expected)) {
+            LOGE("read hashes {} failed", expect);
+            exit_code = 1;
+        } else if (int64_t frame = FindMismatch(first, expected); frame >= 0) {
+            LOGE("diverge from {} at frame {}", expect, frame);
+            exit_code = 1;
+        } else {
+            LOGI("match hashes in {}", expect);
+        }
+    }
+
+    return exit_code;
+}
@@ -0,0 +1,118 @@
+#include "client/render_capture.hpp"
+#include "client/renderer.hpp"
+#include "common/log.hpp"
+#include "lyra/lyra.hpp"
+
+#include <chrono>
+#include <iostream>
+
+// replays render captures(see `RenderCaptureWriter`) on a software renderer
+// and reports CPU cost of each renderer stage
+
+namespace {
+
+struct StageTime {
+    TimeType m_total{};
+    TimeType m_max{};
+
+    void Add(TimeType time) {
+        m_total += time;
+        m_max = std::max(m_max, time);
+    }
+};
+
+class Stopwatch {
+public:
+    TimeType Lap() {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<TimeType> duration = now - m_begin;
+        m_begin = now;
+        return duration.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_begin =
+        std::chrono::steady_clock::now();
+};
+
+void Report(const char* name, const StageTime& time, size_t frame_count) {
+    LOGI("{:>8}: avg {:.4f}ms, max {:.4f}ms", name,
+         time.m_total * 1000 / frame_count, time.m_max * 1000);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string filename;
+    int iterations = 10;
+    bool show_help = false;
+    auto cli = lyra::cli() | lyra::help(show_help) |
+               lyra::arg(filename, "capture")("render capture file") |
+               lyra::opt(iterations, "count")["--iterations"](
+                   "replay times of the capture");
+    lyra::parse_result result = cli.parse({argc, argv});
+    if (!result || show_help || filename.empty()) {
+        std::cout << cli << std::endl;
+        return result ? 0 : 1;
+    }
+
+    auto capture = RenderCapture::Load(filename);
+    TL_RETURN_VALUE_IF_FALSE(capture, 1);
+
+    Vec2UI size = capture->GetViewportSize();
+    SDL_Surface* target =
+        SDL_CreateSurface(std::max<int>(size.w, 1), std::max<int>(size.h, 1),
+                          SDL_PIXELFORMAT_RGBA32);
+    auto renderer = std::make_unique<Renderer>(target);
+    capture->CreateTextures(*renderer);
+
+    StageTime sort_time, execute_time, present_time;
+    uint64_t command_count = 0, culled_count = 0, draw_call_count = 0;
+    size_t frame_count = 0;
+
+    DrawPass pass;
+    for (int i = 0; i < iterations; i++) {
+        for (auto& frame : capture->GetFrames()) {
+            TimeType sort = 0, execute = 0;
+            renderer->Clear();
+            for (auto& captured : frame) {
+                pass = captured;
+
+                Stopwatch stopwatch;
+                pass.Sort();
+                sort += stopwatch.Lap();
+                renderer->ExecutePass(pass);
+                execute += stopwatch.Lap();
+            }
+
+            Stopwatch stopwatch;
+            renderer->Present();
+            present_time.Add(stopwatch.Lap());
+            sort_time.Add(sort);
+            execute_time.Add(execute);
+
+            auto& stats = renderer->GetStats();
+            command_count += stats.m_command_count;
+            culled_count += stats.m_culled_count;
+            draw_call_count += stats.m_draw_call_count;
+            frame_count++;
+        }
+    }
+
+    TL_RETURN_VALUE_IF_FALSE_WITH_LOG(frame_count > 0, 1, LOGE,
+                                      "no frame in {}", filename);
+
+    LOGI("replayed {} frames of {}", frame_count, filename);
+    Report("sort", sort_time, frame_count);
+    Report("execute", execute_time, frame_count);
+    Report("present", present_time, frame_count);
+    LOGI("per frame: {} commands, {} culled, {} draw calls",
+         command_count / frame_count, culled_count / frame_count,
+         draw_call_count / frame_count);
+
+    capture.reset();
+    renderer.reset();
+    SDL_DestroySurface(target);
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "common/log.hpp"
+#include "common/radix_sort.hpp"
+#include "lyra/lyra.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+// compares `RadixSortIndices` with the `std::stable_sort` by z order which
+// renderer used before, on keys shaped like draw command keys
+
+namespace {
+
+struct SortTime {
+    double m_radix{};
+    double m_stable{};
+};
+
+class Stopwatch {
+public:
+    double Lap() {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> duration = now - m_begin;
+        m_begin = now;
+        return duration.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_begin =
+        std::chrono::steady_clock::now();
+};
+
+/**
+ * high 32 bits is z order, low 32 bits is submit sequence. Most commands
+ * share few layers, some are y-sorted so their z spreads
+ */
+std::vector<uint64_t> GenerateKeys(size_t count, int layer_count,
+                                   float y_sorted_ratio, std::mt19937& rng) {
+    std::uniform_int_distribution<int> layer_dist(0, layer_count - 1);
+    std::uniform_real_distribution<float> y_dist(0, 1000);
+    std::bernoulli_distribution y_sorted_dist(y_sorted_ratio);
+
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; i++) {
+        float z = static_cast<float>(layer_dist(rng));
+        if (y_sorted_dist(rng)) {
+            z += y_dist(rng) / 1000.0f;
+        }
+        keys[i] = (static_cast<uint64_t>(FloatToSortableKey(z)) << 32) | i;
+    }
+    return keys;
+}
+
+SortTime Measure(const std::vector<uint64_t>& keys, int iterations) {
+    std::vector<uint32_t> radix_indices, buffer, stable_indices;
+    SortTime time;
+
+    for (int i = 0; i < iterations; i++) {
+        Stopwatch stopwatch;
+        RadixSortIndices(keys, radix_indices, buffer);
+        time.m_radix += stopwatch.Lap();
+
+        // old path: stable sort by z only, submit order keeps ties
+        stable_indices.resize(keys.size());
+        std::iota(stable_indices.begin(), stable_indices.end(), 0);
+        stopwatch.Lap();
+        std::stable_sort(stable_indices.begin(), stable_indices.end(),
+                         [&](uint32_t a, uint32_t b) {
+                             return (keys[a] >> 32) < (keys[b] >> 32);
+                         });
+        time.m_stable += stopwatch.Lap();
+    }
+
+    if (radix_indices != stable_indices) {
+        LOGE("radix sort result differs from std::stable_sort");
+    }
+
+    time.m_radix /= iterations;
+    time.m_stable /= iterations;
+    return time;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int iterations = 50;
+    int layer_count = 8;
+    float y_sorted_ratio = 0.5f;
+    unsigned seed = 0;
+    bool show_help = false;
+    auto cli = lyra::cli() | lyra::help(show_help) |
+               lyra::opt(iterations, "count")["--iterations"](
+                   "sort times of each size") |
+               lyra::opt(layer_count, "count")["--layers"](
+                   "distinct z orders before y sorting") |
+               lyra::opt(y_sorted_ratio, "ratio")["--y-sorted"](
+                   "ratio of y-sorted commands") |
+               lyra::opt(seed, "seed")["--seed"]("random seed");
+    lyra::parse_result result = cli.parse({argc, argv});
+    if (!result || show_help || iterations <= 0 || layer_count <= 0) {
+        std::cout << cli << std::endl;
+        return result ? 0 : 1;
+    }
+
+    std::mt19937 rng{seed};
+    LOGI("{:>8} {:>12} {:>12} {:>8}", "count", "radix(ms)", "stable(ms)",
+         "speedup");
+    for (size_t count : {100, 1000, 5000, 20000, 100000}) {
+        auto keys = GenerateKeys(count, layer_count, y_sorted_ratio, rng);
+        SortTime time = Measure(keys, iterations);
+        LOGI("{:>8} {:>12.4f} {:>12.4f} {:>7.2f}x", count, time.m_radix * 1000,
+             time.m_stable * 1000, time.m_stable / time.m_radix);
+    }
+    return 0;
+}